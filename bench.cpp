@@ -0,0 +1,229 @@
+#include "include/cpu_dispatch.h"
+#include "include/integer.h"
+#include "include/math_integer.h"
+#include "include/random.h"
+#include "include/rational.h"
+#include "include/real.h"
+#include "include/thread_pool.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Times the Integer, Rational and Real operations over a range of operand sizes,
+// and writes the results as JSON in the same layout as Google Benchmark, so that
+// the same tools can compare runs.
+//
+// Options:
+//   --filter=TEXT    Only run the benchmarks whose names contain TEXT
+//   --min-time=SECS  Repeat each benchmark for at least this long (default 0.2)
+//   --max-bits=BITS  Skip operand sizes above this (default 10000000)
+//   --threads=N      The thread limit for the operations (default 1)
+//   --out=FILE       Write the JSON to FILE instead of standard output
+
+using namespace aprn;
+
+namespace {
+
+  struct Options {
+    std::string filter;
+    double minTime = 0.2;
+    unsigned long long maxBits = 10000000;
+    unsigned threads = 1;
+    std::string out;
+  };
+
+  struct Result {
+    std::string name;
+    unsigned long long bits;
+    unsigned long long iterations;
+    double realTime;
+    double cpuTime;
+  };
+
+  // The operand sizes, in bits. Operations that are quadratic or worse stop early
+  // with their own limits.
+  unsigned long long const SIZES[] = {
+    64, 256, 1024, 4096, 16384, 65536, 262144, 1048576, 4194304, 10000000
+  };
+  unsigned long long const QUADRATIC_MAX_BITS = 65536;
+
+  // Results are folded into this, so that the compiler can't remove the operations.
+  volatile int sink = 0;
+
+  // Runs an operation until it has taken at least the minimum time, increasing the
+  // number of iterations geometrically as Google Benchmark does.
+  Result measure(std::string const& name, unsigned long long bits,
+                 std::function<int()> const& operation, double minTime) {
+    unsigned long long iterations = 1;
+    while (true) {
+      std::clock_t cpuStart = std::clock();
+      auto start = std::chrono::steady_clock::now();
+      for (unsigned long long i = 0; i < iterations; ++i) {
+        sink = sink + operation();
+      }
+      double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      double cpuElapsed = (double) (std::clock() - cpuStart) / CLOCKS_PER_SEC;
+      if (elapsed >= minTime || iterations >= 1000000000ULL) {
+        return { name, bits, iterations, 1e9 * elapsed / iterations, 1e9 * cpuElapsed / iterations };
+      }
+      // Aim a little past the minimum time, but never grow more than tenfold at once.
+      double scale = elapsed > 0 ? 1.4 * minTime / elapsed : 10.0;
+      iterations = (unsigned long long) (iterations * std::min(std::max(scale, 1.5), 10.0)) + 1;
+    }
+  }
+
+  bool parseOption(std::string const& arg, std::string const& name, std::string& value_out) {
+    std::string prefix = "--" + name + "=";
+    if (arg.compare(0, prefix.size(), prefix) != 0) {
+      return false;
+    }
+    value_out = arg.substr(prefix.size());
+    return true;
+  }
+
+  std::string escapeJson(std::string const& text) {
+    std::string result;
+    for (char c : text) {
+      if (c == '"' || c == '\\') {
+        result.push_back('\\');
+      }
+      result.push_back(c);
+    }
+    return result;
+  }
+
+}
+
+int main(int argc, char** argv) {
+  Options options;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    std::string value;
+    if (parseOption(arg, "filter", value)) {
+      options.filter = value;
+    }
+    else if (parseOption(arg, "min-time", value)) {
+      options.minTime = std::atof(value.c_str());
+    }
+    else if (parseOption(arg, "max-bits", value)) {
+      options.maxBits = std::strtoull(value.c_str(), nullptr, 10);
+    }
+    else if (parseOption(arg, "threads", value)) {
+      options.threads = (unsigned) std::max(1, std::atoi(value.c_str()));
+    }
+    else if (parseOption(arg, "out", value)) {
+      options.out = value;
+    }
+    else {
+      std::cerr << "unknown option: " << arg << '\n';
+      return 1;
+    }
+  }
+  setThreadLimit(options.threads);
+
+  std::mt19937_64 engine(12345);
+  std::vector<Result> results;
+  auto run = [&](std::string const& operation, unsigned long long bits,
+                 std::function<int()> const& fn) {
+    std::string name = operation + "/" + std::to_string(bits);
+    if (name.find(options.filter) == std::string::npos) {
+      return;
+    }
+    results.push_back(measure(name, bits, fn, options.minTime));
+    std::cerr << name << ": " << results.back().realTime << " ns\n";
+  };
+
+  for (unsigned long long bits : SIZES) {
+    if (bits > options.maxBits) {
+      break;
+    }
+    // The operands have their top bits set, so that they have exactly the given size.
+    Integer top = Integer(1) << (bits - 1);
+    Integer a = randomBits(bits - 1, engine) | top;
+    Integer b = randomBits(bits - 1, engine) | top;
+    Integer wide = (randomBits(2 * bits - 1, engine) | (Integer(1) << (2 * bits - 1)));
+    std::string decimal = toString(a);
+
+    run("add", bits, [&]() { return signum(a + b); });
+    run("sub", bits, [&]() { return signum(a - b); });
+    run("mul", bits, [&]() { return signum(a * b); });
+    run("sqr", bits, [&]() { return signum(a * a); });
+    run("div", bits, [&]() { return signum(div(wide, b).quot); });
+    run("shl", bits, [&]() { return signum(a << 37); });
+    run("shr", bits, [&]() { return signum(a >> 37); });
+    run("to_string", bits, [&]() { return (int) toString(a).size(); });
+    run("parse", bits, [&]() {
+      Integer result;
+      return fromString(decimal, 10, result) ? signum(result) : 0;
+    });
+
+    Real realA(a, -(long long) bits);
+    Real realB(b, -(long long) bits);
+    run("real_add", bits, [&]() { return signum(realA + realB); });
+    run("real_mul", bits, [&]() { return signum(realA * realB); });
+    run("real_div", bits, [&]() {
+      return signum(div(realA, realB, bits, RoundingMode::Nearest));
+    });
+
+    if (bits <= QUADRATIC_MAX_BITS) {
+      run("gcd", bits, [&]() { return signum(gcd(a, b)); });
+      Rational ratA(a);
+      ratA /= Rational(b + 1);
+      Rational ratB(b);
+      ratB /= Rational(a + 3);
+      run("rational_add", bits, [&]() { return (int) (ratA + ratB < ratA); });
+      run("rational_mul", bits, [&]() { return (int) (ratA * ratB < ratA); });
+    }
+  }
+
+  // The results are written in the same layout as Google Benchmark's JSON output.
+  std::ostringstream json;
+  std::time_t now = std::time(nullptr);
+  char date[64];
+  std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+  json << "{\n";
+  json << "  \"context\": {\n";
+  json << "    \"date\": \"" << date << "\",\n";
+  json << "    \"executable\": \"" << escapeJson(argv[0]) << "\",\n";
+  json << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n";
+  json << "    \"threads\": " << options.threads << ",\n";
+  json << "    \"kernels\": \"" << escapeJson(activeKernels()) << "\"\n";
+  json << "  },\n";
+  json << "  \"benchmarks\": [";
+  for (std::size_t i = 0; i < results.size(); ++i) {
+    Result const& result = results[i];
+    json << (i == 0 ? "\n" : ",\n");
+    json << "    {\n";
+    json << "      \"name\": \"" << result.name << "\",\n";
+    json << "      \"run_type\": \"iteration\",\n";
+    json << "      \"bits\": " << result.bits << ",\n";
+    json << "      \"iterations\": " << result.iterations << ",\n";
+    json << "      \"real_time\": " << result.realTime << ",\n";
+    json << "      \"cpu_time\": " << result.cpuTime << ",\n";
+    json << "      \"time_unit\": \"ns\"\n";
+    json << "    }";
+  }
+  json << "\n  ]\n}\n";
+
+  if (options.out.empty()) {
+    std::cout << json.str();
+  }
+  else {
+    std::ofstream file(options.out);
+    file << json.str();
+    if (!file) {
+      std::cerr << "could not write to " << options.out << '\n';
+      return 1;
+    }
+  }
+  return 0;
+}
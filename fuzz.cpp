@@ -0,0 +1,488 @@
+#include "include/cpu_dispatch.h"
+#include "include/integer.h"
+#include "include/math_integer.h"
+#include "include/random.h"
+#include "include/serialization.h"
+#include "include/thread_pool.h"
+#include "include/thresholds.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Checks the Integer arithmetic against a simple reference implementation, and
+// checks every algorithm tier, every set of kernels and the parallel code paths
+// against each other. The operands are sized to fall on both sides of every
+// threshold, and include the edge cases that carries and borrows get wrong.
+//
+// Built normally, this runs a fixed number of random cases and exits with a
+// non-zero status if any of them fail. Built with APRN_LIBFUZZER defined (and
+// -fsanitize=fuzzer), the same checks are run on the inputs that libFuzzer
+// generates instead.
+//
+// Options:
+//   --iterations=N   The number of random cases to run (default 300)
+//   --seed=N         The seed for the random cases (default 1)
+
+using namespace aprn;
+
+namespace {
+
+  // The reference implementation, which is as simple as possible so that it is
+  // obviously right. Magnitudes are stored as 32 bit words, least significant
+  // first, with no leading zeros.
+  struct Reference {
+    std::vector<std::uint32_t> words;
+    bool isNegative = false;
+  };
+
+  void trim(Reference& val) {
+    while (!val.words.empty() && val.words.back() == 0) {
+      val.words.pop_back();
+    }
+    if (val.words.empty()) {
+      val.isNegative = false;
+    }
+  }
+
+  int compareMagnitude(Reference const& lhs, Reference const& rhs) {
+    if (lhs.words.size() != rhs.words.size()) {
+      return lhs.words.size() < rhs.words.size() ? -1 : 1;
+    }
+    for (std::size_t i = lhs.words.size(); i != 0; --i) {
+      if (lhs.words[i - 1] != rhs.words[i - 1]) {
+        return lhs.words[i - 1] < rhs.words[i - 1] ? -1 : 1;
+      }
+    }
+    return 0;
+  }
+
+  Reference addMagnitude(Reference const& lhs, Reference const& rhs) {
+    Reference result;
+    std::uint64_t carry = 0;
+    for (std::size_t i = 0; i < std::max(lhs.words.size(), rhs.words.size()); ++i) {
+      carry += i < lhs.words.size() ? lhs.words[i] : 0;
+      carry += i < rhs.words.size() ? rhs.words[i] : 0;
+      result.words.push_back((std::uint32_t) carry);
+      carry >>= 32;
+    }
+    result.words.push_back((std::uint32_t) carry);
+    trim(result);
+    return result;
+  }
+
+  // The magnitude of lhs must be at least that of rhs.
+  Reference subtractMagnitude(Reference const& lhs, Reference const& rhs) {
+    Reference result;
+    std::int64_t borrow = 0;
+    for (std::size_t i = 0; i < lhs.words.size(); ++i) {
+      std::int64_t difference = (std::int64_t) lhs.words[i] - borrow -
+                                (i < rhs.words.size() ? rhs.words[i] : 0);
+      borrow = difference < 0;
+      result.words.push_back((std::uint32_t) (difference + (borrow << 32)));
+    }
+    trim(result);
+    return result;
+  }
+
+  Reference add(Reference const& lhs, Reference const& rhs) {
+    Reference result;
+    if (lhs.isNegative == rhs.isNegative) {
+      result = addMagnitude(lhs, rhs);
+      result.isNegative = lhs.isNegative;
+    }
+    else if (compareMagnitude(lhs, rhs) >= 0) {
+      result = subtractMagnitude(lhs, rhs);
+      result.isNegative = lhs.isNegative;
+    }
+    else {
+      result = subtractMagnitude(rhs, lhs);
+      result.isNegative = rhs.isNegative;
+    }
+    trim(result);
+    return result;
+  }
+
+  Reference negate(Reference val) {
+    val.isNegative = !val.isNegative;
+    trim(val);
+    return val;
+  }
+
+  Reference multiply(Reference const& lhs, Reference const& rhs) {
+    Reference result;
+    result.words.assign(lhs.words.size() + rhs.words.size(), 0);
+    for (std::size_t i = 0; i < lhs.words.size(); ++i) {
+      std::uint64_t carry = 0;
+      for (std::size_t j = 0; j < rhs.words.size(); ++j) {
+        carry += (std::uint64_t) lhs.words[i] * rhs.words[j] + result.words[i + j];
+        result.words[i + j] = (std::uint32_t) carry;
+        carry >>= 32;
+      }
+      result.words[i + rhs.words.size()] = (std::uint32_t) carry;
+    }
+    result.isNegative = lhs.isNegative != rhs.isNegative;
+    trim(result);
+    return result;
+  }
+
+  // Long division one bit at a time, truncating towards zero like Integer.
+  void divide(Reference const& lhs, Reference const& rhs, Reference& quot_out, Reference& rem_out) {
+    Reference quot;
+    Reference rem;
+    Reference divisor = rhs;
+    divisor.isNegative = false;
+    quot.words.assign(lhs.words.size(), 0);
+    for (std::size_t bit = 32 * lhs.words.size(); bit != 0; --bit) {
+      // rem = 2 * rem + the next bit of lhs.
+      rem = addMagnitude(rem, rem);
+      if ((lhs.words[(bit - 1) / 32] >> ((bit - 1) % 32)) & 1) {
+        rem = addMagnitude(rem, Reference{ { 1 }, false });
+      }
+      if (compareMagnitude(rem, divisor) >= 0) {
+        rem = subtractMagnitude(rem, divisor);
+        quot.words[(bit - 1) / 32] |= std::uint32_t(1) << ((bit - 1) % 32);
+      }
+    }
+    quot.isNegative = lhs.isNegative != rhs.isNegative;
+    rem.isNegative = lhs.isNegative;
+    trim(quot);
+    trim(rem);
+    quot_out = quot;
+    rem_out = rem;
+  }
+
+  std::string toDecimal(Reference val) {
+    if (val.words.empty()) {
+      return "0";
+    }
+    std::string digits;
+    while (!val.words.empty()) {
+      std::uint64_t rem = 0;
+      for (std::size_t i = val.words.size(); i != 0; --i) {
+        rem = (rem << 32) | val.words[i - 1];
+        val.words[i - 1] = (std::uint32_t) (rem / 10);
+        rem %= 10;
+      }
+      digits.push_back((char) ('0' + rem));
+      bool isNegative = val.isNegative;
+      trim(val);
+      val.isNegative = isNegative;
+    }
+    if (val.isNegative) {
+      digits.push_back('-');
+    }
+    return std::string(digits.rbegin(), digits.rend());
+  }
+
+  Reference toReference(Integer const& val) {
+    std::vector<std::uint8_t> bytes = exportBytes(val);
+    Reference result;
+    result.words.assign((bytes.size() + 3) / 4, 0);
+    for (std::size_t i = 0; i < bytes.size(); ++i) {
+      result.words[i / 4] |= (std::uint32_t) bytes[i] << (8 * (i % 4));
+    }
+    result.isNegative = signum(val) < 0;
+    trim(result);
+    return result;
+  }
+
+  bool operator==(Reference const& lhs, Reference const& rhs) {
+    return lhs.isNegative == rhs.isNegative && lhs.words == rhs.words;
+  }
+
+  // The reference is quadratic or worse, so it is only used up to this size.
+  unsigned long long const REFERENCE_MAX_BITS = 6000;
+
+  // The configurations that every operation is run under, so that every tier
+  // of every algorithm gets compared with the others. The first is the one that
+  // the others are compared against.
+  struct Configuration {
+    std::string name;
+    Thresholds thresholds;
+    unsigned threads;
+  };
+
+  std::vector<Configuration> makeConfigurations() {
+    std::vector<Configuration> result;
+    Thresholds const defaults = defaultThresholds();
+    result.push_back({ "default", defaults, 1 });
+    // The simplest algorithms all the way up.
+    Thresholds simple;
+    simple.karatsuba = simple.parallel = simple.recursiveDivision = simple.radixConversion = 1 << 30;
+    result.push_back({ "simple", simple, 1 });
+    // The fastest algorithms all the way down, split between threads.
+    Thresholds fast;
+    fast.karatsuba = 2;
+    fast.parallel = 1;
+    fast.recursiveDivision = 2;
+    fast.radixConversion = 1;
+    result.push_back({ "fast", fast, 4 });
+    // Each threshold low on its own.
+    Thresholds karatsuba = simple;
+    karatsuba.karatsuba = 3;
+    result.push_back({ "karatsuba", karatsuba, 1 });
+    Thresholds division = simple;
+    division.recursiveDivision = 3;
+    result.push_back({ "recursiveDivision", division, 1 });
+    // The default thresholds, with the large products split between threads.
+    result.push_back({ "parallel", defaults, 4 });
+    return result;
+  }
+
+  int failures = 0;
+
+  void fail(std::string const& what, Integer const& a, Integer const& b) {
+    ++failures;
+    std::cerr << "FAILED: " << what << '\n';
+    std::cerr << "  a = 0x" << toString(a, 16) << '\n';
+    std::cerr << "  b = 0x" << toString(b, 16) << '\n';
+  }
+
+  void check(bool isCorrect, std::string const& what, Integer const& a, Integer const& b) {
+    if (!isCorrect) {
+      fail(what, a, b);
+    }
+  }
+
+  // The results of the operations whose algorithm depends on the configuration.
+  struct Results {
+    Integer product;
+    Integer square;
+    Integer quot;
+    Integer rem;
+    std::string decimal;
+    Integer parsed;
+  };
+
+  Results compute(Integer const& a, Integer const& b) {
+    Results result;
+    result.product = a * b;
+    result.square = a * a;
+    if (signum(b) != 0) {
+      div_result parts = div(a, b);
+      result.quot = parts.quot;
+      result.rem = parts.rem;
+    }
+    result.decimal = toString(a);
+    fromString(result.decimal, 10, result.parsed);
+    return result;
+  }
+
+  // Runs every check on a pair of operands.
+  void checkOperands(Integer const& a, Integer const& b) {
+    std::vector<Configuration> const configurations = makeConfigurations();
+    std::vector<std::string> const kernels = supportedKernels();
+    std::string const originalKernels = activeKernels();
+    Thresholds const originalThresholds = thresholds();
+    unsigned const originalThreads = threadLimit();
+
+    // Every configuration has to agree with the first, and so does every set of
+    // kernels. The kernels only change the inner loops, which every
+    // configuration uses, so they are only run with the first one.
+    Results expected;
+    for (std::size_t i = 0; i < configurations.size() + kernels.size(); ++i) {
+      Configuration const& configuration = configurations[i < configurations.size() ? i : 0];
+      std::string const& kernel = i < configurations.size() ? originalKernels : kernels[i - configurations.size()];
+      useKernels(kernel);
+      setThresholds(configuration.thresholds);
+      setThreadLimit(configuration.threads);
+      Results results = compute(a, b);
+      if (i == 0) {
+        expected = results;
+        continue;
+      }
+      std::string where = " (" + configuration.name + ", " + kernel + ")";
+      check(results.product == expected.product, "a * b" + where, a, b);
+      check(results.square == expected.square, "a * a" + where, a, b);
+      check(results.quot == expected.quot, "a / b" + where, a, b);
+      check(results.rem == expected.rem, "a % b" + where, a, b);
+      check(results.decimal == expected.decimal, "toString(a)" + where, a, b);
+      check(results.parsed == expected.parsed, "fromString(toString(a))" + where, a, b);
+    }
+    useKernels(originalKernels);
+    setThresholds(originalThresholds);
+    setThreadLimit(originalThreads);
+
+    // Identities that have to hold whatever the algorithm.
+    check(expected.parsed == a, "fromString(toString(a)) == a", a, b);
+    Integer parsedHex;
+    check(fromString(toString(a, 16), 16, parsedHex) && parsedHex == a, "hexadecimal round trip", a, b);
+    Integer parsedSeven;
+    check(fromString(toString(b, 7), 7, parsedSeven) && parsedSeven == b, "base 7 round trip", a, b);
+    check((a + b) - b == a, "(a + b) - b == a", a, b);
+    check(((a << 77) >> 77) == a, "(a << 77) >> 77 == a", a, b);
+    if (signum(b) != 0) {
+      check(expected.quot * b + expected.rem == a, "(a / b) * b + a % b == a", a, b);
+      check(abs(expected.rem) < abs(b), "|a % b| < |b|", a, b);
+      check(signum(expected.rem) == 0 || signum(expected.rem) == signum(a), "sign of a % b", a, b);
+      Integer divisor = gcd(a, b);
+      check(signum(divisor) > 0 && signum(a % divisor) == 0 && signum(b % divisor) == 0,
+            "gcd(a, b) divides a and b", a, b);
+    }
+
+    // The reference, for operands that it can handle in reasonable time.
+    if (std::max(bitLength(a), bitLength(b)) > REFERENCE_MAX_BITS) {
+      return;
+    }
+    Reference refA = toReference(a);
+    Reference refB = toReference(b);
+    check(toReference(a + b) == add(refA, refB), "a + b against the reference", a, b);
+    check(toReference(a - b) == add(refA, negate(refB)), "a - b against the reference", a, b);
+    check(toReference(expected.product) == multiply(refA, refB), "a * b against the reference", a, b);
+    check(expected.decimal == toDecimal(refA), "toString(a) against the reference", a, b);
+    if (signum(b) != 0) {
+      Reference quot;
+      Reference rem;
+      divide(refA, refB, quot, rem);
+      check(toReference(expected.quot) == quot, "a / b against the reference", a, b);
+      check(toReference(expected.rem) == rem, "a % b against the reference", a, b);
+    }
+  }
+
+#ifndef APRN_LIBFUZZER
+  // The sizes that operands are drawn from, in bits, which straddle each of the
+  // default thresholds.
+  std::vector<unsigned long long> makeSizes() {
+    Thresholds const defaults = defaultThresholds();
+    std::vector<unsigned long long> centers = {
+      64 * defaults.karatsuba,
+      2 * 64 * defaults.karatsuba,
+      32 * defaults.recursiveDivision,
+      64 * defaults.radixConversion
+    };
+    std::vector<unsigned long long> result = { 0, 1, 7, 8, 9, 31, 32, 33, 63, 64, 65, 127, 128, 129 };
+    for (unsigned long long center : centers) {
+      for (unsigned long long offset : { 0ULL, 1ULL, 63ULL, 64ULL, 65ULL }) {
+        result.push_back(center + offset);
+        if (center > offset) {
+          result.push_back(center - offset);
+        }
+      }
+    }
+    // The parallel threshold is much larger than the others, so only a limb either
+    // side of it is tried, to keep the run short.
+    result.push_back(64 * (defaults.parallel - 1));
+    result.push_back(64 * (defaults.parallel + 1));
+    return result;
+  }
+
+  // Makes an operand of about the given size, in one of several patterns that
+  // tend to find mistakes with carries and borrows.
+  template <typename URBG>
+  Integer makeOperand(unsigned long long bits, URBG& urbg) {
+    if (bits == 0) {
+      return Integer();
+    }
+    Integer result;
+    switch (urbg() % 7) {
+    case 0:
+      // All ones.
+      result = (Integer(1) << bits) - 1;
+      break;
+    case 1:
+      // A power of two.
+      result = Integer(1) << (bits - 1);
+      break;
+    case 2:
+      // Just over a power of two.
+      result = (Integer(1) << (bits - 1)) + randomBits(std::min<unsigned long long>(bits - 1, 64), urbg);
+      break;
+    case 3:
+      // A few long runs of ones and zeros.
+      result = Integer(1) << (bits - 1);
+      for (int run = 0; run < 4; ++run) {
+        unsigned long long low = urbg() % bits;
+        unsigned long long high = low + urbg() % (bits - low);
+        result |= ((Integer(1) << (high - low)) - 1) << low;
+      }
+      break;
+    case 4:
+      // Near a power of ten, which has long runs of zeros in decimal.
+      result = pow(Integer(10), bits * 3 / 10) + Integer((unsigned long long) (urbg() % 1000));
+      break;
+    default:
+      result = randomBits(bits - 1, urbg) | (Integer(1) << (bits - 1));
+      break;
+    }
+    if (urbg() % 2 != 0) {
+      result.negate();
+    }
+    return result;
+  }
+
+  bool parseOption(std::string const& arg, std::string const& name, std::string& value_out) {
+    std::string prefix = "--" + name + "=";
+    if (arg.compare(0, prefix.size(), prefix) != 0) {
+      return false;
+    }
+    value_out = arg.substr(prefix.size());
+    return true;
+  }
+#endif
+
+}
+
+#ifdef APRN_LIBFUZZER
+
+// The first byte chooses where the input is split between the two operands, and
+// the second one their signs.
+extern "C" int LLVMFuzzerTestOneInput(std::uint8_t const* data, std::size_t size) {
+  if (size < 2) {
+    return 0;
+  }
+  std::size_t split = 2 + (size - 2) * data[0] / 255;
+  Integer a = importBytes(data + 2, split - 2, ByteOrder::LittleEndian, (data[1] & 1) != 0);
+  Integer b = importBytes(data + split, size - split, ByteOrder::LittleEndian, (data[1] & 2) != 0);
+  checkOperands(a, b);
+  if (failures != 0) {
+    std::abort();
+  }
+  return 0;
+}
+
+#else
+
+int main(int argc, char** argv) {
+  unsigned long long iterations = 300;
+  unsigned long long seed = 1;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    std::string value;
+    if (parseOption(arg, "iterations", value)) {
+      iterations = std::strtoull(value.c_str(), nullptr, 10);
+    }
+    else if (parseOption(arg, "seed", value)) {
+      seed = std::strtoull(value.c_str(), nullptr, 10);
+    }
+    else {
+      std::cerr << "unknown option: " << arg << '\n';
+      return 1;
+    }
+  }
+
+  std::mt19937_64 engine(seed);
+  std::vector<unsigned long long> const sizes = makeSizes();
+  for (unsigned long long i = 0; i < iterations; ++i) {
+    // Usually both operands are near thresholds, but sometimes one is much
+    // smaller, which is the unbalanced case.
+    unsigned long long sizeA = sizes[engine() % sizes.size()];
+    unsigned long long sizeB = engine() % 4 == 0 ? engine() % (sizeA + 1) : sizes[engine() % sizes.size()];
+    Integer a = makeOperand(sizeA, engine);
+    Integer b = makeOperand(sizeB, engine);
+    checkOperands(a, b);
+    if (failures != 0) {
+      std::cerr << "seed " << seed << ", iteration " << i << '\n';
+      return 1;
+    }
+  }
+  std::cout << iterations << " cases passed\n";
+  return 0;
+}
+
+#endif
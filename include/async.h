@@ -0,0 +1,146 @@
+#ifndef __APRN_ASYNC_H_
+#define __APRN_ASYNC_H_
+
+#include <atomic>
+#include <exception>
+#include <future>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "integer.h"
+#include "math_integer.h"
+
+namespace aprn {
+
+  /**
+   * @class CancellationToken
+   * @brief A flag shared between an operation and whoever started it, for stopping the operation early.
+   *
+   * Copies of a token share the same flag, so cancelling any copy cancels them
+   * all. The long running loops inside the Integer operations check the token
+   * of the current thread (see CancellationScope) every so often, and throw an
+   * OperationCancelled exception once it has been cancelled. This is the only
+   * place that the library throws exceptions, and only operations that have
+   * been given a token can be cancelled.
+   *
+   * @author Duane Byer
+   */
+  class CancellationToken {
+
+  public:
+
+    /// @brief Constructs a token that hasn't been cancelled.
+    CancellationToken() : m_isCancelled(std::make_shared<std::atomic<bool>>(false)) {}
+
+    /// @brief Asks the operations using this token to stop.
+    void cancel() {
+      if (m_isCancelled) {
+        m_isCancelled->store(true, std::memory_order_relaxed);
+      }
+    }
+    /// @brief Returns whether the token has been cancelled.
+    bool isCancelled() const {
+      return m_isCancelled && m_isCancelled->load(std::memory_order_relaxed);
+    }
+
+  private:
+
+    friend class CancellationScope;
+    friend CancellationToken currentCancellationToken();
+
+    // A token without a flag can never be cancelled. These are only made for
+    // threads that have no token.
+    explicit CancellationToken(std::shared_ptr<std::atomic<bool>> isCancelled) :
+      m_isCancelled(std::move(isCancelled)) {}
+
+    std::shared_ptr<std::atomic<bool>> m_isCancelled;
+
+  };
+
+  /**
+   * @class OperationCancelled
+   * @brief The exception thrown out of an operation whose token was cancelled.
+   *
+   * The futures returned by the asynchronous functions rethrow it from get().
+   */
+  class OperationCancelled : public std::exception {
+
+  public:
+
+    char const* what() const noexcept override {
+      return "operation cancelled";
+    }
+
+  };
+
+  /**
+   * @class CancellationScope
+   * @brief Makes a token the one that is checked on the current thread, until the end of a scope.
+   *
+   * Scopes can be nested, and the previous token is restored at the end of
+   * each one. Work that an operation hands off to other threads is checked
+   * against the same token.
+   */
+  class CancellationScope {
+
+  public:
+
+    explicit CancellationScope(CancellationToken const& token);
+    ~CancellationScope();
+
+    CancellationScope(CancellationScope const&) = delete;
+    CancellationScope& operator=(CancellationScope const&) = delete;
+
+  private:
+
+    std::shared_ptr<std::atomic<bool>> m_previous;
+
+  };
+
+  /**
+   * @brief Throws OperationCancelled if the token of the current thread has been cancelled.
+   *
+   * This is cheap enough to call from inside loops, and does nothing if the
+   * current thread has no token.
+   */
+  void checkCancelled();
+  /**
+   * @brief Returns a copy of the token of the current thread.
+   *
+   * If the current thread has no token, the token returned can never be
+   * cancelled.
+   */
+  CancellationToken currentCancellationToken();
+
+  /*@{*/
+  /**
+   * @brief Starts an operation on another thread, returning a future for its result.
+   *
+   * The operands are taken by value, so they can be changed or destroyed while
+   * the operation runs, and passing them with std::move avoids copying them at
+   * all. The operation checks the token as it goes, and stops if it is
+   * cancelled, in which case the future throws OperationCancelled from get().
+   * The number of threads is used as the thread limit of the operation (see
+   * setThreadLimit).
+   */
+  std::future<Integer> asyncMul(Integer lhs, Integer rhs,
+                                CancellationToken token = CancellationToken(),
+                                unsigned threads = 1);
+  std::future<div_result> asyncDiv(Integer lhs, Integer rhs,
+                                   CancellationToken token = CancellationToken(),
+                                   unsigned threads = 1);
+  std::future<Integer> asyncPow(Integer base, unsigned long long exponent,
+                                CancellationToken token = CancellationToken(),
+                                unsigned threads = 1);
+  std::future<Integer> asyncFactorial(unsigned long long n,
+                                      CancellationToken token = CancellationToken(),
+                                      unsigned threads = 1);
+  std::future<std::string> asyncToString(Integer val, int base = 10,
+                                         CancellationToken token = CancellationToken(),
+                                         unsigned threads = 1);
+  /*@}*/
+
+}
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef __APRN_BINARY_SPLITTING_H_
+#define __APRN_BINARY_SPLITTING_H_
+
+#include <functional>
+
+#include "integer.h"
+
+namespace aprn {
+
+  /**
+   * @struct series_result
+   * @brief Stores the exact result of evaluating a series by binary splitting.
+   *
+   * The value of the series is given by the fraction series_result::t divided by
+   * series_result::q. The field series_result::p is the product of all of the
+   * p(k) terms, and is needed to combine the result with an adjacent range.
+   */
+  struct series_result {
+    /// The product of the p(k) terms.
+    Integer p;
+    /// The product of the q(k) terms.
+    Integer q;
+    /// The numerator of the series, over the denominator series_result::q.
+    Integer t;
+  };
+
+  /// @brief The type of the callbacks that give the terms of a series.
+  using SeriesTerm = std::function<Integer(unsigned long long)>;
+
+  /**
+   * @brief Evaluates a hypergeometric-like series exactly using binary splitting.
+   *
+   * The series being evaluated is
+   *
+   *     S = sum_{k = first}^{last - 1} a(k) * prod_{j = first}^{k} p(j) / q(j)
+   *
+   * and it is returned as the fraction series_result::t / series_result::q. The
+   * range is split at its midpoint at each step, so that the Integers being
+   * multiplied together are always of similar sizes. An empty range gives a
+   * result of zero, with both products equal to one.
+   *
+   * If more than one thread is requested, then the two halves of the range are
+   * evaluated concurrently on the shared pool (see threadPool()), with the
+   * threads divided evenly between them. The callbacks must be safe to call
+   * from multiple threads in that case. The work is checked against the
+   * cancellation token of the calling thread, on whichever thread it runs.
+   *
+   * @param first The index of the first term of the series
+   * @param last One past the index of the last term of the series
+   * @param p The numerator of the ratio between adjacent terms
+   * @param q The denominator of the ratio between adjacent terms
+   * @param a An additional factor applied to each term individually
+   * @param threads The maximum number of threads to evaluate the series with
+   */
+  series_result binarySplit(unsigned long long first, unsigned long long last,
+                            SeriesTerm const& p, SeriesTerm const& q, SeriesTerm const& a,
+                            unsigned threads = 1);
+
+  /**
+   * @brief Combines the results of binary splitting over two adjacent ranges.
+   *
+   * The left hand side must cover the range immediately before the right hand
+   * side. This can be used to extend a series that has already been evaluated
+   * without evaluating the earlier terms again.
+   */
+  series_result combine(series_result const& lhs, series_result const& rhs);
+
+}
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef __APRN_CPU_DISPATCH_H_
+#define __APRN_CPU_DISPATCH_H_
+
+#include <string>
+#include <vector>
+
+namespace aprn {
+  
+  /**
+   * @struct CpuFeatures
+   * @brief The instruction set extensions that the processor supports.
+   * 
+   * These are detected once, when first asked for. On processors other than
+   * x86, all of the fields are false.
+   */
+  struct CpuFeatures {
+    /// Whether the BMI2 instructions (including mulx) are available.
+    bool bmi2;
+    /// Whether the ADX add with carry instructions are available.
+    bool adx;
+    /// Whether the AVX2 instructions are available.
+    bool avx2;
+    /// Whether the AVX-512 foundation instructions are available.
+    bool avx512f;
+    /// Whether the AVX-512 byte and word instructions are available.
+    bool avx512bw;
+    /// Whether the AVX-512 integer fused multiply add instructions are available.
+    bool avx512ifma;
+  };
+  
+  /// @brief Returns the instruction set extensions that the processor supports.
+  CpuFeatures const& cpuFeatures();
+  
+  /**
+   * @brief Returns the name of the kernels that the Integer arithmetic is using.
+   * 
+   * The inner loops of Integer are written several times, for different
+   * instruction sets, and the best version for the processor is chosen when
+   * the program starts. The name lists the instruction sets, such as
+   * "avx512+adx", or "generic" for the portable version.
+   */
+  std::string activeKernels();
+  /// @brief Returns the names of all of the kernels that the processor can use, from best to worst.
+  std::vector<std::string> supportedKernels();
+  /**
+   * @brief Switches the Integer arithmetic over to the kernels with the given name.
+   * 
+   * This is meant for testing and for comparing the kernels, and should not be
+   * done while other threads are using Integers. Returns false, and does
+   * nothing, if there are no kernels with that name that the processor can use.
+   */
+  bool useKernels(std::string const& name);
+  
+}
+
+#endif
@@ -0,0 +1,178 @@
+#ifndef __APRN_DECIMAL_H_
+#define __APRN_DECIMAL_H_
+
+#include <istream>
+#include <ostream>
+#include <string>
+
+#include "integer.h"
+#include "rational.h"
+#include "real.h"
+
+namespace aprn {
+
+  /**
+   * @class Decimal
+   * @brief An exact decimal number, made of an Integer coefficient and a scale.
+   *
+   * The value of a Decimal is coefficient / 10^scale. Addition, subtraction and
+   * multiplication are exact, and give a result with the larger scale, or the
+   * sum of the scales for multiplication. Since the scale only ever needs
+   * powers of ten, there is never any gcd to find, unlike for a Rational.
+   * Anything that can't be exact, such as division, takes the scale of the
+   * result and a RoundingMode, the same one that Real uses: Down and Up round
+   * towards negative and positive infinity, and Nearest rounds ties to even.
+   * @author Duane Byer
+   */
+  class Decimal {
+
+    friend std::ostream& operator<<(std::ostream& os, Decimal const& obj);
+    friend std::istream& operator>>(std::istream& is, Decimal& obj);
+
+  public:
+
+    /// @brief Constructs a Decimal with a value of zero.
+    Decimal();
+    /// @brief Constructs a Decimal with the value of an Integer, and a scale of zero.
+    Decimal(Integer val);
+    /// @brief Constructs the Decimal coefficient / 10^scale.
+    Decimal(Integer coefficient, unsigned long long scale);
+
+    /// @brief Gives the exact value of this Decimal as a Rational.
+    explicit operator Rational() const;
+    /// @brief Gives the value of this Decimal as an Integer, truncating towards zero.
+    explicit operator Integer() const;
+
+    /// @brief Returns the coefficient, which has the same sign as the Decimal.
+    Integer const& coefficient() const {
+      return m_coefficient;
+    }
+    /// @brief Returns the number of digits after the decimal point.
+    unsigned long long scale() const {
+      return m_scale;
+    }
+
+    /// @brief Gives the negative of this Decimal.
+    Decimal operator-() const;
+    /// @brief Negates this Decimal in place.
+    Decimal& negate();
+    /*@{*/
+    /// @brief Returns this Decimal unchanged.
+    Decimal const& operator+() const {
+      return *this;
+    }
+    Decimal operator+() {
+      return *this;
+    }
+    /*@}*/
+
+    /// @brief Adds another Decimal to this one.
+    Decimal& operator+=(Decimal const& rhs);
+    /// @brief Subtracts another Decimal from this one.
+    Decimal& operator-=(Decimal const& rhs);
+    /// @brief Multiplies another Decimal to this one.
+    Decimal& operator*=(Decimal const& rhs);
+
+  private:
+
+    // Implementation Details
+    //-----------------------
+    //   Unlike a Rational, a Decimal is not normalized, so 1.5 and 1.50 are
+    // different representations of the same value. They compare equal, but
+    // keep their own scales, which decide how many digits are written out.
+
+    Integer m_coefficient;
+    unsigned long long m_scale;
+
+  };
+
+  /// @brief Checks if this Decimal has the same value as another one, whatever their scales.
+  bool operator==(Decimal const& lhs, Decimal const& rhs);
+  /// @brief Checks if this Decimal is smaller than another one.
+  bool operator<(Decimal const& lhs, Decimal const& rhs);
+
+  /// @brief Checks if this Decimal does not equal another one.
+  inline bool operator!=(Decimal const& lhs, Decimal const& rhs) {
+    return !operator==(lhs, rhs);
+  }
+  /// @brief Checks if this Decimal is greater than another one.
+  inline bool operator>(Decimal const& lhs, Decimal const& rhs) {
+    return operator<(rhs, lhs);
+  }
+  /// @brief Checks if this Decimal is smaller than or equal to another one.
+  inline bool operator<=(Decimal const& lhs, Decimal const& rhs) {
+    return !operator>(lhs, rhs);
+  }
+  /// @brief Checks if this Decimal is greater than or equal to another one.
+  inline bool operator>=(Decimal const& lhs, Decimal const& rhs) {
+    return !operator<(lhs, rhs);
+  }
+
+  /// @brief Returns the sum of two Decimals.
+  inline Decimal operator+(Decimal lhs, Decimal const& rhs) {
+    lhs += rhs;
+    return lhs;
+  }
+  /// @brief Returns the difference of two Decimals.
+  inline Decimal operator-(Decimal lhs, Decimal const& rhs) {
+    lhs -= rhs;
+    return lhs;
+  }
+  /// @brief Returns the product of two Decimals.
+  inline Decimal operator*(Decimal lhs, Decimal const& rhs) {
+    lhs *= rhs;
+    return lhs;
+  }
+
+  /**
+   * @brief Gives a Decimal the same value rounded to a different scale.
+   *
+   * Raising the scale is always exact, and only multiplies the coefficient by
+   * a power of ten. The small powers of ten are kept in a table, so rescaling
+   * by a few digits costs a single multiplication or division by a word.
+   */
+  Decimal rescale(Decimal const& val, unsigned long long scale, RoundingMode mode = RoundingMode::Nearest);
+  /**
+   * @brief Divides one Decimal by another, rounding the quotient to a certain scale.
+   *
+   * Returns false if the divisor is zero.
+   * @param lhs The dividend
+   * @param rhs The divisor
+   * @param scale The number of digits after the decimal point in the quotient
+   * @param mode How to round the quotient
+   * @param result_out Where the quotient is stored
+   */
+  bool divide(Decimal const& lhs, Decimal const& rhs, unsigned long long scale, RoundingMode mode,
+              Decimal& result_out);
+  /// @brief Rounds a Rational to a Decimal with a certain scale.
+  Decimal toDecimal(Rational const& val, unsigned long long scale, RoundingMode mode = RoundingMode::Nearest);
+
+  /**
+   * @brief Converts a Decimal to a string of decimal digits.
+   *
+   * There are exactly as many digits after the decimal point as the scale, and
+   * there is no decimal point if the scale is zero. The digits of the
+   * coefficient are found all at once by toString, and then the point is put in.
+   */
+  std::string toString(Decimal const& val);
+  /**
+   * @brief Reads a Decimal from a string, such as "-12.340" or "1.5e-3".
+   *
+   * The scale is the number of digits after the decimal point, less the
+   * exponent. If that would be negative, then the scale is zero instead, and
+   * the coefficient takes the extra zeros. Returns false if the string is not
+   * a valid Decimal, or if its exponent is more than 100000 either way, so
+   * that untrusted text can't ask for an enormous coefficient or scale.
+   * @param str The string to read
+   * @param result_out Where the Decimal is stored
+   */
+  bool fromString(std::string const& str, Decimal& result_out);
+
+  /// @brief Outputs a Decimal to a standard stream.
+  std::ostream& operator<<(std::ostream& os, Decimal const& obj);
+  /// @brief Reads in a Decimal from a standard stream, in the same format as fromString.
+  std::istream& operator>>(std::istream& is, Decimal& obj);
+
+}
+
+#endif
@@ -0,0 +1,744 @@
+#ifndef __APRN_FIXED_INTEGER_H_
+#define __APRN_FIXED_INTEGER_H_
+
+#include <array>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <type_traits>
+
+#include "integer.h"
+
+namespace aprn {
+
+  /**
+   * @class FixedInteger
+   * @brief An integer type with a fixed number of bits, stored without any allocation.
+   *
+   * A FixedInteger behaves like a built in integral type with the given number
+   * of bits. Signed FixedIntegers use two's complement, and all arithmetic
+   * wraps around modulo two to the power of the number of bits, so that no
+   * operation can fail. Division truncates towards zero, and right shifts of
+   * negative values round towards negative infinity, as with the built in types.
+   *
+   * Every operation works on a fixed size array of limbs with loops of a fixed
+   * length, so that the compiler is able to unroll them completely, and every
+   * operation can be used in constant expressions. FixedIntegers can be
+   * converted to and from Integers, so that an inner loop can work entirely on
+   * FixedIntegers without allocating.
+   *
+   * @tparam Bits The number of bits, including the sign bit if there is one
+   * @tparam Signed Whether the FixedInteger can hold negative values
+   * @author Duane Byer
+   */
+  template <std::size_t Bits, bool Signed = true>
+  class FixedInteger {
+
+    static_assert(Bits > 0, "A FixedInteger must have at least one bit");
+
+  public:
+
+    /// @brief The type used for the limbs of a FixedInteger.
+    using Limb = std::uint32_t;
+    /// @brief A type that can hold the product of two limbs.
+    using DoubleLimb = std::uint64_t;
+
+    /// @brief The number of bits in a limb.
+    static constexpr std::size_t LIMB_BITS = CHAR_BIT * sizeof(Limb);
+    /// @brief The number of limbs used to store a FixedInteger.
+    static constexpr std::size_t LIMBS = (Bits + LIMB_BITS - 1) / LIMB_BITS;
+
+    /// @brief The type used to store the limbs, least significant first.
+    using Limbs = std::array<Limb, LIMBS>;
+
+    /// @brief Constructs a FixedInteger with a value of zero.
+    constexpr FixedInteger() : m_limbs() {}
+
+    /**
+     * @brief Constructs a FixedInteger to have a certain value.
+     *
+     * This constructor can also be used to implicitly convert any integral
+     * type to a FixedInteger. Values that don't fit are wrapped around.
+     */
+    template <typename T, typename std::enable_if<std::is_integral<T>::value, int>::type = 0>
+    constexpr FixedInteger(T val) : m_limbs() {
+      // Negative values are sign extended through all of the limbs, and then
+      // the extra bits are cleaned up by makeValid.
+      unsigned long long bits = (unsigned long long) val;
+      Limb fill = (std::is_signed<T>::value && val < 0) ? ~(Limb) 0 : 0;
+      for (std::size_t i = 0; i < LIMBS; ++i) {
+        if (i * LIMB_BITS < CHAR_BIT * sizeof(unsigned long long)) {
+          m_limbs[i] = (Limb) (bits >> (i * LIMB_BITS));
+        }
+        else {
+          m_limbs[i] = fill;
+        }
+      }
+      makeValid();
+    }
+
+    /// @brief Constructs a FixedInteger directly from its limbs, least significant first.
+    constexpr explicit FixedInteger(Limbs const& limbs) : m_limbs(limbs) {
+      makeValid();
+    }
+
+    /**
+     * @brief Converts from a FixedInteger of a different size or signedness.
+     *
+     * As with the built in types, the value is sign extended if the source is
+     * signed, and wrapped around if it doesn't fit.
+     */
+    template <std::size_t OtherBits, bool OtherSigned>
+    constexpr explicit FixedInteger(FixedInteger<OtherBits, OtherSigned> const& other) : m_limbs() {
+      Limb fill = (OtherSigned && other.isNegative()) ? ~(Limb) 0 : 0;
+      for (std::size_t i = 0; i < LIMBS; ++i) {
+        m_limbs[i] = i < other.LIMBS ? other.limbs()[i] : fill;
+      }
+      makeValid();
+    }
+
+    /**
+     * @brief Converts an Integer to a FixedInteger.
+     *
+     * If the Integer doesn't fit, then it is wrapped around.
+     */
+    explicit FixedInteger(Integer const& val) : m_limbs() {
+      std::size_t const digitsPerLimb = sizeof(Limb) / sizeof(Integer::Digit);
+      std::size_t const digitBits = CHAR_BIT * sizeof(Integer::Digit);
+      for (std::size_t i = 0; i < val.m_digits.size() && i < LIMBS * digitsPerLimb; ++i) {
+        m_limbs[i / digitsPerLimb] |= (Limb) val.m_digits[i] << (digitBits * (i % digitsPerLimb));
+      }
+      if (val.m_isNegative) {
+        negateLimbs(m_limbs);
+      }
+      makeValid();
+    }
+
+    /// @brief Converts this FixedInteger to an Integer with the same value.
+    explicit operator Integer() const {
+      std::size_t const digitsPerLimb = sizeof(Limb) / sizeof(Integer::Digit);
+      std::size_t const digitBits = CHAR_BIT * sizeof(Integer::Digit);
+      Limbs magnitude = m_limbs;
+      if (isNegative()) {
+        negateLimbs(magnitude);
+      }
+      Integer result;
+      result.m_digits.resize(LIMBS * digitsPerLimb);
+      for (std::size_t i = 0; i < result.m_digits.size(); ++i) {
+        result.m_digits[i] = (Integer::Digit) (magnitude[i / digitsPerLimb] >> (digitBits * (i % digitsPerLimb)));
+      }
+      result.m_isNegative = isNegative();
+      result.makeValid();
+      return result;
+    }
+
+    /*@{*/
+    /**
+     * @brief Explicit narrowing conversion from FixedInteger to an integral type.
+     *
+     * Any bits beyond what can be stored are truncated, as with the built in types.
+     */
+    constexpr explicit operator bool() const {
+      for (std::size_t i = 0; i < LIMBS; ++i) {
+        if (m_limbs[i] != 0) {
+          return true;
+        }
+      }
+      return false;
+    }
+    constexpr explicit operator unsigned long long() const {
+      unsigned long long result = 0;
+      for (std::size_t i = 0; i < LIMBS && i * LIMB_BITS < CHAR_BIT * sizeof(unsigned long long); ++i) {
+        result |= (unsigned long long) m_limbs[i] << (i * LIMB_BITS);
+      }
+      if (isNegative()) {
+        for (std::size_t i = LIMBS; i * LIMB_BITS < CHAR_BIT * sizeof(unsigned long long); ++i) {
+          result |= (unsigned long long) ~(Limb) 0 << (i * LIMB_BITS);
+        }
+      }
+      return result;
+    }
+    constexpr explicit operator signed long long() const {
+      return (signed long long) operator unsigned long long();
+    }
+    /*@}*/
+
+    /// @brief Returns the limbs of this FixedInteger, least significant first.
+    constexpr Limbs const& limbs() const {
+      return m_limbs;
+    }
+
+    /// @brief Returns whether this FixedInteger is less than zero.
+    constexpr bool isNegative() const {
+      return Signed && (m_limbs[LIMBS - 1] >> (LIMB_BITS - 1)) != 0;
+    }
+
+    /// @brief Gives the negative of this FixedInteger.
+    constexpr FixedInteger operator-() const {
+      FixedInteger result(*this);
+      return result.negate();
+    }
+    /// @brief Negates this FixedInteger in place.
+    constexpr FixedInteger& negate() {
+      negateLimbs(m_limbs);
+      makeValid();
+      return *this;
+    }
+    /// @brief Returns this FixedInteger unchanged.
+    constexpr FixedInteger const& operator+() const {
+      return *this;
+    }
+
+    /// @brief Increments this FixedInteger and returns the new value.
+    constexpr FixedInteger& operator++() {
+      return operator+=(FixedInteger(1));
+    }
+    /// @brief Decrements this FixedInteger and returns the new value.
+    constexpr FixedInteger& operator--() {
+      return operator-=(FixedInteger(1));
+    }
+    /// @brief Increments this FixedInteger and returns the old value.
+    constexpr FixedInteger operator++(int) {
+      FixedInteger result(*this);
+      operator++();
+      return result;
+    }
+    /// @brief Decrements this FixedInteger and returns the old value.
+    constexpr FixedInteger operator--(int) {
+      FixedInteger result(*this);
+      operator--();
+      return result;
+    }
+
+    /// @brief Adds another FixedInteger to this one.
+    constexpr FixedInteger& operator+=(FixedInteger const& rhs) {
+      DoubleLimb carry = 0;
+      for (std::size_t i = 0; i < LIMBS; ++i) {
+        DoubleLimb sum = (DoubleLimb) m_limbs[i] + rhs.m_limbs[i] + carry;
+        m_limbs[i] = (Limb) sum;
+        carry = sum >> LIMB_BITS;
+      }
+      makeValid();
+      return *this;
+    }
+    /// @brief Subtracts another FixedInteger from this one.
+    constexpr FixedInteger& operator-=(FixedInteger const& rhs) {
+      DoubleLimb borrow = 0;
+      for (std::size_t i = 0; i < LIMBS; ++i) {
+        DoubleLimb difference = (DoubleLimb) m_limbs[i] - rhs.m_limbs[i] - borrow;
+        m_limbs[i] = (Limb) difference;
+        borrow = (difference >> LIMB_BITS) & 1;
+      }
+      makeValid();
+      return *this;
+    }
+    /// @brief Multiplies another FixedInteger to this one.
+    constexpr FixedInteger& operator*=(FixedInteger const& rhs) {
+      // The grade school algorithm, skipping any partial products that would
+      // land entirely beyond the top limb. Since the product is only kept modulo
+      // 2^Bits, the same algorithm works for two's complement values.
+      Limbs result = {};
+      for (std::size_t i = 0; i < LIMBS; ++i) {
+        DoubleLimb carry = 0;
+        for (std::size_t j = 0; i + j < LIMBS; ++j) {
+          DoubleLimb product = (DoubleLimb) m_limbs[i] * rhs.m_limbs[j] + result[i + j] + carry;
+          result[i + j] = (Limb) product;
+          carry = product >> LIMB_BITS;
+        }
+      }
+      m_limbs = result;
+      makeValid();
+      return *this;
+    }
+    /**
+     * @brief Divides this FixedInteger by another one.
+     *
+     * If the divisor is zero, then this FixedInteger is left unchanged.
+     */
+    constexpr FixedInteger& operator/=(FixedInteger const& rhs) {
+      FixedInteger quot;
+      FixedInteger rem;
+      if (quotRem(*this, rhs, quot, rem)) {
+        *this = quot;
+      }
+      return *this;
+    }
+    /**
+     * @brief Modulates this FixedInteger by another one.
+     *
+     * The result has the same sign as this FixedInteger. If the divisor is zero,
+     * then this FixedInteger is left unchanged.
+     */
+    constexpr FixedInteger& operator%=(FixedInteger const& rhs) {
+      FixedInteger quot;
+      FixedInteger rem;
+      if (quotRem(*this, rhs, quot, rem)) {
+        *this = rem;
+      }
+      return *this;
+    }
+
+    /// @brief Performs the bitwise not operation.
+    constexpr FixedInteger operator~() const {
+      FixedInteger result;
+      for (std::size_t i = 0; i < LIMBS; ++i) {
+        result.m_limbs[i] = ~m_limbs[i];
+      }
+      result.makeValid();
+      return result;
+    }
+    /// @brief Performs the bitwise and operation.
+    constexpr FixedInteger& operator&=(FixedInteger const& rhs) {
+      for (std::size_t i = 0; i < LIMBS; ++i) {
+        m_limbs[i] &= rhs.m_limbs[i];
+      }
+      return *this;
+    }
+    /// @brief Performs the bitwise or operation.
+    constexpr FixedInteger& operator|=(FixedInteger const& rhs) {
+      for (std::size_t i = 0; i < LIMBS; ++i) {
+        m_limbs[i] |= rhs.m_limbs[i];
+      }
+      return *this;
+    }
+    /// @brief Performs the bitwise xor operation.
+    constexpr FixedInteger& operator^=(FixedInteger const& rhs) {
+      for (std::size_t i = 0; i < LIMBS; ++i) {
+        m_limbs[i] ^= rhs.m_limbs[i];
+      }
+      return *this;
+    }
+
+    /// @brief Shifts all bits right a certain number of places, filling with the sign bit.
+    constexpr FixedInteger& operator>>=(unsigned long long n) {
+      Limb fill = isNegative() ? ~(Limb) 0 : 0;
+      std::size_t numLimbs = n / LIMB_BITS < LIMBS ? (std::size_t) (n / LIMB_BITS) : LIMBS;
+      std::size_t numBits = (std::size_t) (n % LIMB_BITS);
+      for (std::size_t i = 0; i < LIMBS; ++i) {
+        Limb low = i + numLimbs < LIMBS ? m_limbs[i + numLimbs] : fill;
+        Limb high = i + numLimbs + 1 < LIMBS ? m_limbs[i + numLimbs + 1] : fill;
+        m_limbs[i] = numBits == 0 ? low : (low >> numBits) | (high << (LIMB_BITS - numBits));
+      }
+      makeValid();
+      return *this;
+    }
+    /// @brief Shifts all bits left a certain number of places, discarding bits that go past the top.
+    constexpr FixedInteger& operator<<=(unsigned long long n) {
+      std::size_t numLimbs = n / LIMB_BITS < LIMBS ? (std::size_t) (n / LIMB_BITS) : LIMBS;
+      std::size_t numBits = (std::size_t) (n % LIMB_BITS);
+      for (std::size_t i = LIMBS; i != 0; --i) {
+        std::size_t index = i - 1;
+        Limb high = index >= numLimbs ? m_limbs[index - numLimbs] : 0;
+        Limb low = index >= numLimbs + 1 ? m_limbs[index - numLimbs - 1] : 0;
+        m_limbs[index] = numBits == 0 ? high : (high << numBits) | (low >> (LIMB_BITS - numBits));
+      }
+      makeValid();
+      return *this;
+    }
+
+    /// @brief Returns the sum of two FixedIntegers.
+    friend constexpr FixedInteger operator+(FixedInteger lhs, FixedInteger const& rhs) {
+      return lhs += rhs;
+    }
+    /// @brief Returns the difference of two FixedIntegers.
+    friend constexpr FixedInteger operator-(FixedInteger lhs, FixedInteger const& rhs) {
+      return lhs -= rhs;
+    }
+    /// @brief Returns the product of two FixedIntegers.
+    friend constexpr FixedInteger operator*(FixedInteger lhs, FixedInteger const& rhs) {
+      return lhs *= rhs;
+    }
+    /// @brief Returns the quotient of two FixedIntegers.
+    friend constexpr FixedInteger operator/(FixedInteger lhs, FixedInteger const& rhs) {
+      return lhs /= rhs;
+    }
+    /// @brief Returns the modulus of one FixedInteger by another one.
+    friend constexpr FixedInteger operator%(FixedInteger lhs, FixedInteger const& rhs) {
+      return lhs %= rhs;
+    }
+    /// @brief Returns the bitwise and of two FixedIntegers.
+    friend constexpr FixedInteger operator&(FixedInteger lhs, FixedInteger const& rhs) {
+      return lhs &= rhs;
+    }
+    /// @brief Returns the bitwise or of two FixedIntegers.
+    friend constexpr FixedInteger operator|(FixedInteger lhs, FixedInteger const& rhs) {
+      return lhs |= rhs;
+    }
+    /// @brief Returns the bitwise xor of two FixedIntegers.
+    friend constexpr FixedInteger operator^(FixedInteger lhs, FixedInteger const& rhs) {
+      return lhs ^= rhs;
+    }
+    /// @brief Returns the right shift of a FixedInteger by a certain number of places.
+    friend constexpr FixedInteger operator>>(FixedInteger lhs, unsigned long long rhs) {
+      return lhs >>= rhs;
+    }
+    /// @brief Returns the left shift of a FixedInteger by a certain number of places.
+    friend constexpr FixedInteger operator<<(FixedInteger lhs, unsigned long long rhs) {
+      return lhs <<= rhs;
+    }
+
+    /// @brief Checks if this FixedInteger equals another one.
+    friend constexpr bool operator==(FixedInteger const& lhs, FixedInteger const& rhs) {
+      for (std::size_t i = 0; i < LIMBS; ++i) {
+        if (lhs.m_limbs[i] != rhs.m_limbs[i]) {
+          return false;
+        }
+      }
+      return true;
+    }
+    /// @brief Checks if this FixedInteger is smaller than another one.
+    friend constexpr bool operator<(FixedInteger const& lhs, FixedInteger const& rhs) {
+      if (lhs.isNegative() != rhs.isNegative()) {
+        return lhs.isNegative();
+      }
+      // With the same sign, two's complement values compare like unsigned ones.
+      return compareLimbs(lhs.m_limbs, rhs.m_limbs) < 0;
+    }
+    /// @brief Checks if this FixedInteger does not equal another one.
+    friend constexpr bool operator!=(FixedInteger const& lhs, FixedInteger const& rhs) {
+      return !(lhs == rhs);
+    }
+    /// @brief Checks if this FixedInteger is greater than another one.
+    friend constexpr bool operator>(FixedInteger const& lhs, FixedInteger const& rhs) {
+      return rhs < lhs;
+    }
+    /// @brief Checks if this FixedInteger is smaller than or equal to another one.
+    friend constexpr bool operator<=(FixedInteger const& lhs, FixedInteger const& rhs) {
+      return !(rhs < lhs);
+    }
+    /// @brief Checks if this FixedInteger is greater than or equal to another one.
+    friend constexpr bool operator>=(FixedInteger const& lhs, FixedInteger const& rhs) {
+      return !(lhs < rhs);
+    }
+
+    /// @brief Outputs a FixedInteger to a standard stream.
+    friend std::ostream& operator<<(std::ostream& os, FixedInteger const& obj) {
+      return os << Integer(obj);
+    }
+
+    /**
+     * @brief Divides one FixedInteger by another, giving both the quotient and the remainder.
+     *
+     * The quotient is truncated towards zero, and the remainder has the same
+     * sign as the dividend. Returns false if the divisor is zero, in which case
+     * the outputs are left unchanged.
+     */
+    static constexpr bool quotRem(FixedInteger const& lhs, FixedInteger const& rhs,
+                                  FixedInteger& quot_out, FixedInteger& rem_out) {
+      if (!rhs) {
+        return false;
+      }
+      // The division is done on the magnitudes, and then the signs are fixed up.
+      Limbs lhsMagnitude = lhs.m_limbs;
+      Limbs rhsMagnitude = rhs.m_limbs;
+      if (lhs.isNegative()) {
+        negateLimbs(lhsMagnitude);
+      }
+      if (rhs.isNegative()) {
+        negateLimbs(rhsMagnitude);
+      }
+      Limbs quot = {};
+      Limbs rem = {};
+      quotRemLimbs(lhsMagnitude, rhsMagnitude, quot, rem);
+      if (lhs.isNegative() != rhs.isNegative()) {
+        negateLimbs(quot);
+      }
+      if (lhs.isNegative()) {
+        negateLimbs(rem);
+      }
+      quot_out = FixedInteger(quot);
+      rem_out = FixedInteger(rem);
+      return true;
+    }
+
+  private:
+
+    // Takes a FixedInteger in invalid form and makes it valid. Any bits of the
+    // top limb past the number of bits are copies of the sign bit if this is
+    // signed, and zero otherwise.
+    constexpr void makeValid() {
+      std::size_t const extraBits = LIMBS * LIMB_BITS - Bits;
+      if (extraBits != 0) {
+        Limb const mask = ~(Limb) 0 >> extraBits;
+        Limb const signBit = (Limb) 1 << (LIMB_BITS - extraBits - 1);
+        Limb& top = m_limbs[LIMBS - 1];
+        if (Signed && (top & signBit) != 0) {
+          top |= ~mask;
+        }
+        else {
+          top &= mask;
+        }
+      }
+    }
+
+    // Negates an array of limbs as a two's complement number.
+    static constexpr void negateLimbs(Limbs& limbs) {
+      bool hasCarry = true;
+      for (std::size_t i = 0; i < LIMBS; ++i) {
+        limbs[i] = ~limbs[i] + hasCarry;
+        hasCarry = hasCarry && limbs[i] == 0;
+      }
+    }
+
+    // Returns the sign of (lhs - rhs), treating both as unsigned numbers.
+    static constexpr int compareLimbs(Limbs const& lhs, Limbs const& rhs) {
+      for (std::size_t i = LIMBS; i != 0; --i) {
+        if (lhs[i - 1] != rhs[i - 1]) {
+          return lhs[i - 1] > rhs[i - 1] ? 1 : -1;
+        }
+      }
+      return 0;
+    }
+
+    // Divides two non-zero unsigned arrays of limbs, using Knuth's algorithm D.
+    static constexpr void quotRemLimbs(Limbs const& lhs, Limbs const& rhs, Limbs& quot, Limbs& rem) {
+      std::size_t m = LIMBS;
+      while (m != 0 && lhs[m - 1] == 0) {
+        --m;
+      }
+      std::size_t n = LIMBS;
+      while (rhs[n - 1] == 0) {
+        --n;
+      }
+      if (m < n) {
+        rem = lhs;
+        return;
+      }
+      if (n == 1) {
+        // Dividing by a single limb is just short division.
+        DoubleLimb remainder = 0;
+        for (std::size_t i = m; i != 0; --i) {
+          DoubleLimb dividend = (remainder << LIMB_BITS) | lhs[i - 1];
+          quot[i - 1] = (Limb) (dividend / rhs[0]);
+          remainder = dividend % rhs[0];
+        }
+        rem[0] = (Limb) remainder;
+        return;
+      }
+      // Normalize, so that the top bit of the divisor is set. This makes the
+      // estimates of each limb of the quotient off by at most two.
+      std::size_t shift = 0;
+      while ((rhs[n - 1] << shift) >> (LIMB_BITS - 1) == 0) {
+        ++shift;
+      }
+      std::array<Limb, LIMBS> v = {};
+      std::array<Limb, LIMBS + 1> u = {};
+      for (std::size_t i = n; i != 0; --i) {
+        v[i - 1] = (Limb) ((rhs[i - 1] << shift) |
+          (shift != 0 && i > 1 ? rhs[i - 2] >> (LIMB_BITS - shift) : 0));
+      }
+      u[m] = shift != 0 ? (Limb) (lhs[m - 1] >> (LIMB_BITS - shift)) : 0;
+      for (std::size_t i = m; i != 0; --i) {
+        u[i - 1] = (Limb) ((lhs[i - 1] << shift) |
+          (shift != 0 && i > 1 ? lhs[i - 2] >> (LIMB_BITS - shift) : 0));
+      }
+      DoubleLimb const base = (DoubleLimb) 1 << LIMB_BITS;
+      for (std::size_t j = m - n + 1; j != 0; --j) {
+        std::size_t k = j - 1;
+        // Estimate the next limb of the quotient from the top two limbs of the
+        // remainder and the top limb of the divisor, then refine it with the
+        // second limb of the divisor.
+        DoubleLimb numerator = ((DoubleLimb) u[k + n] << LIMB_BITS) | u[k + n - 1];
+        DoubleLimb qhat = numerator / v[n - 1];
+        DoubleLimb rhat = numerator % v[n - 1];
+        while (qhat >= base || qhat * v[n - 2] > ((rhat << LIMB_BITS) | u[k + n - 2])) {
+          --qhat;
+          rhat += v[n - 1];
+          if (rhat >= base) {
+            break;
+          }
+        }
+        // Multiply and subtract.
+        DoubleLimb borrow = 0;
+        DoubleLimb carry = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+          DoubleLimb product = qhat * v[i] + carry;
+          carry = product >> LIMB_BITS;
+          DoubleLimb difference = (DoubleLimb) u[i + k] - (Limb) product - borrow;
+          u[i + k] = (Limb) difference;
+          borrow = (difference >> LIMB_BITS) & 1;
+        }
+        DoubleLimb difference = (DoubleLimb) u[k + n] - carry - borrow;
+        u[k + n] = (Limb) difference;
+        if ((difference >> LIMB_BITS) != 0) {
+          // The estimate was one too large, so add the divisor back.
+          --qhat;
+          carry = 0;
+          for (std::size_t i = 0; i < n; ++i) {
+            DoubleLimb sum = (DoubleLimb) u[i + k] + v[i] + carry;
+            u[i + k] = (Limb) sum;
+            carry = sum >> LIMB_BITS;
+          }
+          u[k + n] = (Limb) (u[k + n] + carry);
+        }
+        quot[k] = (Limb) qhat;
+      }
+      // Undo the normalization to get the remainder.
+      for (std::size_t i = 0; i < n; ++i) {
+        rem[i] = (Limb) ((u[i] >> shift) |
+          (shift != 0 ? (DoubleLimb) u[i + 1] << (LIMB_BITS - shift) : 0));
+      }
+    }
+
+    // Implementation Details
+    // ----------------------
+    //   A FixedInteger is stored as an array of limbs in two's complement, with
+    // the least significant limb first. If the number of bits isn't a multiple
+    // of the limb size, then the unused bits at the top are always kept as
+    // copies of the sign bit (or zero for unsigned values), so that the limbs
+    // can be compared and converted without looking at the number of bits.
+
+    Limbs m_limbs;
+
+  };
+
+  /*@{*/
+  /// @brief Common sizes of FixedInteger.
+  using Int128 = FixedInteger<128, true>;
+  using UInt128 = FixedInteger<128, false>;
+  using Int256 = FixedInteger<256, true>;
+  using UInt256 = FixedInteger<256, false>;
+  using Int512 = FixedInteger<512, true>;
+  using UInt512 = FixedInteger<512, false>;
+  /*@}*/
+
+  /**
+   * @class IntegerLiteral
+   * @brief Reads the digits of an integer literal at compile time, for the _Z literal.
+   *
+   * The literal may be decimal, hexadecimal (0x), binary (0b) or octal (a
+   * leading 0), and may contain digit separators. The digits are first read
+   * into enough limbs for any literal of that length, and the value is then
+   * moved into the smallest signed FixedInteger, in whole limbs, that holds it.
+   *
+   * @tparam Chars The characters of the literal
+   * @author Duane Byer
+   */
+  template <char... Chars>
+  class IntegerLiteral {
+
+  public:
+
+    using Limb = std::uint32_t;
+    using DoubleLimb = std::uint64_t;
+
+    static constexpr std::size_t LIMB_BITS = CHAR_BIT * sizeof(Limb);
+
+  private:
+
+    static constexpr char CHARS[] = { Chars... };
+    static constexpr std::size_t LENGTH = sizeof...(Chars);
+
+    static constexpr bool hasPrefix(char lower, char upper) {
+      return LENGTH > 2 && CHARS[0] == '0' && (CHARS[1] == lower || CHARS[1] == upper);
+    }
+
+    static constexpr int base() {
+      return hasPrefix('x', 'X') ? 16 : hasPrefix('b', 'B') ? 2 : (LENGTH > 1 && CHARS[0] == '0') ? 8 : 10;
+    }
+
+    static constexpr std::size_t prefixLength() {
+      return base() == 16 || base() == 2 ? 2 : 0;
+    }
+
+    // Returns the value of a digit, or -1 if the character isn't a digit.
+    static constexpr int digitValue(char c) {
+      return c >= '0' && c <= '9' ? c - '0' :
+             c >= 'a' && c <= 'z' ? c - 'a' + 10 :
+             c >= 'A' && c <= 'Z' ? c - 'A' + 10 : -1;
+    }
+
+    // Every digit takes at most this many bits, which is rounded up for decimal.
+    static constexpr std::size_t BITS_PER_DIGIT = base() == 2 ? 1 : base() == 8 ? 3 : 4;
+    static constexpr std::size_t WIDE_LIMBS = (LENGTH * BITS_PER_DIGIT + LIMB_BITS - 1) / LIMB_BITS + 1;
+
+    using WideLimbs = std::array<Limb, WIDE_LIMBS>;
+
+    // Reads the digits with a multiply and add on the limbs for each digit.
+    static constexpr WideLimbs readDigits() {
+      WideLimbs result = {};
+      for (std::size_t i = prefixLength(); i < LENGTH; ++i) {
+        if (CHARS[i] == '\'') {
+          continue;
+        }
+        DoubleLimb carry = (DoubleLimb) digitValue(CHARS[i]);
+        for (std::size_t j = 0; j < WIDE_LIMBS; ++j) {
+          DoubleLimb product = (DoubleLimb) result[j] * (DoubleLimb) base() + carry;
+          result[j] = (Limb) product;
+          carry = product >> LIMB_BITS;
+        }
+      }
+      return result;
+    }
+
+    static constexpr WideLimbs WIDE = readDigits();
+
+    static constexpr std::size_t bitLength() {
+      for (std::size_t i = WIDE_LIMBS; i != 0; --i) {
+        if (WIDE[i - 1] != 0) {
+          std::size_t bits = (i - 1) * LIMB_BITS;
+          for (Limb top = WIDE[i - 1]; top != 0; top >>= 1) {
+            ++bits;
+          }
+          return bits;
+        }
+      }
+      return 0;
+    }
+
+  public:
+
+    /// @brief Returns whether every character is a digit of the base, or a separator.
+    static constexpr bool isValid() {
+      bool hasDigits = false;
+      for (std::size_t i = prefixLength(); i < LENGTH; ++i) {
+        if (CHARS[i] == '\'') {
+          continue;
+        }
+        int digit = digitValue(CHARS[i]);
+        if (digit < 0 || digit >= base()) {
+          return false;
+        }
+        hasDigits = true;
+      }
+      return hasDigits;
+    }
+
+    /// @brief The number of bits in the result, including a sign bit so that it can be negated.
+    static constexpr std::size_t BITS = (bitLength() / LIMB_BITS + 1) * LIMB_BITS;
+
+    /// @brief Returns the value of the literal.
+    static constexpr FixedInteger<BITS> value() {
+      typename FixedInteger<BITS>::Limbs limbs = {};
+      for (std::size_t i = 0; i < limbs.size(); ++i) {
+        limbs[i] = WIDE[i];
+      }
+      return FixedInteger<BITS>(limbs);
+    }
+
+  };
+
+  namespace literals {
+
+    /**
+     * @brief Makes a FixedInteger from an integer literal of any length, at compile time.
+     *
+     * For example, 0xffffffffffffffffffffffffffffffff_Z is a FixedInteger<160>.
+     * The result is the smallest signed FixedInteger, in whole limbs, that can
+     * hold the literal, so a negated literal always fits as well. Since the
+     * whole thing is a constant expression, a static constexpr FixedInteger
+     * needs no code to run at startup, and can't be used before it has been
+     * initialized. Convert the result to an Integer where one is needed.
+     */
+    template <char... Chars>
+    constexpr FixedInteger<IntegerLiteral<Chars...>::BITS> operator""_Z() {
+      static_assert(IntegerLiteral<Chars...>::isValid(), "Invalid digit in an integer literal");
+      return IntegerLiteral<Chars...>::value();
+    }
+
+  }
+
+}
+
+#endif
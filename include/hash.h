@@ -0,0 +1,126 @@
+#ifndef __APRN_HASH_H_
+#define __APRN_HASH_H_
+
+#include <cstddef>
+#include <functional>
+#include <utility>
+
+#include "integer.h"
+#include "integer_view.h"
+#include "rational.h"
+
+namespace aprn {
+
+  /**
+   * @brief Hashes the value of an integer.
+   *
+   * The limbs of the magnitude are hashed directly, in four independent lanes
+   * so that several limbs are mixed at once, and the sign and length are mixed
+   * in at the end. An Integer and a view of the same value always have the
+   * same hash, so either can be used to look up the other.
+   */
+  std::size_t hashValue(IntegerView val);
+
+  /**
+   * @class Hashed
+   * @brief An immutable value stored along with its hash, so that the hash is only computed once.
+   *
+   * This is meant for large keys of hash containers, which would otherwise be
+   * hashed again every time that the container rehashes or the key is looked
+   * up. Two Hashed values are compared by their hashes before their values,
+   * so unequal keys are almost always told apart without looking at their
+   * digits.
+   *
+   * @tparam T The type of the value, which must have a specialization of std::hash
+   * @author Duane Byer
+   */
+  template <typename T>
+  class Hashed {
+
+  public:
+
+    /// @brief Stores a value and computes its hash.
+    explicit Hashed(T value) : m_value(std::move(value)), m_hash(std::hash<T>()(m_value)) {}
+
+    /// @brief Returns the value.
+    T const& value() const {
+      return m_value;
+    }
+    /// @brief Returns the hash of the value.
+    std::size_t hash() const {
+      return m_hash;
+    }
+    /// @brief Converts to the value.
+    operator T const&() const {
+      return m_value;
+    }
+
+  private:
+
+    T m_value;
+    std::size_t m_hash;
+
+  };
+
+  /// @brief Checks if two Hashed values are equal, comparing their hashes first.
+  template <typename T>
+  bool operator==(Hashed<T> const& lhs, Hashed<T> const& rhs) {
+    return lhs.hash() == rhs.hash() && lhs.value() == rhs.value();
+  }
+  /// @brief Checks if two Hashed values are not equal, comparing their hashes first.
+  template <typename T>
+  bool operator!=(Hashed<T> const& lhs, Hashed<T> const& rhs) {
+    return !(lhs == rhs);
+  }
+
+  /**
+   * @brief A hash for containers with integer keys that can be looked up without making an Integer.
+   *
+   * Integers, views and Hashed Integers all hash to the same value, and the
+   * cached hash of a Hashed Integer is used instead of being recomputed. Along
+   * with IntegerEqual, this allows heterogeneous lookup in containers that
+   * support it (such as the unordered containers from C++20), so that a key in
+   * a memory mapped buffer can be looked up through a view.
+   */
+  struct IntegerHash {
+    using is_transparent = void;
+    std::size_t operator()(IntegerView val) const {
+      return hashValue(val);
+    }
+    std::size_t operator()(Hashed<Integer> const& val) const {
+      return val.hash();
+    }
+  };
+
+  /// @brief The equality to use along with IntegerHash.
+  struct IntegerEqual {
+    using is_transparent = void;
+    bool operator()(IntegerView lhs, IntegerView rhs) const {
+      return lhs == rhs;
+    }
+    bool operator()(Hashed<Integer> const& lhs, Hashed<Integer> const& rhs) const {
+      return lhs == rhs;
+    }
+    bool operator()(Hashed<Integer> const& lhs, IntegerView rhs) const {
+      return IntegerView(lhs.value()) == rhs;
+    }
+    bool operator()(IntegerView lhs, Hashed<Integer> const& rhs) const {
+      return lhs == IntegerView(rhs.value());
+    }
+  };
+
+}
+
+namespace std {
+
+  /// @brief Returns the hash stored in a Hashed value.
+  template <typename T>
+  struct hash<aprn::Hashed<T>> {
+    std::size_t operator()(aprn::Hashed<T> const& val) const {
+      return val.hash();
+    }
+  };
+
+}
+
+#endif
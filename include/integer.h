@@ -1,14 +1,19 @@
 #ifndef __APRN_INTEGER_H_
 #define __APRN_INTEGER_H_
 
+#include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <istream>
 #include <ostream>
 #include <vector>
 
+#include "storage.h"
+
 namespace aprn {
   
   struct div_result;
+  enum class ByteOrder;
   
   /**
    * @class Integer
@@ -45,6 +50,12 @@ namespace aprn {
     friend int signum(Integer const& val);
     friend Integer abs(Integer const& val);
     friend bool even(Integer const& val);
+    friend ShiftType bitLength(Integer const& val);
+    friend ShiftType popcount(Integer const& val);
+    friend ShiftType countTrailingZeros(Integer const& val);
+    friend bool testBit(Integer const& val, ShiftType index);
+    friend void setBit(Integer& val, ShiftType index, bool bit);
+    friend Integer extractBits(Integer const& val, ShiftType low, ShiftType high);
     
     friend div_result div(Integer const& lhs, Integer const& rhs);
     friend div_result div2(Integer const& lhs, ShiftType power);
@@ -52,6 +63,14 @@ namespace aprn {
     
     friend Integer gcd(Integer a, Integer b);
     
+    friend Integer importBytes(void const* buffer, std::size_t size,
+                               ByteOrder order, bool isNegative);
+    friend Integer importBytes(StorageVector<Digit>&& bytes, bool isNegative);
+    
+    friend class IntegerArray;
+    friend class IntegerView;
+    template <std::size_t Bits, bool Signed> friend class FixedInteger;
+    
   public:
     
     /// @brief Constructs an Integer with a value of zero.
@@ -144,13 +163,19 @@ namespace aprn {
     /// @brief Modulates this Integer by another one.
     Integer& operator%=(Integer const& rhs);
     
-    /// @brief Performs the bitwise not operation (including the sign bit).
+    /**
+     * @brief Performs the bitwise not operation.
+     * 
+     * The bitwise operators act as though the Integer were stored in two's
+     * complement with infinitely many sign bits, as the built in types are. So
+     * ~x is always equal to -x - 1.
+     */
     Integer operator~() const;
-    /// @brief Performs the bitwise and operation (including the sign bit).
+    /// @brief Performs the bitwise and operation, in two's complement.
     Integer& operator&=(Integer const& rhs);
-    /// @brief Performs the bitwise or operation (including the sign bit).
+    /// @brief Performs the bitwise or operation, in two's complement.
     Integer& operator|=(Integer const& rhs);
-    /// @brief Performs the bitwise xor operation (including the sign bit).
+    /// @brief Performs the bitwise xor operation, in two's complement.
     Integer& operator^=(Integer const& rhs);
     
     /// @brief Shifts all bits right a certain number of places.
@@ -169,8 +194,14 @@ namespace aprn {
     Integer& subtractMagnitude(Integer const& rhs);
     
     Integer& setToProduct(Integer const& lhs, Integer const& rhs);
+    Integer& applyBitwise(Integer const& rhs, Digit (*op)(Digit, Digit));
     static bool quotRem(Integer const& lhs, Integer const& rhs,
                         Integer& quot_out, Integer& rem_out);
+    static void divideGradeSchool(Integer const& lhs, Integer const& rhs,
+                                  Integer& quot_out, Integer& rem_out);
+    static void divideRecursive(Integer const& lhs, Integer const& rhs,
+                                ShiftType rhsSize, ShiftType quotSize,
+                                Integer& quot_out, Integer& rem_out);
     Integer& shiftRight(ShiftType rhs, Integer& rem_out);
     Integer& shiftLeft(ShiftType rhs);
     
@@ -182,13 +213,14 @@ namespace aprn {
     // positive or negative. A non-zero integer is in valid form if it has no
     // leading digits with the value of zero. The unique representation of zero
     // is an empty digit vector with a positive sign.
-    //   The type used for the digit can be any unsigned integer type.
+    //   The type used for the digit can be any unsigned integer type. The digits
+    // of very large Integers may be kept in mapped storage (see storage.h).
     
     // This constant stores the maximum value a digit can have. This is
     // equal to the base minus 1.
     Digit static const MAX_DIGIT;
     // The string of digits that represents the integer.
-    std::vector<Digit> m_digits;
+    StorageVector<Digit> m_digits;
     // The sign of the integer.
     bool m_isNegative;
     // The size type of the vector.
@@ -245,6 +277,11 @@ namespace aprn {
     lhs |= rhs;
     return lhs;
   }
+  /// @brief Returns the bitwise xor of two Integers.
+  inline Integer operator^(Integer lhs, Integer const& rhs) {
+    lhs ^= rhs;
+    return lhs;
+  }
   /// @brief Returns the left shift of an Integer by a certain number of places.
   inline Integer operator>>(Integer lhs, Integer::ShiftType rhs) {
     lhs >>= rhs;
@@ -261,6 +298,24 @@ namespace aprn {
   /// @brief Reads in an Integer from a standard stream.
   std::istream& operator>>(std::istream& is, Integer& obj);
   
+  /**
+   * @brief Hashes the value of an Integer, without converting it to a string.
+   * @see hash.h
+   */
+  std::size_t hashValue(Integer const& val);
+  
+}
+
+namespace std {
+  
+  /// @brief Hashes Integers, so that they can be used as keys of unordered containers.
+  template <>
+  struct hash<aprn::Integer> {
+    std::size_t operator()(aprn::Integer const& val) const {
+      return aprn::hashValue(val);
+    }
+  };
+  
 }
 
 #endif
@@ -0,0 +1,128 @@
+#ifndef __APRN_INTEGER_ARRAY_H_
+#define __APRN_INTEGER_ARRAY_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "integer.h"
+
+namespace aprn {
+
+  /**
+   * @class IntegerArray
+   * @brief A contiguous array of fixed width unsigned integers.
+   *
+   * Every element of an IntegerArray has the same width in bits, and behaves
+   * like a built in unsigned integer of that width: the results of operations
+   * wrap around modulo two to the power of the width. All of the elements are
+   * stored in one block of memory, so that an operation can be applied to the
+   * whole array at once without going through a separate allocation for each
+   * element, and so that the compiler can vectorize the operation across
+   * elements.
+   *
+   * Elements can be converted to and from Integers. Negative Integers are
+   * stored as their two's complement, as with built in unsigned types.
+   *
+   * @author Duane Byer
+   */
+  class IntegerArray {
+
+  public:
+
+    /// @brief The type used for the limbs that the elements are stored in.
+    using Limb = std::uint32_t;
+
+    /// @brief Constructs an IntegerArray of zeros.
+    IntegerArray(std::size_t size, unsigned long long bits);
+    /// @brief Constructs an IntegerArray from a list of Integers.
+    IntegerArray(std::vector<Integer> const& values, unsigned long long bits);
+
+    /// @brief Returns the number of elements in the array.
+    std::size_t size() const {
+      return m_size;
+    }
+    /// @brief Returns the width of each element, in bits.
+    unsigned long long bits() const {
+      return m_bits;
+    }
+    /// @brief Returns the number of limbs used for each element.
+    std::size_t limbs() const {
+      return m_limbCount;
+    }
+    /**
+     * @brief Returns the distance between consecutive limbs of one element.
+     *
+     * Limb j of element i is stored at data()[j * stride() + i].
+     */
+    std::size_t stride() const {
+      return m_size;
+    }
+    /*@{*/
+    /// @brief Gives direct access to the limbs of all of the elements.
+    Limb* data() {
+      return m_limbs.data();
+    }
+    Limb const* data() const {
+      return m_limbs.data();
+    }
+    /*@}*/
+
+    /// @brief Gets the value of an element as an Integer.
+    Integer get(std::size_t index) const;
+    /// @brief Sets the value of an element, wrapping it to the width of the array.
+    void set(std::size_t index, Integer const& val);
+    /// @brief Gets the values of all of the elements as Integers.
+    std::vector<Integer> toIntegers() const;
+
+    /*@{*/
+    /**
+     * @brief Applies an operation to each element and the corresponding element of another array.
+     *
+     * The results wrap around to the width of the array. Returns false, and
+     * does nothing, if the arrays have different sizes or widths.
+     */
+    bool add(IntegerArray const& rhs);
+    bool sub(IntegerArray const& rhs);
+    /*@}*/
+
+    /// @brief Multiplies each element by the same factor, wrapping around to the width of the array.
+    void mulScalar(Limb factor);
+
+    /**
+     * @brief Compares each element to the corresponding element of another array.
+     *
+     * The result for each element is -1, 0, or +1, depending on whether the
+     * element is smaller than, equal to, or larger than the other element. An
+     * empty list is returned if the arrays have different sizes or widths.
+     */
+    std::vector<int> compare(IntegerArray const& rhs) const;
+
+    /// @brief Returns the exact sum of all of the elements, without wrapping around.
+    Integer sum() const;
+
+  private:
+
+    // Internal functions. See source file for documentation.
+
+    bool matches(IntegerArray const& rhs) const;
+    void wrap();
+
+    // Implementation Details
+    // ----------------------
+    //   The limbs are stored limb-major: first the lowest limb of every element,
+    // then the next lowest limb of every element, and so on. This means that
+    // an operation working up through the limbs does the same thing to a run of
+    // consecutive elements at each step, with the carries of the elements kept
+    // side by side, which is the shape the compiler needs to vectorize it.
+    //   Any bits of the top limb beyond the width of the array are always zero.
+
+    std::vector<Limb> m_limbs;
+    std::size_t m_size;
+    std::size_t m_limbCount;
+    unsigned long long m_bits;
+
+  };
+
+}
+
+#endif
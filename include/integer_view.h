@@ -0,0 +1,150 @@
+#ifndef __APRN_INTEGER_VIEW_H_
+#define __APRN_INTEGER_VIEW_H_
+
+#include <cstddef>
+#include <cstdint>
+#include "integer.h"
+#include "storage.h"
+
+namespace aprn {
+
+  /**
+   * @class IntegerView
+   * @brief A read-only view of an integer stored in a buffer that the view doesn't own.
+   *
+   * The magnitude is stored as 64 bit limbs, least significant first, with
+   * the bytes of each limb in little endian order. This is the layout of the
+   * limbs in the binary format (see serialization.h), and also the layout of
+   * an array of std::uint64_t on a little endian machine. The buffer needn't
+   * be aligned, and may come from anywhere, such as a memory mapped file, so
+   * large integers can be compared and combined without first copying them
+   * into an Integer. An Integer also converts to a view of its own digits.
+   *
+   * Like a std::string_view, a view is only valid for as long as the buffer
+   * it refers to, and must not be used after the buffer changes.
+   *
+   * @author Duane Byer
+   */
+  class IntegerView {
+
+    friend Integer operator+(IntegerView lhs, IntegerView rhs);
+    friend Integer operator-(IntegerView lhs, IntegerView rhs);
+    friend Integer operator*(IntegerView lhs, IntegerView rhs);
+
+  public:
+
+    /// @brief The type of the limbs that the magnitude is made of.
+    using Limb = std::uint64_t;
+
+    /// @brief Constructs a view of zero.
+    IntegerView();
+    /// @brief Constructs a view of the current value of an Integer.
+    IntegerView(Integer const& val);
+    /**
+     * @brief Constructs a view of a magnitude and sign stored in a buffer.
+     *
+     * Leading zero limbs are allowed, and ignored. A zero magnitude is never
+     * negative, whatever sign is given.
+     * @param limbs The little endian limbs of the magnitude, least significant first
+     * @param limbCount The number of limbs in the buffer
+     * @param isNegative Whether the integer is negative
+     */
+    IntegerView(void const* limbs, std::size_t limbCount, bool isNegative = false);
+
+    /// @brief Returns whether the integer is negative.
+    bool isNegative() const {
+      return m_isNegative;
+    }
+    /// @brief Returns the number of bytes in the magnitude, ignoring leading zeros.
+    std::size_t byteCount() const {
+      return m_size;
+    }
+    /// @brief Returns the magnitude as little endian bytes, least significant first.
+    std::uint8_t const* bytes() const {
+      return m_bytes;
+    }
+    /// @brief Returns the number of limbs needed to store the magnitude.
+    std::size_t limbCount() const {
+      return (m_size + sizeof(Limb) - 1) / sizeof(Limb);
+    }
+    /// @brief Returns a limb of the magnitude, which is zero past the last limb.
+    Limb limb(std::size_t index) const;
+
+    /// @brief Returns whether the integer isn't zero.
+    explicit operator bool() const {
+      return m_size != 0;
+    }
+
+    /// @brief Copies the integer into an Integer.
+    Integer toInteger() const;
+
+  private:
+
+    // Builds an Integer from its digits, which may have leading zeros.
+    static Integer makeInteger(StorageVector<std::uint8_t>&& digits, bool isNegative);
+
+    // The bytes of the magnitude, without leading zeros.
+    std::uint8_t const* m_bytes;
+    std::size_t m_size;
+    // The sign of the integer.
+    bool m_isNegative;
+
+  };
+
+  /**
+   * @brief Compares two views.
+   *
+   * Returns a negative number if the left hand side is smaller, a positive
+   * number if it is larger, and zero if they are equal.
+   */
+  int compare(IntegerView lhs, IntegerView rhs);
+
+  /// @brief Checks if two views are equal.
+  inline bool operator==(IntegerView lhs, IntegerView rhs) {
+    return compare(lhs, rhs) == 0;
+  }
+  /// @brief Checks if two views are not equal.
+  inline bool operator!=(IntegerView lhs, IntegerView rhs) {
+    return compare(lhs, rhs) != 0;
+  }
+  /// @brief Checks if one view is smaller than another.
+  inline bool operator<(IntegerView lhs, IntegerView rhs) {
+    return compare(lhs, rhs) < 0;
+  }
+  /// @brief Checks if one view is greater than another.
+  inline bool operator>(IntegerView lhs, IntegerView rhs) {
+    return compare(lhs, rhs) > 0;
+  }
+  /// @brief Checks if one view is smaller than or equal to another.
+  inline bool operator<=(IntegerView lhs, IntegerView rhs) {
+    return compare(lhs, rhs) <= 0;
+  }
+  /// @brief Checks if one view is greater than or equal to another.
+  inline bool operator>=(IntegerView lhs, IntegerView rhs) {
+    return compare(lhs, rhs) >= 0;
+  }
+
+  /// @brief Returns the sum of two views.
+  Integer operator+(IntegerView lhs, IntegerView rhs);
+  /// @brief Returns the difference of two views.
+  Integer operator-(IntegerView lhs, IntegerView rhs);
+  /**
+   * @brief Returns the product of two views.
+   *
+   * If the limbs of both views are aligned and in the native byte order, they
+   * are multiplied where they are, without being copied first.
+   */
+  Integer operator*(IntegerView lhs, IntegerView rhs);
+
+  /// @brief Gets the sign of a view, as with the Integer version.
+  int signum(IntegerView val);
+  /// @brief Returns the number of bits needed to store the magnitude of a view.
+  unsigned long long bitLength(IntegerView val);
+  /// @brief Returns the number of one bits in the magnitude of a view.
+  unsigned long long popcount(IntegerView val);
+  /// @brief Returns a bit of a view, treating negative integers as two's complement.
+  bool testBit(IntegerView val, unsigned long long index);
+
+}
+
+#endif
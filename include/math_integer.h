@@ -1,6 +1,9 @@
 #ifndef __APRN_MATH_INTEGER_H_
 #define __APRN_MATH_INTEGER_H_
 
+#include <ostream>
+#include <string>
+
 #include "integer.h"
 
 namespace aprn {
@@ -33,9 +36,54 @@ namespace aprn {
   Integer abs(Integer const& val);
   /// @brief Returns whether the Integer is even.
   bool even(Integer const& val);
+  /**
+   * @brief Returns the number of bits needed to store the magnitude of an Integer.
+   * 
+   * The sign is not counted, and zero has a bit length of zero.
+   */
+  Integer::ShiftType bitLength(Integer const& val);
+  /**
+   * @brief Returns the number of one bits in the magnitude of an Integer.
+   * 
+   * A negative Integer has infinitely many one bits in two's complement, so the
+   * magnitude is counted instead, which makes popcount(-x) equal popcount(x).
+   */
+  Integer::ShiftType popcount(Integer const& val);
+  /**
+   * @brief Returns the number of zero bits below the lowest one bit of an Integer.
+   * 
+   * This is the same for an Integer and its negation. Zero has no one bits, and
+   * is defined to have no trailing zeros.
+   */
+  Integer::ShiftType countTrailingZeros(Integer const& val);
+  /// @brief Returns a bit of an Integer, treating negative Integers as two's complement.
+  bool testBit(Integer const& val, Integer::ShiftType index);
+  /// @brief Sets or clears a bit of an Integer, treating negative Integers as two's complement.
+  void setBit(Integer& val, Integer::ShiftType index, bool bit = true);
+  /**
+   * @brief Returns the bits of an Integer from the low bit up to, but not including, the high bit.
+   * 
+   * Negative Integers are treated as two's complement. The result is never
+   * negative, and is zero if the high bit is not above the low bit.
+   */
+  Integer extractBits(Integer const& val, Integer::ShiftType low, Integer::ShiftType high);
   
   /// @brief Divides one Integer by another, and returns a div_result containing the answer.
   div_result div(Integer const& lhs, Integer const& rhs);
+  /**
+   * @brief Divides one Integer by another, using up to a certain number of threads.
+   * 
+   * This overrides the thread limit of the calling thread for this one division.
+   * The threads are only used when the operands are very large.
+   */
+  div_result div(Integer const& lhs, Integer const& rhs, unsigned threads);
+  /**
+   * @brief Multiplies two Integers, using up to a certain number of threads.
+   * 
+   * This overrides the thread limit of the calling thread for this one product.
+   * The threads are only used when the operands are very large.
+   */
+  Integer mul(Integer const& lhs, Integer const& rhs, unsigned threads);
   /**
    * @brief Divides one Integer by a positive power of two.
    * This should be used in preference to division whenever possible.
@@ -59,6 +107,86 @@ namespace aprn {
    */
   Integer gcd(Integer a, Integer b);
   
+  /**
+   * @brief Finds the inverse of an Integer modulo a positive modulus.
+   * 
+   * The inverse is the Integer x in the range [0, modulus) for which a * x - 1 is
+   * divisible by the modulus. Returns false if a and the modulus have a common
+   * factor, in which case there is no inverse.
+   * @param a The Integer to invert
+   * @param modulus The modulus, which must be positive
+   * @param result_out Where the inverse is stored
+   */
+  bool invmod(Integer const& a, Integer const& modulus, Integer& result_out);
+  
+  /// @brief Raises an Integer to a non-negative power.
+  Integer pow(Integer base, unsigned long long exponent);
+  
+  /**
+   * @brief Converts an Integer to a string of digits in some base from 2 to 36.
+   * 
+   * Digits past 9 are lower case letters, and negative Integers start with a
+   * minus sign. Large Integers are split in two by dividing by a power of the
+   * base, and each part is converted separately, which is much faster than
+   * taking off one digit at a time. An empty string is returned if the base is
+   * out of range.
+   */
+  std::string toString(Integer const& val, int base = 10);
+  /**
+   * @brief Writes the digits of an Integer to a stream, in some base from 2 to 36.
+   * 
+   * The digits are the same as those from toString, but they are passed on to
+   * the stream a block at a time as they are found, rather than being collected
+   * into one string first. This is meant for Integers that are too large for
+   * their digits to fit in memory, for example when they are kept in mapped
+   * storage. Returns false if the base is out of range.
+   */
+  bool writeString(std::ostream& os, Integer const& val, int base = 10);
+  /**
+   * @brief Reads an Integer from a string of digits in some base from 2 to 36.
+   * 
+   * This is the inverse of toString. The digits may be upper or lower case, and
+   * may be preceded by a plus or minus sign. Groups of digits that fit in a word
+   * are read first, and then neighbouring groups are joined in pairs, so that
+   * large Integers are read as quickly as they are written. Returns false if the
+   * base is out of range, or the string is not a valid Integer.
+   * @param str The string to read
+   * @param base The base of the digits
+   * @param result_out Where the Integer is stored
+   */
+  bool fromString(std::string const& str, int base, Integer& result_out);
+  
+  /**
+   * @brief Computes the factorial n! = 1 * 2 * ... * n.
+   * 
+   * The factorial is built up from its prime factorization, and the prime powers
+   * are multiplied together in a balanced tree so that the operands of each
+   * multiplication are about the same size. If more than one thread is
+   * requested, then independent branches of the tree are multiplied concurrently.
+   * @param n The number to take the factorial of
+   * @param threads The maximum number of threads to use
+   */
+  Integer factorial(unsigned long long n, unsigned threads = 1);
+  /**
+   * @brief Computes the double factorial n!! = n * (n - 2) * (n - 4) * ...
+   * 
+   * The product stops at either 1 or 2, and 0!! is equal to 1.
+   * @see factorial
+   */
+  Integer doubleFactorial(unsigned long long n, unsigned threads = 1);
+  /**
+   * @brief Computes the binomial coefficient C(n, k), the number of ways to choose k of n items.
+   * 
+   * If k is larger than n, then the result is zero.
+   * @see factorial
+   */
+  Integer binomial(unsigned long long n, unsigned long long k, unsigned threads = 1);
+  /**
+   * @brief Computes the primorial n#, the product of all primes less than or equal to n.
+   * @see factorial
+   */
+  Integer primorial(unsigned long long n, unsigned threads = 1);
+  
 }
 
 #endif
@@ -0,0 +1,41 @@
+#ifndef __APRN_MATH_RATIONAL_H_
+#define __APRN_MATH_RATIONAL_H_
+
+#include <vector>
+
+#include "integer.h"
+#include "rational.h"
+
+namespace aprn {
+  
+  /**
+   * @brief Returns the terms of the continued fraction of a Rational.
+   * 
+   * The first term is the floor of the Rational, and every later term is
+   * positive, so that val = a0 + 1 / (a1 + 1 / (a2 + ...)). The last term is
+   * never one, unless it is also the first, which makes the expansion unique.
+   * The Euclidean algorithm that finds the terms works on the leading words of
+   * the numerator and denominator while it can, so the full size numbers are
+   * only updated once for each batch of terms.
+   */
+  std::vector<Integer> continuedFraction(Rational const& val);
+  
+  /**
+   * @brief Finds the closest Rational to a value whose denominator is at most a limit.
+   * 
+   * The continued fraction of the value is only expanded until its convergents
+   * pass the limit, and the answer is then either the last convergent or a
+   * semiconvergent after it. The numbers that are built up along the way are
+   * never much larger than the limit, however large the value's own numerator
+   * and denominator are. If two Rationals are equally close, then the one with
+   * the smaller denominator is chosen. Returns false if the limit is less than
+   * one, in which case there is no such Rational.
+   * @param val The value to approximate, such as Rational(0.1)
+   * @param maxDenominator The largest denominator allowed
+   * @param result_out Where the approximation is stored
+   */
+  bool bestApproximation(Rational const& val, Integer const& maxDenominator, Rational& result_out);
+  
+}
+
+#endif
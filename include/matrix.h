@@ -0,0 +1,367 @@
+#ifndef __APRN_MATRIX_H_
+#define __APRN_MATRIX_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "integer.h"
+#include "rational.h"
+
+namespace aprn {
+
+  /**
+   * @class Matrix
+   * @brief A dense matrix with entries of some number type.
+   *
+   * The entries are stored in one block, row by row. Matrices over Integer
+   * and Rational are the ones the exact algorithms below are meant for, but
+   * any type with the usual arithmetic operators, whose default value is zero,
+   * and which can be constructed from an Integer, can be used.
+   *
+   * @tparam T The type of the entries, such as Integer or Rational
+   * @author Duane Byer
+   */
+  template <typename T>
+  class Matrix {
+
+  public:
+
+    /// @brief Constructs a matrix with no rows or columns.
+    Matrix() : m_rows(0), m_cols(0) {}
+    /// @brief Constructs a matrix of zeros.
+    Matrix(std::size_t rows, std::size_t cols) : m_rows(rows), m_cols(cols), m_entries(rows * cols) {}
+    /**
+     * @brief Constructs a matrix from its entries, row by row.
+     *
+     * If there are too few entries, then the rest are zero, and if there are
+     * too many, then the extra ones are ignored.
+     */
+    Matrix(std::size_t rows, std::size_t cols, std::vector<T> entries) :
+        m_rows(rows), m_cols(cols), m_entries(std::move(entries)) {
+      m_entries.resize(rows * cols);
+    }
+
+    /// @brief Returns the identity matrix of a certain size.
+    static Matrix identity(std::size_t size) {
+      Matrix result(size, size);
+      for (std::size_t i = 0; i < size; ++i) {
+        result(i, i) = T(Integer(1));
+      }
+      return result;
+    }
+
+    /// @brief Returns the number of rows.
+    std::size_t rows() const {
+      return m_rows;
+    }
+    /// @brief Returns the number of columns.
+    std::size_t cols() const {
+      return m_cols;
+    }
+    /*@{*/
+    /// @brief Gives access to the entry in a certain row and column.
+    T& operator()(std::size_t row, std::size_t col) {
+      return m_entries[row * m_cols + col];
+    }
+    T const& operator()(std::size_t row, std::size_t col) const {
+      return m_entries[row * m_cols + col];
+    }
+    /*@}*/
+    /// @brief Returns the entries, row by row.
+    std::vector<T> const& entries() const {
+      return m_entries;
+    }
+
+    /// @brief Returns the transpose of this matrix.
+    Matrix transpose() const {
+      Matrix result(m_cols, m_rows);
+      for (std::size_t i = 0; i < m_rows; ++i) {
+        for (std::size_t j = 0; j < m_cols; ++j) {
+          result(j, i) = (*this)(i, j);
+        }
+      }
+      return result;
+    }
+
+    /*@{*/
+    /**
+     * @brief Adds or subtracts another matrix of the same shape.
+     *
+     * If the shapes are different, then nothing is done.
+     */
+    Matrix& operator+=(Matrix const& rhs) {
+      if (m_rows == rhs.m_rows && m_cols == rhs.m_cols) {
+        for (std::size_t i = 0; i < m_entries.size(); ++i) {
+          m_entries[i] += rhs.m_entries[i];
+        }
+      }
+      return *this;
+    }
+    Matrix& operator-=(Matrix const& rhs) {
+      if (m_rows == rhs.m_rows && m_cols == rhs.m_cols) {
+        for (std::size_t i = 0; i < m_entries.size(); ++i) {
+          m_entries[i] -= rhs.m_entries[i];
+        }
+      }
+      return *this;
+    }
+    /*@}*/
+    /// @brief Multiplies this matrix by another one on the right. See multiply.
+    Matrix& operator*=(Matrix const& rhs) {
+      Matrix result;
+      multiply(*this, rhs, result);
+      *this = std::move(result);
+      return *this;
+    }
+
+  private:
+
+    // Implementation Details
+    // ----------------------
+    //   Entry (i, j) is stored at m_entries[i * m_cols + j].
+
+    std::size_t m_rows;
+    std::size_t m_cols;
+    std::vector<T> m_entries;
+
+  };
+
+  // The size of the square blocks that matrix multiplication works through, so
+  // that the rows and columns it is using stay in cache.
+  std::size_t const MATRIX_BLOCK_SIZE = 32;
+
+  /**
+   * @brief Multiplies two matrices.
+   *
+   * The work is done a block at a time, so that the entries being combined
+   * stay in cache, and each product is accumulated without making temporary
+   * matrices. Returns false, without changing result_out, if the number of
+   * columns of lhs is not the number of rows of rhs.
+   */
+  template <typename T>
+  bool multiply(Matrix<T> const& lhs, Matrix<T> const& rhs, Matrix<T>& result_out) {
+    if (lhs.cols() != rhs.rows()) {
+      return false;
+    }
+    std::size_t const rows = lhs.rows();
+    std::size_t const inner = lhs.cols();
+    std::size_t const cols = rhs.cols();
+    Matrix<T> result(rows, cols);
+    T product;
+    for (std::size_t rowBlock = 0; rowBlock < rows; rowBlock += MATRIX_BLOCK_SIZE) {
+      std::size_t const rowEnd = std::min(rowBlock + MATRIX_BLOCK_SIZE, rows);
+      for (std::size_t innerBlock = 0; innerBlock < inner; innerBlock += MATRIX_BLOCK_SIZE) {
+        std::size_t const innerEnd = std::min(innerBlock + MATRIX_BLOCK_SIZE, inner);
+        for (std::size_t colBlock = 0; colBlock < cols; colBlock += MATRIX_BLOCK_SIZE) {
+          std::size_t const colEnd = std::min(colBlock + MATRIX_BLOCK_SIZE, cols);
+          for (std::size_t i = rowBlock; i < rowEnd; ++i) {
+            for (std::size_t k = innerBlock; k < innerEnd; ++k) {
+              T const& factor = lhs(i, k);
+              if (factor == T()) {
+                continue;
+              }
+              for (std::size_t j = colBlock; j < colEnd; ++j) {
+                product = factor;
+                product *= rhs(k, j);
+                result(i, j) += product;
+              }
+            }
+          }
+        }
+      }
+    }
+    result_out = std::move(result);
+    return true;
+  }
+
+  template <typename T>
+  Matrix<T> operator+(Matrix<T> lhs, Matrix<T> const& rhs) {
+    return lhs += rhs;
+  }
+  template <typename T>
+  Matrix<T> operator-(Matrix<T> lhs, Matrix<T> const& rhs) {
+    return lhs -= rhs;
+  }
+  template <typename T>
+  Matrix<T> operator*(Matrix<T> lhs, Matrix<T> const& rhs) {
+    return lhs *= rhs;
+  }
+  template <typename T>
+  bool operator==(Matrix<T> const& lhs, Matrix<T> const& rhs) {
+    return lhs.rows() == rhs.rows() && lhs.cols() == rhs.cols() && lhs.entries() == rhs.entries();
+  }
+  template <typename T>
+  bool operator!=(Matrix<T> const& lhs, Matrix<T> const& rhs) {
+    return !(lhs == rhs);
+  }
+
+  /**
+   * @brief Brings a matrix to row echelon form by Bareiss's fraction-free elimination.
+   *
+   * Each step replaces the entries below and to the right of the pivot with
+   * (a * pivot - b * c) / previous pivot, where the division is always exact,
+   * so that over the Integers everything stays an Integer and the entries
+   * never grow larger than the minors of the matrix. Rows are swapped to find
+   * non-zero pivots. Returns the rank.
+   * @param val The matrix, which is changed into row echelon form
+   * @param pivotCols Only the first pivotCols columns are used for pivots
+   * @param sign_out Where the sign of the row permutation (1 or -1) is stored
+   */
+  template <typename T>
+  std::size_t eliminateBareiss(Matrix<T>& val, std::size_t pivotCols, int& sign_out) {
+    std::size_t const rows = val.rows();
+    std::size_t const cols = val.cols();
+    T previous = T(Integer(1));
+    std::size_t rank = 0;
+    int sign = 1;
+    for (std::size_t col = 0; col < pivotCols && rank < rows; ++col) {
+      std::size_t pivot = rank;
+      while (pivot < rows && val(pivot, col) == T()) {
+        ++pivot;
+      }
+      if (pivot == rows) {
+        continue;
+      }
+      if (pivot != rank) {
+        for (std::size_t j = 0; j < cols; ++j) {
+          std::swap(val(pivot, j), val(rank, j));
+        }
+        sign = -sign;
+      }
+      for (std::size_t i = rank + 1; i < rows; ++i) {
+        for (std::size_t j = col + 1; j < cols; ++j) {
+          T entry = val(i, j) * val(rank, col);
+          entry -= val(i, col) * val(rank, j);
+          entry /= previous;
+          val(i, j) = std::move(entry);
+        }
+        val(i, col) = T();
+      }
+      previous = val(rank, col);
+      ++rank;
+    }
+    sign_out = sign;
+    return rank;
+  }
+
+  /**
+   * @brief Finds the determinant of a square matrix, by fraction-free elimination.
+   *
+   * Returns false if the matrix isn't square. The determinant of an empty
+   * matrix is one.
+   */
+  template <typename T>
+  bool determinant(Matrix<T> const& val, T& result_out) {
+    if (val.rows() != val.cols()) {
+      return false;
+    }
+    if (val.rows() == 0) {
+      result_out = T(Integer(1));
+      return true;
+    }
+    Matrix<T> work(val);
+    int sign;
+    if (eliminateBareiss(work, work.cols(), sign) < work.rows()) {
+      result_out = T();
+      return true;
+    }
+    // After elimination, the last pivot is the determinant of the permuted matrix.
+    result_out = work(work.rows() - 1, work.cols() - 1);
+    if (sign < 0) {
+      result_out = -result_out;
+    }
+    return true;
+  }
+
+  /// @brief Finds the rank of a matrix, by fraction-free elimination.
+  template <typename T>
+  std::size_t rank(Matrix<T> const& val) {
+    Matrix<T> work(val);
+    int sign;
+    return eliminateBareiss(work, work.cols(), sign);
+  }
+
+  /**
+   * @brief Solves lhs * x = rhs without fractions, as x = numerators / denominator.
+   *
+   * The denominator is the determinant of lhs (up to sign), and every entry
+   * of the solution shares it, as in Cramer's rule, so over the Integers
+   * the whole solution is found without any gcds. Returns false if lhs isn't
+   * square, is singular, or doesn't have as many rows as rhs.
+   * @param lhs The square matrix of coefficients
+   * @param rhs The right hand sides, one column for each system to solve
+   * @param numerators_out Where the numerators of the solution are stored
+   * @param denominator_out Where the common denominator is stored
+   */
+  template <typename T>
+  bool solve(Matrix<T> const& lhs, Matrix<T> const& rhs, Matrix<T>& numerators_out, T& denominator_out) {
+    std::size_t const size = lhs.rows();
+    if (lhs.cols() != size || rhs.rows() != size) {
+      return false;
+    }
+    // The right hand sides go along for the elimination.
+    std::size_t const numSystems = rhs.cols();
+    Matrix<T> work(size, size + numSystems);
+    for (std::size_t i = 0; i < size; ++i) {
+      for (std::size_t j = 0; j < size; ++j) {
+        work(i, j) = lhs(i, j);
+      }
+      for (std::size_t j = 0; j < numSystems; ++j) {
+        work(i, size + j) = rhs(i, j);
+      }
+    }
+    int sign;
+    if (eliminateBareiss(work, size, sign) < size) {
+      return false;
+    }
+    // Back substitution, scaled by the determinant so that it stays exact:
+    // pivot(i) * X(i) = det * b(i) - sum of work(i, j) * X(j) over j > i.
+    T const det = size == 0 ? T(Integer(1)) : work(size - 1, size - 1);
+    Matrix<T> numerators(size, numSystems);
+    for (std::size_t system = 0; system < numSystems; ++system) {
+      for (std::size_t i = size; i != 0; --i) {
+        T sum = det * work(i - 1, size + system);
+        for (std::size_t j = i; j < size; ++j) {
+          sum -= work(i - 1, j) * numerators(j, system);
+        }
+        sum /= work(i - 1, i - 1);
+        numerators(i - 1, system) = std::move(sum);
+      }
+    }
+    numerators_out = std::move(numerators);
+    denominator_out = det;
+    return true;
+  }
+
+  /*@{*/
+  /**
+   * @brief The exact algorithms for Rational matrices, which work over the Integers instead.
+   *
+   * Each row is multiplied by the lowest common denominator of its entries,
+   * which scales the determinant by a known factor and doesn't change the
+   * rank or the solutions. The fraction-free elimination then runs on
+   * Integers, and only the final results are made into Rationals. This avoids
+   * the gcd that every Rational operation would otherwise need.
+   */
+  bool determinant(Matrix<Rational> const& val, Rational& result_out);
+  std::size_t rank(Matrix<Rational> const& val);
+  bool solve(Matrix<Rational> const& lhs, Matrix<Rational> const& rhs, Matrix<Rational>& result_out);
+  /*@}*/
+
+  /**
+   * @brief Finds the determinant of a square Integer matrix by working modulo many primes.
+   *
+   * The determinant is found modulo enough word sized primes to pin it down
+   * (by Hadamard's bound), using ordinary Gaussian elimination on words, and
+   * is put back together with the Chinese remainder theorem. The primes are
+   * independent, so they are split between as many threads as the thread
+   * limit allows. For large matrices with large entries this is much faster
+   * than fraction-free elimination. Returns false if the matrix isn't square.
+   */
+  bool determinantMultiModular(Matrix<Integer> const& val, Integer& result_out);
+
+}
+
+#endif
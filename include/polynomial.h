@@ -0,0 +1,363 @@
+#ifndef __APRN_POLYNOMIAL_H_
+#define __APRN_POLYNOMIAL_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "integer.h"
+
+namespace aprn {
+
+  /**
+   * @brief Multiplies two lists of polynomial coefficients, lowest degree first.
+   *
+   * This is the schoolbook product, which is what Polynomial uses for
+   * coefficients other than Integers.
+   */
+  template <typename T>
+  std::vector<T> multiplyCoefficients(std::vector<T> const& lhs, std::vector<T> const& rhs) {
+    if (lhs.empty() || rhs.empty()) {
+      return std::vector<T>();
+    }
+    std::vector<T> result(lhs.size() + rhs.size() - 1);
+    for (std::size_t i = 0; i < lhs.size(); ++i) {
+      for (std::size_t j = 0; j < rhs.size(); ++j) {
+        result[i + j] += lhs[i] * rhs[j];
+      }
+    }
+    return result;
+  }
+  /**
+   * @brief Multiplies two lists of Integer polynomial coefficients, lowest degree first.
+   *
+   * Unless the polynomials are tiny, this uses Kronecker substitution: each
+   * polynomial is evaluated at a power of two large enough that the
+   * coefficients of the product can't overlap, which just means laying its
+   * coefficients out next to each other in one Integer. The two Integers are
+   * multiplied with one large product, which uses the fastest multiplication
+   * that Integer has, and the coefficients are read back out of the result.
+   */
+  std::vector<Integer> multiplyCoefficients(std::vector<Integer> const& lhs,
+                                            std::vector<Integer> const& rhs);
+
+  /**
+   * @class Polynomial
+   * @brief A polynomial in one variable, with coefficients of some number type.
+   *
+   * The coefficients are stored lowest degree first, without any zeros at the
+   * top, so that the zero polynomial has no coefficients at all. Any type with
+   * the usual arithmetic operators, whose default value is zero, and which can
+   * be constructed from an Integer, can be used.
+   * Polynomials over Integer are multiplied by Kronecker substitution, and
+   * polynomials over other types with the schoolbook algorithm.
+   *
+   * @tparam T The type of the coefficients, such as Integer or Rational
+   * @author Duane Byer
+   */
+  template <typename T>
+  class Polynomial {
+
+  public:
+
+    /// @brief Constructs the zero polynomial.
+    Polynomial() {}
+    /// @brief Constructs a constant polynomial.
+    Polynomial(T constant) : m_coefficients(1, std::move(constant)) {
+      trim();
+    }
+    /// @brief Constructs a polynomial from its coefficients, lowest degree first.
+    explicit Polynomial(std::vector<T> coefficients) : m_coefficients(std::move(coefficients)) {
+      trim();
+    }
+
+    /// @brief Returns the polynomial x^power.
+    static Polynomial monomial(std::size_t power) {
+      std::vector<T> coefficients(power + 1);
+      coefficients[power] = T(Integer(1));
+      return Polynomial(std::move(coefficients));
+    }
+
+    /// @brief Returns the coefficients, lowest degree first.
+    std::vector<T> const& coefficients() const {
+      return m_coefficients;
+    }
+    /// @brief Returns the coefficient of x^power, which is zero past the degree.
+    T coefficient(std::size_t power) const {
+      return power < m_coefficients.size() ? m_coefficients[power] : T();
+    }
+    /// @brief Returns the degree, or -1 for the zero polynomial.
+    long long degree() const {
+      return (long long) m_coefficients.size() - 1;
+    }
+    /// @brief Returns whether this is the zero polynomial.
+    bool isZero() const {
+      return m_coefficients.empty();
+    }
+    /// @brief Returns the coefficient of the highest power, or zero for the zero polynomial.
+    T leadingCoefficient() const {
+      return m_coefficients.empty() ? T() : m_coefficients.back();
+    }
+
+    /// @brief Evaluates the polynomial at a point, using Horner's method.
+    T operator()(T const& x) const {
+      T result = T();
+      for (std::size_t i = m_coefficients.size(); i != 0; --i) {
+        result *= x;
+        result += m_coefficients[i - 1];
+      }
+      return result;
+    }
+    /**
+     * @brief Evaluates the polynomial at many points at once.
+     *
+     * With few points, each one is done with Horner's method. With many, the
+     * products of (x - point) are built up in a tree, and the polynomial is
+     * reduced modulo each node on the way back down, so that each leaf is left
+     * with the value at its point. The reductions are divisions by monic
+     * polynomials, so they use fast division.
+     */
+    std::vector<T> evaluate(std::vector<T> const& points) const;
+
+    Polynomial operator-() const {
+      Polynomial result(*this);
+      for (T& coefficient : result.m_coefficients) {
+        coefficient = -coefficient;
+      }
+      return result;
+    }
+    Polynomial& operator+=(Polynomial const& rhs) {
+      if (m_coefficients.size() < rhs.m_coefficients.size()) {
+        m_coefficients.resize(rhs.m_coefficients.size());
+      }
+      for (std::size_t i = 0; i < rhs.m_coefficients.size(); ++i) {
+        m_coefficients[i] += rhs.m_coefficients[i];
+      }
+      trim();
+      return *this;
+    }
+    Polynomial& operator-=(Polynomial const& rhs) {
+      if (m_coefficients.size() < rhs.m_coefficients.size()) {
+        m_coefficients.resize(rhs.m_coefficients.size());
+      }
+      for (std::size_t i = 0; i < rhs.m_coefficients.size(); ++i) {
+        m_coefficients[i] -= rhs.m_coefficients[i];
+      }
+      trim();
+      return *this;
+    }
+    Polynomial& operator*=(Polynomial const& rhs) {
+      m_coefficients = multiplyCoefficients(m_coefficients, rhs.m_coefficients);
+      trim();
+      return *this;
+    }
+
+    /**
+     * @brief Divides one polynomial by another, giving the quotient and remainder.
+     *
+     * The remainder has a lower degree than the divisor. Returns false if the
+     * divisor is zero, or if the division can't be done with this type of
+     * coefficient (over the Integers, when the leading coefficient of the
+     * divisor doesn't divide the coefficients it has to), in which case the
+     * outputs aren't changed. Long quotients by divisors whose leading
+     * coefficient can be inverted (such as monic ones) are found with Newton's
+     * method, using fast multiplication, and short ones by long division.
+     */
+    static bool divide(Polynomial const& lhs, Polynomial const& rhs,
+                       Polynomial& quot_out, Polynomial& rem_out);
+
+  private:
+
+    // Internal functions. See below for documentation.
+
+    void trim();
+    static bool divideLong(Polynomial const& lhs, Polynomial const& rhs,
+                           Polynomial& quot_out, Polynomial& rem_out);
+    static Polynomial inverseSeries(Polynomial const& val, std::size_t length, T const& inverseConstant);
+    static Polynomial truncate(Polynomial const& val, std::size_t length);
+    static Polynomial reverse(Polynomial const& val, std::size_t length);
+
+    // Implementation Details
+    // ----------------------
+    //   The coefficients never have a zero at the top, so the degree is always
+    // one less than the number of coefficients, and two equal polynomials always
+    // have equal lists of coefficients.
+
+    std::vector<T> m_coefficients;
+
+  };
+
+  template <typename T>
+  Polynomial<T> operator+(Polynomial<T> lhs, Polynomial<T> const& rhs) {
+    return lhs += rhs;
+  }
+  template <typename T>
+  Polynomial<T> operator-(Polynomial<T> lhs, Polynomial<T> const& rhs) {
+    return lhs -= rhs;
+  }
+  template <typename T>
+  Polynomial<T> operator*(Polynomial<T> lhs, Polynomial<T> const& rhs) {
+    return lhs *= rhs;
+  }
+  template <typename T>
+  bool operator==(Polynomial<T> const& lhs, Polynomial<T> const& rhs) {
+    return lhs.coefficients() == rhs.coefficients();
+  }
+  template <typename T>
+  bool operator!=(Polynomial<T> const& lhs, Polynomial<T> const& rhs) {
+    return !(lhs == rhs);
+  }
+
+  // Below this many points, multipoint evaluation just uses Horner's method.
+  std::size_t const POLYNOMIAL_TREE_POINTS = 16;
+  // Below this many coefficients in the quotient, division is done by long division.
+  std::size_t const POLYNOMIAL_NEWTON_DIVISION = 32;
+
+  template <typename T>
+  void Polynomial<T>::trim() {
+    while (!m_coefficients.empty() && m_coefficients.back() == T()) {
+      m_coefficients.pop_back();
+    }
+  }
+
+  template <typename T>
+  Polynomial<T> Polynomial<T>::truncate(Polynomial const& val, std::size_t length) {
+    // Keeps the terms below x^length.
+    if (val.m_coefficients.size() <= length) {
+      return val;
+    }
+    return Polynomial(std::vector<T>(val.m_coefficients.begin(), val.m_coefficients.begin() + length));
+  }
+
+  template <typename T>
+  Polynomial<T> Polynomial<T>::reverse(Polynomial const& val, std::size_t length) {
+    // Returns x^(length - 1) * val(1 / x), for a polynomial with fewer than length
+    // coefficients.
+    std::vector<T> coefficients(length);
+    for (std::size_t i = 0; i < val.m_coefficients.size(); ++i) {
+      coefficients[length - 1 - i] = val.m_coefficients[i];
+    }
+    return Polynomial(std::move(coefficients));
+  }
+
+  template <typename T>
+  Polynomial<T> Polynomial<T>::inverseSeries(Polynomial const& val, std::size_t length,
+                                             T const& inverseConstant) {
+    // Finds the power series g with val * g = 1 modulo x^length, by Newton's
+    // method: each step g = g * (2 - val * g) doubles the number of correct terms.
+    Polynomial result(inverseConstant);
+    std::size_t known = 1;
+    while (known < length) {
+      known = std::min(2 * known, length);
+      Polynomial error = truncate(truncate(val, known) * result, known);
+      result = truncate(result * (Polynomial(T(Integer(2))) - error), known);
+    }
+    return result;
+  }
+
+  template <typename T>
+  bool Polynomial<T>::divideLong(Polynomial const& lhs, Polynomial const& rhs,
+                                 Polynomial& quot_out, Polynomial& rem_out) {
+    // Long division, taking off one term of the quotient at a time. Each term has
+    // to come out exactly, which over the Integers it might not.
+    std::vector<T> rem = lhs.m_coefficients;
+    std::size_t const rhsSize = rhs.m_coefficients.size();
+    T const& lead = rhs.m_coefficients.back();
+    std::vector<T> quot(rem.size() >= rhsSize ? rem.size() - rhsSize + 1 : 0);
+    for (std::size_t i = quot.size(); i != 0; --i) {
+      T& top = rem[i - 1 + rhsSize - 1];
+      T term = top / lead;
+      if (term * lead != top) {
+        return false;
+      }
+      for (std::size_t j = 0; j < rhsSize; ++j) {
+        rem[i - 1 + j] -= term * rhs.m_coefficients[j];
+      }
+      quot[i - 1] = std::move(term);
+    }
+    quot_out = Polynomial(std::move(quot));
+    rem_out = Polynomial(std::move(rem));
+    return true;
+  }
+
+  template <typename T>
+  bool Polynomial<T>::divide(Polynomial const& lhs, Polynomial const& rhs,
+                             Polynomial& quot_out, Polynomial& rem_out) {
+    if (rhs.isZero()) {
+      return false;
+    }
+    if (lhs.degree() < rhs.degree()) {
+      quot_out = Polynomial();
+      rem_out = lhs;
+      return true;
+    }
+    std::size_t const quotSize = (std::size_t) (lhs.degree() - rhs.degree()) + 1;
+    T const& lead = rhs.m_coefficients.back();
+    T const one = T(Integer(1));
+    T inverse = one / lead;
+    if (quotSize < POLYNOMIAL_NEWTON_DIVISION || inverse * lead != one) {
+      return divideLong(lhs, rhs, quot_out, rem_out);
+    }
+    // Reversing the coefficients turns the quotient into the leading terms of a
+    // power series, rev(lhs) / rev(rhs), which Newton's method finds with a few
+    // multiplications. The remainder is then what is left over.
+    std::size_t const lhsSize = lhs.m_coefficients.size();
+    std::size_t const rhsSize = rhs.m_coefficients.size();
+    Polynomial inverseDivisor = inverseSeries(reverse(rhs, rhsSize), quotSize, inverse);
+    Polynomial reversedQuot = truncate(truncate(reverse(lhs, lhsSize), quotSize) * inverseDivisor, quotSize);
+    Polynomial quot = reverse(reversedQuot, quotSize);
+    rem_out = lhs - quot * rhs;
+    quot_out = std::move(quot);
+    return true;
+  }
+
+  template <typename T>
+  std::vector<T> Polynomial<T>::evaluate(std::vector<T> const& points) const {
+    std::vector<T> result;
+    if (points.size() < POLYNOMIAL_TREE_POINTS) {
+      for (T const& point : points) {
+        result.push_back((*this)(point));
+      }
+      return result;
+    }
+    // The tree of products of (x - point), with the leaves in tree[0] and the
+    // root at the top. Each node is the product of the two below it, and an odd
+    // node at the end of a level is carried up as it is.
+    std::vector<std::vector<Polynomial>> tree(1);
+    for (T const& point : points) {
+      tree[0].push_back(Polynomial(std::vector<T>{ -point, T(Integer(1)) }));
+    }
+    while (tree.back().size() > 1) {
+      std::vector<Polynomial> const& below = tree.back();
+      std::vector<Polynomial> level;
+      for (std::size_t i = 0; i + 1 < below.size(); i += 2) {
+        level.push_back(below[i] * below[i + 1]);
+      }
+      if (below.size() % 2 != 0) {
+        level.push_back(below.back());
+      }
+      tree.push_back(std::move(level));
+    }
+    // Going back down, each node's remainder is reduced by its children. The
+    // products are monic, so the divisions always work.
+    std::vector<Polynomial> remainders(1);
+    Polynomial quot;
+    divide(*this, tree.back()[0], quot, remainders[0]);
+    for (std::size_t level = tree.size() - 1; level != 0; --level) {
+      std::vector<Polynomial> const& below = tree[level - 1];
+      std::vector<Polynomial> next(below.size());
+      for (std::size_t i = 0; i < below.size(); ++i) {
+        divide(remainders[i / 2], below[i], quot, next[i]);
+      }
+      remainders = std::move(next);
+    }
+    for (Polynomial const& remainder : remainders) {
+      result.push_back(remainder.coefficient(0));
+    }
+    return result;
+  }
+
+}
+
+#endif
@@ -0,0 +1,95 @@
+#ifndef __APRN_PRODUCT_TREE_H_
+#define __APRN_PRODUCT_TREE_H_
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "integer.h"
+
+namespace aprn {
+
+  /**
+   * @class ProductTree
+   * @brief A balanced tree of the products of a list of moduli.
+   *
+   * The leaves of the tree are the moduli themselves, and every other node is
+   * the product of its children. Once the tree has been built, it can be used
+   * to reduce an Integer by every modulus at once (with a remainder tree), or
+   * to reconstruct an Integer from its residues by the Chinese remainder
+   * theorem. Both take about as long as a few multiplications of Integers the
+   * size of the product of all of the moduli, rather than one division for
+   * every modulus.
+   *
+   * @author Duane Byer
+   */
+  class ProductTree {
+
+  public:
+
+    /**
+     * @brief Builds the product tree of a list of moduli.
+     *
+     * The moduli must all be positive.
+     */
+    explicit ProductTree(std::vector<Integer> moduli);
+
+    /// @brief Returns the number of moduli in the tree.
+    std::size_t size() const {
+      return m_levels.front().size();
+    }
+    /// @brief Returns the moduli at the leaves of the tree.
+    std::vector<Integer> const& moduli() const {
+      return m_levels.front();
+    }
+    /// @brief Returns the product of all of the moduli.
+    Integer const& product() const {
+      return m_levels.back().front();
+    }
+
+    /**
+     * @brief Reduces an Integer by each of the moduli.
+     *
+     * The remainders are always non-negative, even if the Integer is negative,
+     * and are given in the same order as the moduli.
+     */
+    std::vector<Integer> remainders(Integer const& x) const;
+
+    /**
+     * @brief Finds the Integer with the given remainders by each of the moduli.
+     *
+     * The result is the unique Integer in the range [0, product()) which has each
+     * of the residues as its remainder by the corresponding modulus. Returns
+     * false if the moduli are not pairwise coprime, or if the wrong number of
+     * residues is given.
+     * @param residues The remainders, in the same order as the moduli
+     * @param result_out Where the reconstructed Integer is stored
+     */
+    bool crt(std::vector<Integer> const& residues, Integer& result_out) const;
+
+  private:
+
+    // Internal functions. See source file for documentation.
+
+    void computeCoefficients() const;
+
+    // Implementation Details
+    // ----------------------
+    //   The tree is stored level by level, starting with the moduli. Node i of
+    // one level is the product of nodes 2i and 2i + 1 of the level below, or
+    // just node 2i if that is the last node of its level. The top level always
+    // has exactly one node, the product of all of the moduli.
+    //   The coefficients needed for the Chinese remainder theorem are computed
+    // the first time that they are needed, since building them costs about as
+    // much as a call to remainders. If the moduli aren't coprime, then there
+    // are no coefficients.
+
+    std::vector<std::vector<Integer> > m_levels;
+    mutable std::unique_ptr<std::once_flag> m_coefficientsFlag;
+    mutable std::vector<Integer> m_coefficients;
+
+  };
+
+}
+
+#endif
@@ -0,0 +1,126 @@
+#ifndef __APRN_RANDOM_H_
+#define __APRN_RANDOM_H_
+
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <utility>
+
+#include "integer.h"
+#include "integer_view.h"
+#include "serialization.h"
+#include "storage.h"
+
+namespace aprn {
+
+  /**
+   * @brief Returns 64 uniformly random bits from a random number generator.
+   *
+   * Generators that give 64 or 32 bits at a time (such as std::mt19937_64 and
+   * std::mt19937) are used directly. Any other generator goes through
+   * std::uniform_int_distribution.
+   */
+  template <typename URBG>
+  std::uint64_t randomLimb(URBG& urbg) {
+    if constexpr (URBG::min() == 0 &&
+                  URBG::max() == std::numeric_limits<std::uint64_t>::max()) {
+      return (std::uint64_t) urbg();
+    }
+    else if constexpr (URBG::min() == 0 &&
+                       URBG::max() == std::numeric_limits<std::uint32_t>::max()) {
+      std::uint64_t low = (std::uint32_t) urbg();
+      return low | (std::uint64_t) (std::uint32_t) urbg() << 32;
+    }
+    else {
+      return std::uniform_int_distribution<std::uint64_t>()(urbg);
+    }
+  }
+
+  /**
+   * @brief Returns a uniformly random Integer in the range [0, 2^bits).
+   *
+   * The bytes of the result are filled straight from the generator, a limb
+   * at a time, and the Integer takes them over without any arithmetic.
+   * @param bits The number of random bits
+   * @param urbg The random number generator to use
+   */
+  template <typename URBG>
+  Integer randomBits(unsigned long long bits, URBG& urbg) {
+    std::size_t const limbBytes = sizeof(std::uint64_t);
+    std::size_t const limbBits = CHAR_BIT * limbBytes;
+    std::size_t const numLimbs = (std::size_t) ((bits + limbBits - 1) / limbBits);
+    StorageVector<std::uint8_t> bytes(numLimbs * limbBytes);
+    for (std::size_t i = 0; i < numLimbs; ++i) {
+      std::uint64_t limb = randomLimb(urbg);
+      for (std::size_t j = 0; j < limbBytes; ++j) {
+        bytes[i * limbBytes + j] = (std::uint8_t) (limb >> (CHAR_BIT * j));
+      }
+    }
+    // The bits past the end are cleared.
+    bytes.resize((std::size_t) ((bits + CHAR_BIT - 1) / CHAR_BIT));
+    if (bits % CHAR_BIT != 0) {
+      bytes.back() &= (std::uint8_t) ((1u << (bits % CHAR_BIT)) - 1);
+    }
+    return importBytes(std::move(bytes));
+  }
+
+  /**
+   * @brief Returns a uniformly random Integer in the range [0, bound).
+   *
+   * The top limb is chosen first, from the values that it can have in the
+   * range, by masking it to the length of the top limb of the bound and
+   * rejecting values that are too large. The rest of the limbs are then filled
+   * in freely. Only when the top limb ties with the bound do the other limbs
+   * have to be compared, and the whole draw is only repeated if they are too
+   * large, which happens with a probability of at most one half.
+   * @param bound The end of the range, which must be positive. If it isn't,
+   *              then zero is returned.
+   * @param urbg The random number generator to use
+   */
+  template <typename URBG>
+  Integer randomBelow(Integer const& bound, URBG& urbg) {
+    IntegerView const view(bound);
+    if (view.isNegative() || !view) {
+      return Integer();
+    }
+    std::size_t const limbBytes = sizeof(std::uint64_t);
+    std::size_t const numLimbs = view.limbCount();
+    std::uint64_t const top = view.limb(numLimbs - 1);
+    std::uint64_t mask = top;
+    for (unsigned shift = 1; shift < CHAR_BIT * limbBytes; shift *= 2) {
+      mask |= mask >> shift;
+    }
+
+    StorageVector<std::uint8_t> bytes(numLimbs * limbBytes);
+    while (true) {
+      std::uint64_t topLimb;
+      do {
+        topLimb = randomLimb(urbg) & mask;
+      } while (topLimb > top);
+
+      // If the top limb is below the top of the bound, then any lower limbs will do.
+      // Otherwise, the lower limbs are compared from the most significant down.
+      int compare = topLimb < top ? -1 : 0;
+      for (std::size_t i = numLimbs - 1; i != 0; --i) {
+        std::uint64_t limb = randomLimb(urbg);
+        if (compare == 0 && limb != view.limb(i - 1)) {
+          compare = limb < view.limb(i - 1) ? -1 : 1;
+        }
+        for (std::size_t j = 0; j < limbBytes; ++j) {
+          bytes[(i - 1) * limbBytes + j] = (std::uint8_t) (limb >> (CHAR_BIT * j));
+        }
+      }
+      if (compare < 0) {
+        for (std::size_t j = 0; j < limbBytes; ++j) {
+          bytes[(numLimbs - 1) * limbBytes + j] = (std::uint8_t) (topLimb >> (CHAR_BIT * j));
+        }
+        return importBytes(std::move(bytes));
+      }
+    }
+  }
+
+}
+
+#endif
@@ -1,6 +1,8 @@
 #ifndef __APRN_RATIONAL_H_
 #define __APRN_RATIONAL_H_
 
+#include <cstddef>
+#include <functional>
 #include <istream>
 #include <ostream>
 
@@ -51,10 +53,19 @@ namespace aprn {
     explicit operator long double() const;
     /*@}*/
     
+    /// @brief Returns the numerator, which has the same sign as the Rational.
+    Integer const& numerator() const {
+      return m_numerator;
+    }
+    /// @brief Returns the denominator, which is always positive.
+    Integer const& denominator() const {
+      return m_denominator;
+    }
+    
     /// @brief Gives the negative of this Rational.
     Rational operator-() const;
     /// @brief Negates this Rational in place.
-    Integer& negate();
+    Rational& negate();
     /*@{*/
     /// @brief Returns this Rational unchanged.
     Rational const& operator+() const {
@@ -91,9 +102,14 @@ namespace aprn {
     Rational& operator-=(Rational const& rhs);
     /// @brief Multiplies another Rational to this one.
     Rational& operator*=(Rational const& rhs);
-    /// @brief Divides this Rational by another one.
+    /// @brief Divides this Rational by another one. Dividing by zero gives zero, as for Integers.
     Rational& operator/=(Rational const& rhs);
-    /// @brief Modulates this Rational by another one.
+    /**
+     * @brief Modulates this Rational by another one.
+     * 
+     * This is the remainder after the quotient has been truncated towards zero,
+     * so it has the same sign as this Rational, as for Integers.
+     */
     Rational& operator%=(Rational const& rhs);
     
   private:
@@ -157,12 +173,35 @@ namespace aprn {
     lhs /= rhs;
     return lhs;
   }
+  /// @brief Returns the modulus of one Rational by another one.
+  inline Rational operator%(Rational lhs, Rational const& rhs) {
+    lhs %= rhs;
+    return lhs;
+  }
   
   /// @brief Outputs a Rational to a standard stream.
   std::ostream& operator<<(std::ostream& os, Rational const& obj);
   /// @brief Reads in a Rational from a standard stream.
   std::istream& operator>>(std::istream& is, Rational& obj);
+  
+  /**
+   * @brief Hashes the value of a Rational, by hashing its numerator and denominator.
+   * @see hash.h
+   */
+  std::size_t hashValue(Rational const& val);
+
+}
 
+namespace std {
+  
+  /// @brief Hashes Rationals, so that they can be used as keys of unordered containers.
+  template <>
+  struct hash<aprn::Rational> {
+    std::size_t operator()(aprn::Rational const& val) const {
+      return aprn::hashValue(val);
+    }
+  };
+  
 }
 
 #endif
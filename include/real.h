@@ -1,11 +1,190 @@
 #ifndef __APRN_REAL_H_
 #define __APRN_REAL_H_
 
+#include <ostream>
+
+#include "integer.h"
+
 namespace aprn {
 
+  /**
+   * @brief The direction in which a value is rounded when it cannot be stored exactly.
+   */
+  enum class RoundingMode {
+    /// Round towards negative infinity.
+    Down,
+    /// Round towards positive infinity.
+    Up,
+    /// Round towards zero.
+    TowardZero,
+    /// Round away from zero.
+    AwayFromZero,
+    /// Round to the closest value, with ties going to the even value.
+    Nearest,
+    /// Round to the closest value, with ties going away from zero.
+    NearestAwayFromZero,
+    /// Round to the closest value, with ties going towards zero.
+    NearestTowardZero
+  };
+
+  /**
+   * @class Real
+   * @brief A binary floating point number with an arbitrary precision mantissa.
+   *
+   * The value of a Real is its mantissa multiplied by two to the power of its
+   * exponent. Addition, subtraction, and multiplication are exact, so that the
+   * precision of a Real only changes when it is explicitly rounded.
+   *
+   * @author Duane Byer
+   */
   class Real {
+
+    friend std::ostream& operator<<(std::ostream& os, Real const& obj);
+
+    friend bool operator==(Real const& lhs, Real const& rhs);
+    friend bool operator<(Real const& lhs, Real const& rhs);
+
+  public:
+
+    /// @brief Constructs a Real with a value of zero.
+    Real();
+
+    /*@{*/
+    /**
+     * @brief Constructs a Real to have a certain value.
+     *
+     * This constructor can also be used to convert any compatible
+     * type to a Real. The conversion is always exact. Infinite and NaN doubles
+     * have no Real equivalent, and throw std::invalid_argument.
+     */
+    Real(Integer val);
+    Real(double val);
+    /*@}*/
+
+    /// @brief Constructs a Real with the value mantissa * 2^exponent.
+    Real(Integer mantissa, long long exponent);
+
+    /**
+     * @brief Explicit narrowing conversion from Real to double.
+     *
+     * The result is rounded to the nearest double.
+     */
+    explicit operator double() const;
+
+    /// @brief Returns the mantissa of this Real.
+    Integer const& mantissa() const {
+      return m_mantissa;
+    }
+    /// @brief Returns the exponent of this Real.
+    long long exponent() const {
+      return m_exponent;
+    }
+
+    /// @brief Gives the negative of this Real.
+    Real operator-() const;
+    /// @brief Negates this Real in place.
+    Real& negate();
+
+    /// @brief Adds another Real to this one exactly.
+    Real& operator+=(Real const& rhs);
+    /// @brief Subtracts another Real from this one exactly.
+    Real& operator-=(Real const& rhs);
+    /// @brief Multiplies another Real to this one exactly.
+    Real& operator*=(Real const& rhs);
+
+    /**
+     * @brief Rounds the mantissa of this Real to at most a certain number of bits.
+     *
+     * Returns true if the value was changed by the rounding.
+     * @param precision The maximum number of bits the mantissa may have
+     * @param mode The direction to round in
+     */
+    bool round(unsigned long long precision, RoundingMode mode);
+
+  private:
+
+    // Internal functions. See source file for documentation.
+
+    void makeValid();
+
+    // Implementation Details
+    // ----------------------
+    //   A Real is represented by an Integer mantissa and a power of two. The
+    // representation of a value is not unique, since any trailing zero bits
+    // of the mantissa could be moved into the exponent, so comparisons are
+    // done on the values themselves. Zero always has an exponent of zero.
+
+    Integer m_mantissa;
+    long long m_exponent;
+
   };
 
+  /// @brief Checks if this Real equals another one.
+  bool operator==(Real const& lhs, Real const& rhs);
+  /// @brief Checks if this Real is smaller than another one.
+  bool operator<(Real const& lhs, Real const& rhs);
+
+  /// @brief Checks if this Real does not equal another one.
+  inline bool operator!=(Real const& lhs, Real const& rhs) {
+    return !operator==(lhs, rhs);
+  }
+  /// @brief Checks if this Real is greater than another one.
+  inline bool operator>(Real const& lhs, Real const& rhs) {
+    return operator<(rhs, lhs);
+  }
+  /// @brief Checks if this Real is smaller than or equal to another one.
+  inline bool operator<=(Real const& lhs, Real const& rhs) {
+    return !operator>(lhs, rhs);
+  }
+  /// @brief Checks if this Real is greater than or equal to another one.
+  inline bool operator>=(Real const& lhs, Real const& rhs) {
+    return !operator<(lhs, rhs);
+  }
+
+  /// @brief Returns the exact sum of two Reals.
+  inline Real operator+(Real lhs, Real const& rhs) {
+    lhs += rhs;
+    return lhs;
+  }
+  /// @brief Returns the exact difference of two Reals.
+  inline Real operator-(Real lhs, Real const& rhs) {
+    lhs -= rhs;
+    return lhs;
+  }
+  /// @brief Returns the exact product of two Reals.
+  inline Real operator*(Real lhs, Real const& rhs) {
+    lhs *= rhs;
+    return lhs;
+  }
+
+  /**
+   * @brief Gets the sign of a Real.
+   *
+   * If the Real is positive, then +1 is returned. If it is negative, then -1
+   * is returned. Otherwise, 0 is returned.
+   */
+  int signum(Real const& val);
+  /// @brief Returns the absolute value of a Real.
+  Real abs(Real const& val);
+
+  /**
+   * @brief Divides one Real by another, rounding the result to a certain precision.
+   *
+   * Returns zero if the divisor is zero.
+   * @param lhs The dividend
+   * @param rhs The divisor
+   * @param precision The maximum number of bits in the mantissa of the result
+   * @param mode The direction to round the result in
+   */
+  Real div(Real const& lhs, Real const& rhs, unsigned long long precision, RoundingMode mode);
+
+  /**
+   * @brief Outputs a Real to a standard stream.
+   *
+   * The Real is written exactly, in the form mantissa*2^exponent.
+   */
+  std::ostream& operator<<(std::ostream& os, Real const& obj);
+
 }
 
 #endif
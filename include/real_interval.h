@@ -0,0 +1,199 @@
+#ifndef __APRN_REAL_INTERVAL_H_
+#define __APRN_REAL_INTERVAL_H_
+
+#include <functional>
+#include <ostream>
+
+#include "real.h"
+
+namespace aprn {
+
+  /**
+   * @class RealInterval
+   * @brief A ball of Reals that is guaranteed to contain an exact result.
+   *
+   * A RealInterval is given by a midpoint and a radius. Every operation on
+   * RealIntervals rounds the midpoint of its result to the working precision, and
+   * widens the radius by enough to account for both the rounding and the radii
+   * of the operands. The exact result of a computation is therefore always
+   * contained in the ball, no matter how much precision was lost along the way.
+   *
+   * The working precision of a result is the larger of the precisions of its
+   * operands. The function refine() can be used to repeat a computation with
+   * more precision only when the result is not accurate enough.
+   *
+   * @author Duane Byer
+   */
+  class RealInterval {
+
+    friend std::ostream& operator<<(std::ostream& os, RealInterval const& obj);
+
+  public:
+
+    /// @brief The working precision used when none is given, in bits.
+    static unsigned long long const DEFAULT_PRECISION;
+
+    /// @brief Constructs a RealInterval containing exactly zero.
+    RealInterval();
+
+    /*@{*/
+    /**
+     * @brief Constructs a RealInterval containing exactly one value.
+     *
+     * The value is stored exactly, even if it has more bits than the working
+     * precision. Only the results of operations are rounded.
+     */
+    RealInterval(Real val, unsigned long long precision = DEFAULT_PRECISION);
+    RealInterval(Integer val, unsigned long long precision = DEFAULT_PRECISION);
+    /*@}*/
+
+    /// @brief Constructs a RealInterval with a certain midpoint and radius.
+    RealInterval(Real midpoint, Real radius, unsigned long long precision = DEFAULT_PRECISION);
+
+    /// @brief Returns the center of this RealInterval.
+    Real const& midpoint() const {
+      return m_midpoint;
+    }
+    /// @brief Returns the radius of this RealInterval, or zero if it is unbounded (see isBounded).
+    Real const& radius() const {
+      return m_radius;
+    }
+    /// @brief Returns the working precision of this RealInterval, in bits.
+    unsigned long long precision() const {
+      return m_precision;
+    }
+    /// @brief Changes the working precision used for later operations.
+    void setPrecision(unsigned long long precision) {
+      m_precision = precision;
+    }
+
+    /**
+     * @brief Returns whether this RealInterval is bounded.
+     *
+     * An unbounded RealInterval, such as the result of dividing by an interval
+     * containing zero, contains every value and has no lower or upper bound.
+     */
+    bool isBounded() const {
+      return !m_isInfinite;
+    }
+    /// @brief Returns whether this RealInterval contains exactly one value.
+    bool isExact() const;
+    /// @brief Returns whether a value lies within this RealInterval.
+    bool contains(Real const& val) const;
+    /// @brief Returns whether zero lies within this RealInterval.
+    bool containsZero() const;
+
+    /*@{*/
+    /**
+     * @brief Finds the smallest or largest value in this RealInterval.
+     *
+     * Returns false, without changing result_out, if the RealInterval is
+     * unbounded, since then there is no such value.
+     */
+    bool lower(Real& result_out) const;
+    bool upper(Real& result_out) const;
+    /*@}*/
+
+    /**
+     * @brief Gets the number of correct bits in the midpoint, relative to its size.
+     *
+     * This is the number of bits between the leading bit of the midpoint and
+     * the leading bit of the radius. An exact RealInterval is as accurate as it
+     * is possible to be, while any RealInterval containing zero (other than
+     * exactly zero) has an accuracy of zero.
+     */
+    unsigned long long accuracy() const;
+
+    /// @brief Gives the negative of this RealInterval.
+    RealInterval operator-() const;
+    /// @brief Negates this RealInterval in place.
+    RealInterval& negate();
+
+    /// @brief Adds another RealInterval to this one.
+    RealInterval& operator+=(RealInterval const& rhs);
+    /// @brief Subtracts another RealInterval from this one.
+    RealInterval& operator-=(RealInterval const& rhs);
+    /// @brief Multiplies another RealInterval to this one.
+    RealInterval& operator*=(RealInterval const& rhs);
+    /**
+     * @brief Divides this RealInterval by another one.
+     *
+     * If the divisor contains zero, then the result is unbounded.
+     */
+    RealInterval& operator/=(RealInterval const& rhs);
+
+  private:
+
+    // Internal functions. See source file for documentation.
+
+    void roundMidpoint();
+    void roundRadius();
+    void makeInfinite();
+
+    // Implementation Details
+    // ----------------------
+    //   The midpoint is kept to at most the working precision, and any error in
+    // rounding it is added to the radius. The radius is only ever rounded up,
+    // and to a small fixed number of bits, since it only needs to be an upper
+    // bound. An unbounded RealInterval has a midpoint and radius of zero.
+
+    Real m_midpoint;
+    Real m_radius;
+    unsigned long long m_precision;
+    bool m_isInfinite;
+
+  };
+
+  /// @brief Returns the sum of two RealIntervals.
+  inline RealInterval operator+(RealInterval lhs, RealInterval const& rhs) {
+    lhs += rhs;
+    return lhs;
+  }
+  /// @brief Returns the difference of two RealIntervals.
+  inline RealInterval operator-(RealInterval lhs, RealInterval const& rhs) {
+    lhs -= rhs;
+    return lhs;
+  }
+  /// @brief Returns the product of two RealIntervals.
+  inline RealInterval operator*(RealInterval lhs, RealInterval const& rhs) {
+    lhs *= rhs;
+    return lhs;
+  }
+  /// @brief Returns the quotient of two RealIntervals.
+  inline RealInterval operator/(RealInterval lhs, RealInterval const& rhs) {
+    lhs /= rhs;
+    return lhs;
+  }
+
+  /**
+   * @brief Evaluates a computation with increasing precision until it is accurate enough.
+   *
+   * The computation is first run at the initial precision. Whenever the result
+   * is not accurate enough, the precision is raised by the number of bits that
+   * were missing (plus a small margin) and the computation is run again, so that
+   * extra precision is only paid for when it is actually needed.
+   *
+   * Returns false if the maximum precision was reached without the result
+   * becoming accurate enough. In that case, the most accurate result found is
+   * still stored.
+   * @param compute The computation, which is given the working precision to use
+   * @param accuracy The number of correct bits needed, as given by RealInterval::accuracy()
+   * @param result_out Where the result of the computation is stored
+   * @param initialPrecision The working precision to try first
+   * @param maxPrecision The working precision to give up at
+   */
+  bool refine(std::function<RealInterval(unsigned long long)> const& compute,
+              unsigned long long accuracy, RealInterval& result_out,
+              unsigned long long initialPrecision = RealInterval::DEFAULT_PRECISION,
+              unsigned long long maxPrecision = 1ULL << 24);
+
+  /**
+   * @brief Outputs a RealInterval to a standard stream.
+   *
+   * The RealInterval is written in the form [midpoint +/- radius].
+   */
+  std::ostream& operator<<(std::ostream& os, RealInterval const& obj);
+
+}
+
+#endif
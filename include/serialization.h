@@ -0,0 +1,108 @@
+#ifndef __APRN_SERIALIZATION_H_
+#define __APRN_SERIALIZATION_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+#include "integer.h"
+#include "integer_view.h"
+
+namespace aprn {
+
+  /**
+   * @brief The order of the bytes in a buffer that a magnitude is imported from or exported to.
+   */
+  enum class ByteOrder {
+    /// The least significant byte comes first.
+    LittleEndian,
+    /// The most significant byte comes first.
+    BigEndian
+  };
+
+  /// @brief Returns the number of bytes needed to store the magnitude of an integer.
+  std::size_t byteLength(IntegerView val);
+  /**
+   * @brief Writes the magnitude of an integer to a buffer of bytes.
+   *
+   * The magnitude is padded with zeros to fill the buffer. Returns false if
+   * the buffer is too small, in which case nothing is written. The sign is
+   * not written.
+   * @param val The integer to export
+   * @param buffer The buffer to write to
+   * @param size The size of the buffer, in bytes
+   * @param order The order to write the bytes in
+   */
+  bool exportBytes(IntegerView val, void* buffer, std::size_t size,
+                   ByteOrder order = ByteOrder::LittleEndian);
+  /// @brief Returns the magnitude of an integer as bytes, without padding.
+  std::vector<std::uint8_t> exportBytes(IntegerView val,
+                                        ByteOrder order = ByteOrder::LittleEndian);
+  /**
+   * @brief Reads an Integer from the magnitude stored in a buffer of bytes.
+   * @param buffer The buffer to read from
+   * @param size The size of the buffer, in bytes
+   * @param order The order of the bytes in the buffer
+   * @param isNegative Whether the result should be negative
+   */
+  Integer importBytes(void const* buffer, std::size_t size,
+                      ByteOrder order = ByteOrder::LittleEndian, bool isNegative = false);
+  /**
+   * @brief Makes an Integer from little endian bytes, taking over their storage instead of copying them.
+   *
+   * The bytes may have leading zeros. This is the fastest way to build a large
+   * Integer whose bytes have been generated elsewhere.
+   */
+  Integer importBytes(StorageVector<std::uint8_t>&& bytes, bool isNegative = false);
+
+  /**
+   * @brief Returns the number of bytes that serialize() writes for an integer.
+   *
+   * The binary format starts with a header, which is the number of limbs
+   * times two, plus one if the integer is negative, written as a variable
+   * length integer: seven bits per byte, least significant first, with the top
+   * bit of every byte but the last one set. The limbs follow, least
+   * significant first, each one in eight little endian bytes. The limbs can be
+   * viewed in place with deserialize() to an IntegerView.
+   *
+   * Every integer has exactly one encoding: there are no leading zero limbs,
+   * and zero is never negative. Equal integers can be found by comparing their
+   * encodings.
+   */
+  std::size_t serializedSize(IntegerView val);
+  /// @brief Appends the binary form of an integer to a buffer.
+  void serialize(IntegerView val, std::vector<std::uint8_t>& buffer_out);
+  /**
+   * @brief Reads an Integer in binary form from the start of a buffer.
+   *
+   * Returns false if the buffer doesn't start with a valid encoding.
+   * @param buffer The buffer to read from
+   * @param size The size of the buffer, in bytes
+   * @param result_out Where the Integer is stored
+   * @param read_out Where the number of bytes read is stored
+   */
+  bool deserialize(void const* buffer, std::size_t size,
+                   Integer& result_out, std::size_t& read_out);
+  /**
+   * @brief Views an integer in binary form at the start of a buffer, without copying it.
+   *
+   * The view refers to the limbs in the buffer, so it is only valid while the
+   * buffer is. Returns false if the buffer doesn't start with a valid encoding.
+   */
+  bool deserialize(void const* buffer, std::size_t size,
+                   IntegerView& view_out, std::size_t& read_out);
+
+  /// @brief Writes the binary form of an integer to a stream.
+  std::ostream& writeBinary(std::ostream& os, IntegerView val);
+  /**
+   * @brief Reads an Integer in binary form from a stream.
+   *
+   * The failbit of the stream is set if it doesn't hold a valid encoding.
+   */
+  std::istream& readBinary(std::istream& is, Integer& result_out);
+
+}
+
+#endif
@@ -0,0 +1,85 @@
+#ifndef __APRN_STATS_H_
+#define __APRN_STATS_H_
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace aprn {
+
+  /**
+   * @struct OperationStats
+   * @brief What has been recorded about one kind of operation.
+   *
+   * An operation that calls another (such as division calling multiplication)
+   * is counted as well as the one it calls, so the times and allocations of
+   * the outer operation include those of the inner one.
+   */
+  struct OperationStats {
+    /// The name of the operation, such as "multiply".
+    std::string name;
+    /// The number of times that the operation has run.
+    unsigned long long calls;
+    /// The total time spent in the operation, in nanoseconds.
+    unsigned long long nanoseconds;
+    /// The total number of bytes of digits and limbs allocated during the operation.
+    unsigned long long allocatedBytes;
+    /**
+     * The sizes of the operands. Entry i counts the calls whose largest
+     * operand was from 2^(i-1) to 2^i - 1 bits long, and entry 0 counts the
+     * calls where it was zero.
+     */
+    std::vector<unsigned long long> sizeHistogram;
+  };
+
+  /**
+   * @struct Stats
+   * @brief A snapshot of the statistics that have been recorded.
+   */
+  struct Stats {
+    /// Whether the library was built with statistics. If not, nothing else is filled in.
+    bool isEnabled;
+    /// The operations, including the ones that haven't been called.
+    std::vector<OperationStats> operations;
+    /// The total number of blocks of digits and limbs that have been allocated.
+    unsigned long long allocations;
+    /// The total size of those blocks, in bytes.
+    unsigned long long allocatedBytes;
+  };
+
+  /**
+   * @brief Returns the statistics recorded so far.
+   *
+   * Statistics are only recorded when the library, and everything that uses
+   * it, is built with APRN_STATS defined. Otherwise the recording is compiled
+   * out, so that it costs nothing, and the snapshot says that it isn't enabled.
+   * The counters are updated from any thread, so a snapshot taken while other
+   * threads are working may be partway through an operation.
+   */
+  Stats stats();
+  /// @brief Sets all of the statistics back to zero.
+  void resetStats();
+
+  /**
+   * @brief Starts recording each operation as an event, for viewing as a trace.
+   *
+   * Any events from before are thrown away. Once the maximum number of events
+   * has been recorded, the rest are dropped. Returns false if the library was
+   * built without statistics.
+   */
+  bool startTrace(std::size_t maxEvents = std::size_t(1) << 20);
+  /// @brief Stops recording events, keeping the ones that were recorded.
+  void stopTrace();
+  /**
+   * @brief Writes the recorded events in the Chrome trace format.
+   *
+   * The result is JSON that can be loaded into chrome://tracing or Perfetto,
+   * with one complete event per operation, nested by thread. Returns false if
+   * the stream fails.
+   */
+  bool writeTrace(std::ostream& os);
+
+}
+
+#endif
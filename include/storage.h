@@ -0,0 +1,115 @@
+#ifndef __APRN_STORAGE_H_
+#define __APRN_STORAGE_H_
+
+#include <cstddef>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace aprn {
+
+  /**
+   * @brief The smallest block of memory that is ever put in mapped storage, in bytes.
+   *
+   * Smaller blocks always come from the heap, so that mapped storage costs
+   * nothing for everyday Integers.
+   */
+  std::size_t const MIN_MAPPED_BYTES = std::size_t(1) << 20;
+
+  /**
+   * @brief Puts large blocks of digits in memory mapped files, instead of on the heap.
+   *
+   * Once this is turned on, every block of digits or limbs of at least the
+   * threshold size is stored in a temporary file in the given directory,
+   * which is mapped into memory. The operating system then moves pages of
+   * these files between memory and disk as needed, so Integers larger than
+   * the available memory can still be worked with. The files are deleted as
+   * soon as they are created, so they are removed automatically even if the
+   * program crashes.
+   *
+   * The algorithms for multiplication and radix conversion divide their work
+   * into halves recursively, so that they work through contiguous ranges of
+   * memory at a time, which keeps the number of pages moving to and from disk
+   * low. Blocks that were allocated before this is called stay where they are.
+   * Returns false if mapped storage is not available on this platform, or the
+   * directory can't be written to, in which case the heap continues to be used.
+   * @param directory The directory to create the files in
+   * @param threshold The size in bytes from which blocks are mapped, which is
+   *                  never less than MIN_MAPPED_BYTES
+   */
+  bool setMappedStorage(std::string const& directory, std::size_t threshold = MIN_MAPPED_BYTES);
+  /// @brief Stops putting new blocks in mapped storage.
+  void disableMappedStorage();
+  /// @brief Returns the number of bytes that are currently in mapped storage.
+  std::size_t mappedBytes();
+
+#ifdef APRN_STATS
+  /// @brief Counts an allocation of digits or limbs in the statistics. See stats().
+  void recordAllocation(std::size_t bytes);
+#endif
+
+  /*@{*/
+  /// @brief Allocates and frees blocks that may be in mapped storage. Use StorageAllocator instead.
+  void* allocateStorage(std::size_t bytes);
+  void deallocateStorage(void* block, std::size_t bytes);
+  /*@}*/
+
+  /**
+   * @class StorageAllocator
+   * @brief An allocator that puts blocks in mapped storage when it is turned on and the block is large.
+   *
+   * Integer keeps its digits in memory from this allocator, and so do the
+   * temporary arrays of the multiplication and division algorithms.
+   *
+   * @see setMappedStorage
+   * @author Duane Byer
+   */
+  template <typename T>
+  class StorageAllocator {
+
+  public:
+
+    using value_type = T;
+
+    StorageAllocator() = default;
+    template <typename U>
+    StorageAllocator(StorageAllocator<U> const&) {}
+
+    T* allocate(std::size_t n) {
+      std::size_t bytes = n * sizeof(T);
+#ifdef APRN_STATS
+      recordAllocation(bytes);
+#endif
+      if (bytes < MIN_MAPPED_BYTES) {
+        return static_cast<T*>(::operator new(bytes));
+      }
+      return static_cast<T*>(allocateStorage(bytes));
+    }
+    void deallocate(T* block, std::size_t n) {
+      std::size_t bytes = n * sizeof(T);
+      if (bytes < MIN_MAPPED_BYTES) {
+        ::operator delete(block);
+      }
+      else {
+        deallocateStorage(block, bytes);
+      }
+    }
+
+  };
+
+  template <typename T, typename U>
+  bool operator==(StorageAllocator<T> const&, StorageAllocator<U> const&) {
+    return true;
+  }
+  template <typename T, typename U>
+  bool operator!=(StorageAllocator<T> const&, StorageAllocator<U> const&) {
+    return false;
+  }
+
+  /// @brief A vector whose elements may be in mapped storage.
+  template <typename T>
+  using StorageVector = std::vector<T, StorageAllocator<T>>;
+
+}
+
+#endif
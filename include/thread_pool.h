@@ -0,0 +1,181 @@
+#ifndef __APRN_THREAD_POOL_H_
+#define __APRN_THREAD_POOL_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace aprn {
+
+  /**
+   * @class ThreadPool
+   * @brief A fixed set of worker threads that run tasks, using work stealing.
+   *
+   * Each worker has its own queue of tasks. A task submitted from a worker goes
+   * on the back of that worker's queue, and workers take their own tasks from
+   * the back, so a divide and conquer algorithm is worked through depth first
+   * by each thread. A worker with nothing left to do steals from the front of
+   * another worker's queue, where the oldest (and usually largest) tasks are.
+   *
+   * A thread that has to wait for a task should do so with ThreadPool::wait,
+   * which runs other tasks in the meantime rather than blocking. This means
+   * that tasks can submit tasks of their own and wait for them without being
+   * able to deadlock the pool.
+   *
+   * @author Duane Byer
+   */
+  class ThreadPool {
+
+  public:
+
+    /// @brief Starts a pool with a certain number of worker threads (at least one).
+    explicit ThreadPool(unsigned threads);
+    /// @brief Finishes all of the tasks that have been submitted, and then stops the workers.
+    ~ThreadPool();
+
+    ThreadPool(ThreadPool const&) = delete;
+    ThreadPool& operator=(ThreadPool const&) = delete;
+
+    /// @brief Returns the number of worker threads.
+    unsigned size() const {
+      return (unsigned) m_threads.size();
+    }
+
+    /// @brief Queues a function to be run by a worker, returning a future for its result.
+    template <typename Function>
+    std::future<typename std::invoke_result<Function>::type> submit(Function function) {
+      using Result = typename std::invoke_result<Function>::type;
+      // A packaged task can't be copied, but a std::function has to be copyable,
+      // so the task is shared instead.
+      auto task = std::make_shared<std::packaged_task<Result()>>(std::move(function));
+      std::future<Result> result = task->get_future();
+      push([task]() { (*task)(); });
+      return result;
+    }
+
+    /**
+     * @brief Waits for a future from this pool, running other tasks until it is ready.
+     *
+     * Returns the result of the future.
+     */
+    template <typename T>
+    T wait(std::future<T>& future) {
+      while (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        if (!runPendingTask()) {
+          std::this_thread::yield();
+        }
+      }
+      return future.get();
+    }
+
+    /// @brief Runs one task that is waiting in the pool on this thread, returning false if there were none.
+    bool runPendingTask();
+
+  private:
+
+    using Task = std::function<void()>;
+
+    // Internal functions. See source file for documentation.
+
+    void push(Task task);
+    bool pop(Task& task_out);
+    void work(std::size_t index);
+
+    // Implementation Details
+    // ----------------------
+    //   Each queue has its own lock, so that workers taking tasks from their
+    // own queues don't get in each other's way. The shared lock and condition
+    // are only used for putting idle workers to sleep and waking them up. The
+    // count of pending tasks is changed under the shared lock when a task is
+    // added, so that a worker can't miss the wake up while going to sleep.
+
+    struct Queue {
+      std::mutex mutex;
+      std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> m_queues;
+    std::vector<std::thread> m_threads;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::atomic<std::size_t> m_pending;
+    std::atomic<std::size_t> m_nextQueue;
+    bool m_isStopping;
+
+  };
+
+  /**
+   * @brief Returns the pool that the Integer operations run their parallel work on.
+   *
+   * The pool is started the first time that it is needed, with one worker for
+   * each hardware thread, unless a different size was set beforehand.
+   */
+  ThreadPool& threadPool();
+  /**
+   * @brief Sets the number of workers that the shared pool will start with.
+   *
+   * This only has an effect before the pool has been started. Returns false,
+   * and does nothing, if it already has been.
+   */
+  bool setThreadPoolSize(unsigned threads);
+
+  /**
+   * @brief Returns the number of threads that large operations on this thread may use.
+   *
+   * Each thread has its own limit, which starts at one, so that operations
+   * run serially unless parallelism has been asked for. Small operands are
+   * always handled on the calling thread, whatever the limit.
+   */
+  unsigned threadLimit();
+  /// @brief Sets the number of threads that large operations on this thread may use.
+  void setThreadLimit(unsigned threads);
+
+  /**
+   * @brief Runs a list of tasks, handing all but the first to the shared pool.
+   *
+   * The calling thread runs the first task itself, and then waits for the rest
+   * with ThreadPool::wait. The tasks are checked against the same cancellation
+   * token as the calling thread. If any of them throws, the rest are still
+   * waited for (since they may use memory owned by the caller) before the
+   * first exception is passed on.
+   * @param tasks The tasks to run
+   * @param isParallel Whether to use the pool, rather than running the tasks in order on this thread
+   */
+  void runTasks(std::vector<std::function<void()>> const& tasks, bool isParallel = true);
+
+  /**
+   * @class ThreadLimitScope
+   * @brief Changes the thread limit of the current thread until the end of a scope.
+   */
+  class ThreadLimitScope {
+
+  public:
+
+    explicit ThreadLimitScope(unsigned threads) : m_previous(threadLimit()) {
+      setThreadLimit(threads);
+    }
+    ~ThreadLimitScope() {
+      setThreadLimit(m_previous);
+    }
+
+    ThreadLimitScope(ThreadLimitScope const&) = delete;
+    ThreadLimitScope& operator=(ThreadLimitScope const&) = delete;
+
+  private:
+
+    unsigned m_previous;
+
+  };
+
+}
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef __APRN_THRESHOLDS_H_
+#define __APRN_THRESHOLDS_H_
+
+#include <cstddef>
+#include <istream>
+#include <ostream>
+#include <string>
+
+namespace aprn {
+
+  /**
+   * @struct Thresholds
+   * @brief The operand sizes at which Integer switches from one algorithm to another.
+   *
+   * The best crossover points depend a lot on the processor, so they are not
+   * fixed. The defaults are built in, and can be replaced when the library is
+   * built by defining the macros APRN_KARATSUBA_THRESHOLD and so on, or by
+   * putting a header named tuned_thresholds.h (as written by the tune program)
+   * in the source directory. When the program starts, they are read from the
+   * file named by the APRN_THRESHOLDS environment variable, if there is one.
+   */
+  struct Thresholds {
+    /// Products where the smaller operand has fewer limbs than this use the grade school algorithm.
+    std::size_t karatsuba;
+    /// Products where the smaller operand has fewer limbs than this are never split between threads.
+    std::size_t parallel;
+    /// Divisions where the divisor or quotient has fewer half limbs than this use the grade school algorithm.
+    std::size_t recursiveDivision;
+    /// Values with fewer limbs than this are converted to text a word of digits at a time, instead of recursively.
+    std::size_t radixConversion;
+  };
+
+  /// @brief Returns the thresholds that the library was built with.
+  Thresholds defaultThresholds();
+  /// @brief Returns the thresholds that are currently in use.
+  Thresholds thresholds();
+  /**
+   * @brief Changes the thresholds that are in use.
+   *
+   * This is meant for tuning and testing. Every threshold is at least one,
+   * and the Karatsuba and recursive division thresholds at least two, so
+   * smaller values are raised.
+   */
+  void setThresholds(Thresholds const& values);
+
+  /**
+   * @brief Reads thresholds from a stream, in the format written by writeThresholds.
+   *
+   * Each line has the form "name = value", where the names are the fields of
+   * Thresholds, and "#" starts a comment. Thresholds that aren't mentioned
+   * keep the values they have in result_out. Returns false, without changing
+   * result_out, if a line can't be understood.
+   */
+  bool readThresholds(std::istream& is, Thresholds& result_out);
+  /// @brief Writes thresholds to a stream, one per line.
+  void writeThresholds(std::ostream& os, Thresholds const& values);
+  /**
+   * @brief Reads thresholds from a file and puts them into use.
+   *
+   * Returns false, and leaves the thresholds as they were, if the file can't
+   * be read.
+   */
+  bool loadThresholds(std::string const& path);
+
+}
+
+#endif
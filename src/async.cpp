@@ -0,0 +1,79 @@
+#include "../include/async.h"
+
+#include <utility>
+
+#include "../include/thread_pool.h"
+
+using namespace aprn;
+
+namespace {
+
+  // The flag of the token that the current thread is checking, if any.
+  thread_local std::shared_ptr<std::atomic<bool>> currentFlag;
+
+  // Runs an operation on a new thread, under a token and thread limit. The
+  // operands are moved into the function, and the function into the thread, so
+  // that they are never copied along the way.
+  template <typename Function>
+  auto startOperation(CancellationToken token, unsigned threads, Function function) ->
+    std::future<decltype(function())> {
+    return std::async(std::launch::async, [token, threads, function = std::move(function)]() {
+      CancellationScope cancellationScope(token);
+      ThreadLimitScope threadScope(threads);
+      checkCancelled();
+      return function();
+    });
+  }
+
+}
+
+CancellationScope::CancellationScope(CancellationToken const& token) :
+  m_previous(currentFlag) {
+  currentFlag = token.m_isCancelled;
+}
+
+CancellationScope::~CancellationScope() {
+  currentFlag = m_previous;
+}
+
+void aprn::checkCancelled() {
+  std::atomic<bool> const* flag = currentFlag.get();
+  if (flag != nullptr && flag->load(std::memory_order_relaxed)) {
+    throw OperationCancelled();
+  }
+}
+
+CancellationToken aprn::currentCancellationToken() {
+  return CancellationToken(currentFlag);
+}
+
+std::future<Integer> aprn::asyncMul(Integer lhs, Integer rhs, CancellationToken token, unsigned threads) {
+  return startOperation(token, threads, [lhs = std::move(lhs), rhs = std::move(rhs)]() {
+    return lhs * rhs;
+  });
+}
+
+std::future<div_result> aprn::asyncDiv(Integer lhs, Integer rhs, CancellationToken token, unsigned threads) {
+  return startOperation(token, threads, [lhs = std::move(lhs), rhs = std::move(rhs)]() {
+    return div(lhs, rhs);
+  });
+}
+
+std::future<Integer> aprn::asyncPow(Integer base, unsigned long long exponent,
+                                    CancellationToken token, unsigned threads) {
+  return startOperation(token, threads, [base = std::move(base), exponent]() {
+    return pow(base, exponent);
+  });
+}
+
+std::future<Integer> aprn::asyncFactorial(unsigned long long n, CancellationToken token, unsigned threads) {
+  return startOperation(token, threads, [n, threads]() {
+    return factorial(n, threads);
+  });
+}
+
+std::future<std::string> aprn::asyncToString(Integer val, int base, CancellationToken token, unsigned threads) {
+  return startOperation(token, threads, [val = std::move(val), base]() {
+    return toString(val, base);
+  });
+}
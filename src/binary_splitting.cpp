@@ -0,0 +1,65 @@
+#include "../include/binary_splitting.h"
+
+#include <functional>
+#include <vector>
+
+#include "../include/async.h"
+#include "../include/thread_pool.h"
+
+using namespace aprn;
+
+namespace {
+
+  // The smallest number of terms for which it is worth handing half of the range
+  // to the pool. Below this, the cost of the hand off outweighs the multiplications.
+  unsigned long long const MIN_PARALLEL_TERMS = 64;
+
+}
+
+series_result aprn::binarySplit(unsigned long long first, unsigned long long last,
+                                SeriesTerm const& p, SeriesTerm const& q, SeriesTerm const& a,
+                                unsigned threads) {
+  if (first >= last) {
+    // The empty series sums to zero, and is the identity for combine.
+    series_result result = { Integer(1), Integer(1), Integer() };
+    return result;
+  }
+  else if (last - first == 1) {
+    // A single term a(k) * p(k) / q(k).
+    series_result result = { p(first), q(first), Integer() };
+    result.t = a(first) * result.p;
+    return result;
+  }
+
+  checkCancelled();
+  // Splitting at the midpoint keeps both halves (and so the operands of the
+  // multiplications in combine) about the same size. The right half is run on
+  // this thread, while the left half goes to the pool.
+  unsigned long long middle = first + (last - first) / 2;
+  bool const isParallel = threads > 1 && last - first >= MIN_PARALLEL_TERMS;
+  unsigned const leftThreads = isParallel ? threads / 2 : 1;
+  unsigned const rightThreads = isParallel ? threads - leftThreads : 1;
+  series_result left;
+  series_result right;
+  std::vector<std::function<void()>> tasks;
+  tasks.push_back([&]() {
+    right = binarySplit(middle, last, p, q, a, rightThreads);
+  });
+  tasks.push_back([&]() {
+    left = binarySplit(first, middle, p, q, a, leftThreads);
+  });
+  runTasks(tasks, isParallel);
+  return combine(left, right);
+}
+
+series_result aprn::combine(series_result const& lhs, series_result const& rhs) {
+  // If S1 = T1 / Q1 and S2 = T2 / Q2 are the two partial sums, then the terms of
+  // the second range all carry an extra factor of P1 / Q1 from the first range:
+  //   S = T1 / Q1 + (P1 / Q1) * (T2 / Q2) = (T1 * Q2 + P1 * T2) / (Q1 * Q2)
+  series_result result;
+  result.t = lhs.t * rhs.q;
+  result.t += lhs.p * rhs.t;
+  result.p = lhs.p * rhs.p;
+  result.q = lhs.q * rhs.q;
+  return result;
+}
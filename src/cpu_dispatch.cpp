@@ -0,0 +1,52 @@
+#include "../include/cpu_dispatch.h"
+
+#include "integer_kernels.h"
+
+using namespace aprn;
+
+namespace {
+  
+  CpuFeatures detectFeatures() {
+    CpuFeatures result = CpuFeatures();
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+    __builtin_cpu_init();
+    result.bmi2 = __builtin_cpu_supports("bmi2");
+    result.adx = __builtin_cpu_supports("adx");
+    result.avx2 = __builtin_cpu_supports("avx2");
+    result.avx512f = __builtin_cpu_supports("avx512f");
+    result.avx512bw = __builtin_cpu_supports("avx512bw");
+    result.avx512ifma = __builtin_cpu_supports("avx512ifma");
+#endif
+    return result;
+  }
+  
+}
+
+CpuFeatures const& aprn::cpuFeatures() {
+  static CpuFeatures const features = detectFeatures();
+  return features;
+}
+
+std::string aprn::activeKernels() {
+  return kernels::kernels().name;
+}
+
+std::vector<std::string> aprn::supportedKernels() {
+  std::vector<std::string> result;
+  for (kernels::KernelTable const* table : kernels::allKernels()) {
+    if (table->isSupported()) {
+      result.push_back(table->name);
+    }
+  }
+  return result;
+}
+
+bool aprn::useKernels(std::string const& name) {
+  for (kernels::KernelTable const* table : kernels::allKernels()) {
+    if (table->name == name && table->isSupported()) {
+      kernels::setKernels(*table);
+      return true;
+    }
+  }
+  return false;
+}
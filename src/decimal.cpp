@@ -0,0 +1,359 @@
+#include "../include/decimal.h"
+
+#include <cctype>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../include/math_integer.h"
+
+using namespace aprn;
+
+namespace {
+
+  // The powers of ten below this are kept in a table, which covers the scales
+  // that money and most other decimal data use.
+  unsigned long long const NUM_CACHED_POWERS = 64;
+  // The largest exponent that a string may have, either way. A larger one would
+  // ask for a coefficient or scale far beyond anything that text should be able
+  // to make, and a huge power of ten to go with it.
+  long long const MAX_EXPONENT = 100000;
+
+  std::vector<Integer> makePowersOfTen() {
+    std::vector<Integer> result;
+    result.reserve(NUM_CACHED_POWERS);
+    result.push_back(Integer(1));
+    while (result.size() < NUM_CACHED_POWERS) {
+      result.push_back(result.back() * Integer(10));
+    }
+    return result;
+  }
+
+  Integer powerOfTen(unsigned long long exponent) {
+    static std::vector<Integer> const powers = makePowersOfTen();
+    if (exponent < NUM_CACHED_POWERS) {
+      return powers[exponent];
+    }
+    return pow(Integer(10), exponent);
+  }
+
+  // Divides num by den, rounding the quotient to an Integer in the way given by
+  // the mode. The denominator must not be zero.
+  Integer divideRounded(Integer const& num, Integer const& den, RoundingMode mode) {
+    div_result result = div(num, den);
+    if (signum(result.rem) == 0) {
+      return result.quot;
+    }
+    // The quotient has been truncated towards zero, so the exact value lies
+    // between it and the next Integer away from zero, in the direction of sign.
+    int const sign = signum(num) * signum(den);
+    bool isAway = false;
+    switch (mode) {
+    case RoundingMode::Nearest:
+    case RoundingMode::NearestAwayFromZero:
+    case RoundingMode::NearestTowardZero: {
+      Integer const twiceRem = abs(result.rem) << 1;
+      Integer const magnitude = abs(den);
+      isAway = magnitude < twiceRem ||
+               (twiceRem == magnitude && (mode == RoundingMode::NearestAwayFromZero ||
+                                          (mode == RoundingMode::Nearest && !even(result.quot))));
+      break;
+    }
+    case RoundingMode::AwayFromZero:
+      isAway = true;
+      break;
+    case RoundingMode::TowardZero:
+      isAway = false;
+      break;
+    case RoundingMode::Up:
+      isAway = sign > 0;
+      break;
+    case RoundingMode::Down:
+      isAway = sign < 0;
+      break;
+    }
+    if (isAway) {
+      if (sign > 0) {
+        ++result.quot;
+      }
+      else {
+        --result.quot;
+      }
+    }
+    return result.quot;
+  }
+
+  // Compares two Decimals, returning a negative number, zero or a positive number.
+  int compare(Decimal const& lhs, Decimal const& rhs) {
+    int const lhsSign = signum(lhs.coefficient());
+    int const rhsSign = signum(rhs.coefficient());
+    if (lhsSign != rhsSign || lhs.scale() == rhs.scale()) {
+      if (lhsSign != rhsSign) {
+        return lhsSign < rhsSign ? -1 : 1;
+      }
+      return lhs.coefficient() < rhs.coefficient() ? -1 : (lhs.coefficient() == rhs.coefficient() ? 0 : 1);
+    }
+    // Only the coefficient with the smaller scale has to be brought up.
+    if (lhs.scale() < rhs.scale()) {
+      Integer const scaled = lhs.coefficient() * powerOfTen(rhs.scale() - lhs.scale());
+      return scaled < rhs.coefficient() ? -1 : (scaled == rhs.coefficient() ? 0 : 1);
+    }
+    Integer const scaled = rhs.coefficient() * powerOfTen(lhs.scale() - rhs.scale());
+    return lhs.coefficient() < scaled ? -1 : (lhs.coefficient() == scaled ? 0 : 1);
+  }
+
+}
+
+Decimal::Decimal() : m_coefficient(), m_scale(0) {}
+
+Decimal::Decimal(Integer val) : m_coefficient(std::move(val)), m_scale(0) {}
+
+Decimal::Decimal(Integer coefficient, unsigned long long scale) :
+  m_coefficient(std::move(coefficient)),
+  m_scale(scale) {
+}
+
+Decimal::operator Rational() const {
+  Rational result(m_coefficient);
+  result /= Rational(powerOfTen(m_scale));
+  return result;
+}
+
+Decimal::operator Integer() const {
+  return m_coefficient / powerOfTen(m_scale);
+}
+
+Decimal Decimal::operator-() const {
+  Decimal result(*this);
+  result.negate();
+  return result;
+}
+
+Decimal& Decimal::negate() {
+  m_coefficient.negate();
+  return *this;
+}
+
+Decimal& Decimal::operator+=(Decimal const& rhs) {
+  if (m_scale < rhs.m_scale) {
+    m_coefficient *= powerOfTen(rhs.m_scale - m_scale);
+    m_scale = rhs.m_scale;
+  }
+  if (m_scale == rhs.m_scale) {
+    m_coefficient += rhs.m_coefficient;
+  }
+  else {
+    m_coefficient += rhs.m_coefficient * powerOfTen(m_scale - rhs.m_scale);
+  }
+  return *this;
+}
+
+Decimal& Decimal::operator-=(Decimal const& rhs) {
+  if (m_scale < rhs.m_scale) {
+    m_coefficient *= powerOfTen(rhs.m_scale - m_scale);
+    m_scale = rhs.m_scale;
+  }
+  if (m_scale == rhs.m_scale) {
+    m_coefficient -= rhs.m_coefficient;
+  }
+  else {
+    m_coefficient -= rhs.m_coefficient * powerOfTen(m_scale - rhs.m_scale);
+  }
+  return *this;
+}
+
+Decimal& Decimal::operator*=(Decimal const& rhs) {
+  m_coefficient *= rhs.m_coefficient;
+  m_scale += rhs.m_scale;
+  return *this;
+}
+
+bool aprn::operator==(Decimal const& lhs, Decimal const& rhs) {
+  return compare(lhs, rhs) == 0;
+}
+
+bool aprn::operator<(Decimal const& lhs, Decimal const& rhs) {
+  return compare(lhs, rhs) < 0;
+}
+
+Decimal aprn::rescale(Decimal const& val, unsigned long long scale, RoundingMode mode) {
+  if (scale >= val.scale()) {
+    return Decimal(val.coefficient() * powerOfTen(scale - val.scale()), scale);
+  }
+  return Decimal(divideRounded(val.coefficient(), powerOfTen(val.scale() - scale), mode), scale);
+}
+
+bool aprn::divide(Decimal const& lhs, Decimal const& rhs, unsigned long long scale, RoundingMode mode,
+                  Decimal& result_out) {
+  if (signum(rhs.coefficient()) == 0) {
+    return false;
+  }
+  // The quotient of the coefficients has a scale of lhs.scale() - rhs.scale(),
+  // so whichever side is short of the wanted scale is multiplied up to it.
+  if (scale + rhs.scale() >= lhs.scale()) {
+    Integer const num = lhs.coefficient() * powerOfTen(scale + rhs.scale() - lhs.scale());
+    result_out = Decimal(divideRounded(num, rhs.coefficient(), mode), scale);
+  }
+  else {
+    Integer const den = rhs.coefficient() * powerOfTen(lhs.scale() - rhs.scale() - scale);
+    result_out = Decimal(divideRounded(lhs.coefficient(), den, mode), scale);
+  }
+  return true;
+}
+
+Decimal aprn::toDecimal(Rational const& val, unsigned long long scale, RoundingMode mode) {
+  return Decimal(divideRounded(val.numerator() * powerOfTen(scale), val.denominator(), mode), scale);
+}
+
+std::string aprn::toString(Decimal const& val) {
+  bool const isNegative = signum(val.coefficient()) < 0;
+  std::string digits = toString(isNegative ? -val.coefficient() : val.coefficient());
+  if (val.scale() != 0) {
+    // There is always at least one digit before the point.
+    if (digits.size() <= val.scale()) {
+      digits.insert(0, (std::size_t) (val.scale() - digits.size() + 1), '0');
+    }
+    digits.insert(digits.size() - (std::size_t) val.scale(), 1, '.');
+  }
+  if (isNegative) {
+    digits.insert(0, 1, '-');
+  }
+  return digits;
+}
+
+bool aprn::fromString(std::string const& str, Decimal& result_out) {
+  // The string is split into the digits of the coefficient, which are read all
+  // at once by fromString, and the exponent.
+  std::size_t i = 0;
+  std::string digits;
+  if (i < str.size() && (str[i] == '-' || str[i] == '+')) {
+    digits.push_back(str[i]);
+    ++i;
+  }
+  bool hasDigits = false;
+  unsigned long long fractionDigits = 0;
+  bool isFraction = false;
+  for (; i < str.size(); ++i) {
+    if (std::isdigit((unsigned char) str[i])) {
+      digits.push_back(str[i]);
+      hasDigits = true;
+      if (isFraction) {
+        ++fractionDigits;
+      }
+    }
+    else if (str[i] == '.' && !isFraction) {
+      isFraction = true;
+    }
+    else {
+      break;
+    }
+  }
+  if (!hasDigits) {
+    return false;
+  }
+
+  long long exponent = 0;
+  if (i < str.size() && (str[i] == 'e' || str[i] == 'E')) {
+    ++i;
+    bool const isNegative = i < str.size() && str[i] == '-';
+    if (i < str.size() && (str[i] == '-' || str[i] == '+')) {
+      ++i;
+    }
+    std::size_t const start = i;
+    for (; i < str.size() && std::isdigit((unsigned char) str[i]); ++i) {
+      exponent = exponent * 10 + (str[i] - '0');
+      if (exponent > MAX_EXPONENT) {
+        return false;
+      }
+    }
+    if (i == start) {
+      return false;
+    }
+    if (isNegative) {
+      exponent = -exponent;
+    }
+  }
+  if (i != str.size()) {
+    return false;
+  }
+
+  Integer coefficient;
+  if (!fromString(digits, 10, coefficient)) {
+    return false;
+  }
+  if (exponent > 0 && (unsigned long long) exponent > fractionDigits) {
+    coefficient *= powerOfTen((unsigned long long) exponent - fractionDigits);
+    result_out = Decimal(coefficient, 0);
+  }
+  else {
+    result_out = Decimal(coefficient, (unsigned long long) ((long long) fractionDigits - exponent));
+  }
+  return true;
+}
+
+std::ostream& aprn::operator<<(std::ostream& os, Decimal const& obj) {
+  // The whole thing is written in one go, so that the width of the stream
+  // applies to all of it.
+  std::string output = toString(obj);
+  if ((os.flags() & std::ios::showpos) && signum(obj.m_coefficient) >= 0) {
+    output.insert(0, 1, '+');
+  }
+  return os << output;
+}
+
+std::istream& aprn::operator>>(std::istream& is, Decimal& obj) {
+  // The characters that could be part of a Decimal are collected, and then
+  // checked and converted by fromString.
+  std::istream::sentry sentry(is);
+  if (!sentry) {
+    return is;
+  }
+  std::streambuf* buffer = is.rdbuf();
+  auto peek = [&]() {
+    int c = buffer->sgetc();
+    if (c == std::char_traits<char>::eof()) {
+      is.setstate(std::ios::eofbit);
+    }
+    return c;
+  };
+
+  std::string str;
+  int c = peek();
+  if (c == '-' || c == '+') {
+    str.push_back((char) c);
+    buffer->sbumpc();
+    c = peek();
+  }
+  bool isFraction = false;
+  while (std::isdigit(c) || (c == '.' && !isFraction)) {
+    isFraction = isFraction || c == '.';
+    str.push_back((char) c);
+    buffer->sbumpc();
+    c = peek();
+  }
+  if (c == 'e' || c == 'E') {
+    str.push_back((char) c);
+    buffer->sbumpc();
+    c = peek();
+    if (c == '-' || c == '+') {
+      str.push_back((char) c);
+      buffer->sbumpc();
+      c = peek();
+    }
+    while (std::isdigit(c)) {
+      str.push_back((char) c);
+      buffer->sbumpc();
+      c = peek();
+    }
+  }
+
+  Decimal result;
+  if (!fromString(str, result)) {
+    is.setstate(std::ios::failbit);
+    return is;
+  }
+  obj = std::move(result);
+  return is;
+}
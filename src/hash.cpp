@@ -0,0 +1,83 @@
+#include "../include/hash.h"
+
+#include <cstdint>
+#include <cstring>
+
+using namespace aprn;
+
+namespace {
+
+  // The multipliers and lane count of the hash, which is built the same way as
+  // xxHash64. The lanes are independent until the end, so the multiplications for
+  // several limbs can be in flight at once.
+  std::uint64_t const PRIME_1 = 0x9E3779B185EBCA87ULL;
+  std::uint64_t const PRIME_2 = 0xC2B2AE3D27D4EB4FULL;
+  std::uint64_t const PRIME_3 = 0x165667B19E3779F9ULL;
+  std::uint64_t const PRIME_4 = 0x85EBCA77C2B2AE63ULL;
+  std::uint64_t const PRIME_5 = 0x27D4EB2F165667C5ULL;
+  std::size_t const LANES = 4;
+
+  std::uint64_t rotateLeft(std::uint64_t value, unsigned bits) {
+    return (value << bits) | (value >> (64 - bits));
+  }
+
+  std::uint64_t mixLimb(std::uint64_t lane, std::uint64_t limb) {
+    return rotateLeft(lane + limb * PRIME_2, 31) * PRIME_1;
+  }
+
+  // Loads a whole limb, least significant byte first, from any alignment.
+  std::uint64_t loadLimb(std::uint8_t const* bytes) {
+    std::uint64_t result;
+    std::memcpy(&result, bytes, sizeof(result));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    result = __builtin_bswap64(result);
+#endif
+    return result;
+  }
+
+}
+
+std::size_t aprn::hashValue(IntegerView val) {
+  std::size_t const wholeLimbs = val.byteCount() / sizeof(IntegerView::Limb);
+  std::uint8_t const* bytes = val.bytes();
+  std::uint64_t lane0 = PRIME_1 + PRIME_2;
+  std::uint64_t lane1 = PRIME_2;
+  std::uint64_t lane2 = 0;
+  std::uint64_t lane3 = 0 - PRIME_1;
+
+  std::size_t i = 0;
+  for (; i + LANES <= wholeLimbs; i += LANES) {
+    std::uint8_t const* limbs = bytes + i * sizeof(IntegerView::Limb);
+    lane0 = mixLimb(lane0, loadLimb(limbs));
+    lane1 = mixLimb(lane1, loadLimb(limbs + sizeof(IntegerView::Limb)));
+    lane2 = mixLimb(lane2, loadLimb(limbs + 2 * sizeof(IntegerView::Limb)));
+    lane3 = mixLimb(lane3, loadLimb(limbs + 3 * sizeof(IntegerView::Limb)));
+  }
+  std::uint64_t result = rotateLeft(lane0, 1) + rotateLeft(lane1, 7) +
+                         rotateLeft(lane2, 12) + rotateLeft(lane3, 18);
+  result += (std::uint64_t) val.byteCount() * PRIME_5 + (val.isNegative() ? PRIME_3 : 0);
+
+  // The limbs that didn't fill all of the lanes, including the last partial one.
+  for (; i < val.limbCount(); ++i) {
+    result ^= mixLimb(0, val.limb(i));
+    result = rotateLeft(result, 27) * PRIME_1 + PRIME_4;
+  }
+
+  result ^= result >> 33;
+  result *= PRIME_2;
+  result ^= result >> 29;
+  result *= PRIME_3;
+  result ^= result >> 32;
+  return (std::size_t) result;
+}
+
+std::size_t aprn::hashValue(Integer const& val) {
+  return hashValue(IntegerView(val));
+}
+
+std::size_t aprn::hashValue(Rational const& val) {
+  // Since every Rational has only one representation, equal Rationals have equal parts.
+  std::uint64_t numeratorHash = hashValue(IntegerView(val.numerator()));
+  std::uint64_t denominatorHash = hashValue(IntegerView(val.denominator()));
+  return (std::size_t) (rotateLeft(numeratorHash, 23) * PRIME_1 ^ denominatorHash);
+}
@@ -0,0 +1,57 @@
+#ifndef __APRN_INSTRUMENTATION_H_
+#define __APRN_INSTRUMENTATION_H_
+
+#include <chrono>
+#include <cstddef>
+
+#include "../include/stats.h"
+
+namespace aprn {
+  namespace instrumentation {
+
+    // The operations that are recorded by the statistics. The names that they
+    // are given in the snapshot are in stats.cpp, in the same order.
+    enum Operation {
+      ADD,
+      SUBTRACT,
+      MULTIPLY,
+      DIVIDE,
+      SHIFT,
+      GCD,
+      POW,
+      TO_STRING,
+      FROM_STRING,
+      RATIONAL_NORMALIZE,
+      NUM_OPERATIONS
+    };
+
+#ifdef APRN_STATS
+    // Records one call of an operation, from when it is made to when it goes out
+    // of scope. The size is that of the largest operand, in bits.
+    class Scope {
+    public:
+      Scope(Operation operation, unsigned long long bits);
+      ~Scope();
+      Scope(Scope const&) = delete;
+      Scope& operator=(Scope const&) = delete;
+    private:
+      Operation m_operation;
+      unsigned long long m_bits;
+      unsigned long long m_allocatedBytes;
+      std::chrono::steady_clock::time_point m_start;
+    };
+#endif
+
+  }
+}
+
+// Records an operation for the rest of the enclosing scope. The size is only
+// worked out when statistics are turned on.
+#ifdef APRN_STATS
+#define APRN_STATS_SCOPE(operation, bits) \
+  ::aprn::instrumentation::Scope aprnStatsScope(::aprn::instrumentation::operation, (bits))
+#else
+#define APRN_STATS_SCOPE(operation, bits) ((void) 0)
+#endif
+
+#endif
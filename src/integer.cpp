@@ -1,22 +1,91 @@
 #include "../include/integer.h"
 
 #include <algorithm>
+#include <cctype>
 #include <climits>
 #include <cstdint>
-#include <iomanip>
+#include <cstring>
 #include <istream>
 #include <limits>
 #include <ostream>
-#include <sstream>
 #include <string>
+#include <type_traits>
 #include <vector>
 
+#include "../include/async.h"
 #include "../include/math_integer.h"
+#include "../include/thread_pool.h"
+#include "../include/thresholds.h"
+#include "instrumentation.h"
+#include "integer_kernels.h"
+#include "limb_arithmetic.h"
 
 using namespace aprn;
 
 bool isBigEndian();
 
+namespace {
+  
+  // Packs digits into words, least significant first, padding the top word with zeros.
+  template <typename Word>
+  StorageVector<Word> packWords(StorageVector<kernels::Digit> const& digits) {
+    std::size_t const digitsPerWord = sizeof(Word) / sizeof(kernels::Digit);
+    StorageVector<Word> result((digits.size() + digitsPerWord - 1) / digitsPerWord, 0);
+    if (digits.empty()) {
+      return result;
+    }
+    if (!isBigEndian()) {
+      std::memcpy(result.data(), digits.data(), digits.size());
+    }
+    else {
+      for (std::size_t i = 0; i < digits.size(); ++i) {
+        result[i / digitsPerWord] |= (Word) digits[i] << (CHAR_BIT * (i % digitsPerWord));
+      }
+    }
+    return result;
+  }
+  
+  // Subtracts a smaller magnitude from a larger one, which may have more digits.
+  void subtractDigits(StorageVector<kernels::Digit>& lhs, StorageVector<kernels::Digit> const& rhs) {
+    bool hasBorrow = kernels::kernels().subDigits(lhs.data(), rhs.data(), rhs.size());
+    for (std::size_t i = rhs.size(); hasBorrow && i < lhs.size(); ++i) {
+      hasBorrow = (lhs[i]-- == 0);
+    }
+  }
+  
+  // The operations on single digits used for the bitwise operators.
+  kernels::Digit andDigit(kernels::Digit lhs, kernels::Digit rhs) {
+    return lhs & rhs;
+  }
+  
+  kernels::Digit orDigit(kernels::Digit lhs, kernels::Digit rhs) {
+    return lhs | rhs;
+  }
+  
+  kernels::Digit xorDigit(kernels::Digit lhs, kernels::Digit rhs) {
+    return lhs ^ rhs;
+  }
+  
+  // Unpacks words into digits. The digits may have leading zeros afterwards.
+  template <typename Word>
+  void unpackWords(StorageVector<Word> const& words, StorageVector<kernels::Digit>& digits_out) {
+    std::size_t const digitsPerWord = sizeof(Word) / sizeof(kernels::Digit);
+    digits_out.resize(words.size() * digitsPerWord);
+    if (words.empty()) {
+      return;
+    }
+    if (!isBigEndian()) {
+      std::memcpy(digits_out.data(), words.data(), digits_out.size());
+    }
+    else {
+      for (std::size_t i = 0; i < digits_out.size(); ++i) {
+        digits_out[i] = (kernels::Digit) (words[i / digitsPerWord] >> (CHAR_BIT * (i % digitsPerWord)));
+      }
+    }
+  }
+  
+}
+
 Integer::Digit const Integer::MAX_DIGIT = std::numeric_limits<Digit>::max();
 
 Integer::Integer() {
@@ -118,11 +187,15 @@ bool aprn::operator<(Integer const& lhs, Integer const& rhs) {
     return lhs.m_isNegative;
   }
   else {
-    return Integer::compareMagnitude(lhs, rhs) == -signum(lhs);
+    // For negative numbers, the one with the larger magnitude is smaller.
+    int compare = Integer::compareMagnitude(lhs, rhs);
+    return lhs.m_isNegative ? compare > 0 : compare < 0;
   }
 }
 
 int Integer::compareMagnitude(Integer const& lhs, Integer const& rhs) {
+  static_assert(std::is_same<Digit, kernels::Digit>::value,
+                "The kernels must use the same digits as Integer");
   // Returns the sign of (|lhs| - |rhs|).
   // The easy cases are when one has more digits than the other.
   if (lhs.m_digits.size() > rhs.m_digits.size()) {
@@ -136,22 +209,9 @@ int Integer::compareMagnitude(Integer const& lhs, Integer const& rhs) {
     return 0;
   }
   else {
-    // Go through the digits one by one. As soon as one is different,
-    // we can discriminate to tell which number has a greater magnitude.
-    Integer::SizeType i = lhs.m_digits.size();
-    do {
-      --i;
-      Integer::Digit lhsDigit = lhs.m_digits[i];
-      Integer::Digit rhsDigit = rhs.m_digits[i];
-      if (lhsDigit > rhsDigit) {
-        return 1;
-      }
-      else if (lhsDigit < rhsDigit) {
-        return -1;
-      }
-    } while (i != 0);
-    // If none of the digits are different, then the numbers have equal magnitude.
-    return 0;
+    // Otherwise the digits are compared from the most significant end, and the
+    // first digit that is different decides which has the greater magnitude.
+    return kernels::kernels().compareDigits(lhs.m_digits.data(), rhs.m_digits.data(), lhs.m_digits.size());
   }
 }
 
@@ -219,12 +279,15 @@ Integer& Integer::operator--() {
       m_isNegative = true;
       m_digits.push_back(1);
     }
+    // The leading digit may have been decremented to zero.
+    makeValid();
     break;
   }
   return *this;
 }
 
 Integer& Integer::operator+=(Integer const& rhs) {
+  APRN_STATS_SCOPE(ADD, CHAR_BIT * std::max(m_digits.size(), rhs.m_digits.size()));
   // Uses utility functions to perform subtraction when adding a negative number.
   if (m_isNegative == rhs.m_isNegative) {
     return addMagnitude(rhs);
@@ -236,18 +299,14 @@ Integer& Integer::operator+=(Integer const& rhs) {
 
 Integer& Integer::addMagnitude(Integer const& rhs) {
   // This is just the grade school addition algorithm, except it acts on the magnitude
-  // of the numbers.
-  Integer::SizeType numDigits = std::max(m_digits.size(), rhs.m_digits.size());
-  bool hasCarry = false;
-  m_digits.resize(numDigits, 0);
-  for (Integer::SizeType i = 0; i < numDigits; ++i) {
-    Integer::Digit lhsDigit = m_digits[i];
-    Integer::Digit rhsDigit = i < rhs.m_digits.size() ? rhs.m_digits[i] : 0;
-    Integer::Digit maxDigit = std::max(lhsDigit, rhsDigit);
-    
-    m_digits[i] += rhsDigit + hasCarry;
-    hasCarry = (!hasCarry && m_digits[i] < maxDigit) ||
-      (hasCarry && m_digits[i] <= maxDigit);
+  // of the numbers. The digits that both numbers have are added by a kernel, and then
+  // the carry only has to be carried as far into the remaining digits as it goes.
+  if (m_digits.size() < rhs.m_digits.size()) {
+    m_digits.resize(rhs.m_digits.size(), 0);
+  }
+  bool hasCarry = kernels::kernels().addDigits(m_digits.data(), rhs.m_digits.data(), rhs.m_digits.size());
+  for (Integer::SizeType i = rhs.m_digits.size(); hasCarry && i < m_digits.size(); ++i) {
+    hasCarry = (++m_digits[i] == 0);
   }
   if (hasCarry) {
     m_digits.push_back(1);
@@ -256,6 +315,7 @@ Integer& Integer::addMagnitude(Integer const& rhs) {
 }
 
 Integer& Integer::operator-=(Integer const& rhs) {
+  APRN_STATS_SCOPE(SUBTRACT, CHAR_BIT * std::max(m_digits.size(), rhs.m_digits.size()));
   // Uses utility functions to perform addition when subtractive a negative number.
   if (m_isNegative == rhs.m_isNegative) {
     return subtractMagnitude(rhs);
@@ -270,25 +330,19 @@ Integer& Integer::subtractMagnitude(Integer const& rhs) {
   // larger than the left hand side, the algorithm is done in reverse (the left hand side
   // is subtracted from the right hand side), and then the answer has its sign flipped.
   int compMag = compareMagnitude(*this, rhs);
-  Integer::SizeType numDigits = std::max(m_digits.size(), rhs.m_digits.size());
-  bool hasBorrow = false;
-  m_digits.resize(numDigits, 0);
   if (compMag == 0) {
     m_digits.clear();
     m_isNegative = false;
     return *this;
   }
-  for (Integer::SizeType i = 0; i < numDigits; ++i) {
-    Integer::Digit lhsDigit = m_digits[i];
-    Integer::Digit rhsDigit = i < rhs.m_digits.size() ? rhs.m_digits[i] : 0;
-    
-    m_digits[i] = (lhsDigit - rhsDigit) * compMag - hasBorrow;
-    Integer::Digit compDigit = (compMag > 0) * lhsDigit + (compMag < 0) * rhsDigit;
-    hasBorrow = (!hasBorrow && m_digits[i] > compDigit) ||
-      (hasBorrow && m_digits[i] >= compDigit);
-  }
   if (compMag < 0) {
+    StorageVector<Digit> smaller(rhs.m_digits);
+    m_digits.swap(smaller);
     m_isNegative = !m_isNegative;
+    subtractDigits(m_digits, smaller);
+  }
+  else {
+    subtractDigits(m_digits, rhs.m_digits);
   }
   // It's possible for the answer to be in invalid form, so we have to check it.
   makeValid();
@@ -296,7 +350,10 @@ Integer& Integer::subtractMagnitude(Integer const& rhs) {
 }
 
 Integer& Integer::operator*=(Integer const& rhs) {
-  return setToProduct(Integer(*this), rhs);
+  // The product is built up in place, so neither operand can refer to this
+  // Integer (which matters when squaring with x *= x).
+  Integer lhs(*this);
+  return setToProduct(lhs, &rhs == this ? lhs : rhs);
 }
 
 Integer aprn::operator*(Integer const& lhs, Integer const& rhs) {
@@ -306,34 +363,27 @@ Integer aprn::operator*(Integer const& lhs, Integer const& rhs) {
 }
 
 Integer& Integer::setToProduct(Integer const& lhs, Integer const& rhs) {
-  // Grade school multiplication algorithm. It is unfortunately very slow when dealing
-  // with large numbers, so could be optimized for those situations.
-  Integer::Digit carry = 0;
-  
-  m_digits.clear();
-  m_isNegative = false;
-  
-  for (Integer::SizeType i = 0; i < rhs.m_digits.size(); ++i) {
-    Integer::Digit rhsDigit = rhs.m_digits[i];
-    Integer nextSum;
-    nextSum.m_digits.resize(i, 0);
-    carry = 0;
-    for (Integer::SizeType j = 0; j < lhs.m_digits.size(); ++j) {
-      Integer::Digit lhsDigit = lhs.m_digits[j];
-      // A double sized digit is used to store the product, then the left half becomes the carry
-      // while the right half becomes part of the next sum. Endianness is important here.
-      Integer::DoubleDigit digitProduct = lhsDigit * rhsDigit + carry;
-      carry = reinterpret_cast<Integer::Digit*>(&digitProduct)[isBigEndian() ? 0 : 1];
-      nextSum.m_digits.push_back(reinterpret_cast<Integer::Digit*>(&digitProduct)[isBigEndian() ? 1 : 0]);
-    }
-    nextSum.m_digits.push_back(carry);
-    nextSum.makeValid();
-    operator+=(nextSum);
+  // The digits are packed into limbs first, so that each step multiplies as many digits
+  // at once as the processor can. Small products use the grade school algorithm, and
+  // large ones use Karatsuba's algorithm, which splits the work between threads if the
+  // thread limit allows it.
+  APRN_STATS_SCOPE(MULTIPLY, CHAR_BIT * std::max(lhs.m_digits.size(), rhs.m_digits.size()));
+  if (lhs.m_digits.empty() || rhs.m_digits.empty()) {
+    m_digits.clear();
+    m_isNegative = false;
+    return *this;
   }
+  StorageVector<limbs::Limb> lhsLimbs = packWords<limbs::Limb>(lhs.m_digits);
+  StorageVector<limbs::Limb> rhsLimbs = packWords<limbs::Limb>(rhs.m_digits);
+  bool isNegative = lhs.m_isNegative ^ rhs.m_isNegative;
+  StorageVector<limbs::Limb> product(lhsLimbs.size() + rhsLimbs.size());
+  limbs::multiply(product.data(), lhsLimbs.data(), lhsLimbs.size(),
+                  rhsLimbs.data(), rhsLimbs.size(), threadLimit());
+  unpackWords(product, m_digits);
   
   // The negative sign needs to be assigned, and we need to verify that the Integer is
   // in a valid form.
-  m_isNegative = lhs.m_isNegative ^ rhs.m_isNegative;
+  m_isNegative = isNegative;
   
   makeValid();
   
@@ -341,8 +391,9 @@ Integer& Integer::setToProduct(Integer const& lhs, Integer const& rhs) {
 }
 
 Integer& Integer::operator/=(Integer const& rhs) {
+  Integer lhs(*this);
   Integer rem = Integer();
-  Integer::quotRem(Integer(*this), rhs, *this, rem);
+  Integer::quotRem(lhs, &rhs == this ? lhs : rhs, *this, rem);
   return *this;
 }
 
@@ -354,8 +405,9 @@ Integer aprn::operator/(Integer const& lhs, Integer const& rhs) {
 }
 
 Integer& Integer::operator%=(Integer const& rhs) {
+  Integer lhs(*this);
   Integer quot = Integer();
-  Integer::quotRem(Integer(*this), rhs, quot, *this);
+  Integer::quotRem(lhs, &rhs == this ? lhs : rhs, quot, *this);
   return *this;
 }
 
@@ -367,150 +419,236 @@ Integer aprn::operator%(Integer const& lhs, Integer const& rhs) {
 }
 
 bool aprn::Integer::quotRem(Integer const& lhs, Integer const& rhs, Integer& quot_out, Integer& rem_out) {
-  // Divides an integer by another integer and returns both the result and the remainder. This is a
-  // very complicated, poorly written, and slow algorithm.
-  if (lhs < rhs) {
+  // Divides an integer by another integer and returns both the result and the remainder.
+  // The quotient is truncated towards zero, so the remainder has the same sign as the
+  // dividend. The work is done on the magnitudes.
+  APRN_STATS_SCOPE(DIVIDE, CHAR_BIT * std::max(lhs.m_digits.size(), rhs.m_digits.size()));
+  if (rhs.m_digits.empty()) {
+    // Divide by zero is bad.
+    return false;
+  }
+  if (compareMagnitude(lhs, rhs) < 0) {
     // In this case, we know that the answer is 0, and so we can exit early.
-    quot_out = Integer();
     rem_out = Integer(lhs);
+    quot_out = Integer();
+    return true;
   }
   
-  int lhsSign = signum(lhs);
-  int rhsSign = signum(rhs);
-  int quotSign = lhsSign * rhsSign;
-  // The current dividend is the part of the dividend (left hand side) that we are going to
-  // try to divide into at any step. If you remember your division algorithm, you divide
-  // by only part of the dividend at a time, and work your way over right to left, which is
-  // what we will do here.
-  Integer currentDividend = Integer();
+  bool quotIsNegative = lhs.m_isNegative != rhs.m_isNegative;
+  bool remIsNegative = lhs.m_isNegative;
+  Integer lhsMagnitude(lhs);
+  Integer rhsMagnitude(rhs);
+  lhsMagnitude.m_isNegative = false;
+  rhsMagnitude.m_isNegative = false;
   
-  if (signum(rhs) == 0) {
-    // Divide by zero is bad.
-    return false;
+  Integer quot;
+  Integer rem;
+  ShiftType const limbBits = CHAR_BIT * sizeof(limbs::HalfLimb);
+  ShiftType const rhsSize = (bitLength(rhsMagnitude) + limbBits - 1) / limbBits;
+  ShiftType const quotSize = (bitLength(lhsMagnitude) + limbBits - 1) / limbBits - rhsSize;
+  std::size_t const recursiveThreshold = thresholds().recursiveDivision;
+  if (rhsSize < recursiveThreshold || quotSize < recursiveThreshold) {
+    divideGradeSchool(lhsMagnitude, rhsMagnitude, quot, rem);
   }
-  
-  quot_out.m_digits.resize(lhs.m_digits.size(), 0);
-  
-  // We will iterate from the right of the dividend to the left.
-  Integer::SizeType i = lhs.m_digits.size();
-  do {
-    --i;
-    // First we must add the next digit of the dividend onto our current dividend.
-    currentDividend.m_digits.insert(currentDividend.m_digits.begin(), lhs.m_digits[i]);
-    // The current quotient is the current dividend divided by the divisor (the right hand side).
-    Integer::Digit currentQuotient;
-    Integer::SizeType currentDividendNumDigits = currentDividend.m_digits.size();
-    Integer::SizeType rhsNumDigits = rhs.m_digits.size();
-    if (currentDividendNumDigits < rhsNumDigits) {
-      // If the current dividend just doesn't have enough digits, then the current quotient will be 0.
-      // In this case, its easy to figure out.
-      currentQuotient = 0;
-    }
-    else {
-      // Otherwise, we have a harder time. What happens here is we make a low approximation to the
-      // actual current quotient. Then we slowly increase our approximation until we get
-      // the right value. Obviously, this is a very slow and inefficient process.
-      Integer::DoubleDigit rhsEnd = rhs.m_digits.back();
-      Integer::DoubleDigit dividendEnd;
-      // Our approximation works like this: Ignore everything but the most significant digit of the
-      // divisor, and the corresponding digits in the current dividend. Try dividing those numbers,
-      // and you will have an approximation to the current quotient.
-      if (currentDividendNumDigits == rhsNumDigits) {
-        dividendEnd = currentDividend.m_digits.back();
-      }
-      else {
-        dividendEnd = currentDividend.m_digits.back() * ((Integer::DoubleDigit) Integer::MAX_DIGIT + 1);
-        dividendEnd += currentDividend.m_digits[currentDividendNumDigits - 2];
-      }
-      // To make sure its a low approximation, we actually divide by the divisor's most significant digit plus 1.
-      currentQuotient = dividendEnd / (rhsEnd + 1);
-      Integer quotientProduct = rhs * currentQuotient;
-      quotientProduct.m_isNegative = false;
-      
-      // Then we go through and do a bunch of multiplying until we get have the actual current quotient.
-      for (Integer::DoubleDigit quotient = currentQuotient + 1; quotient <= Integer::MAX_DIGIT; ++quotient) {
-        Integer nextQuotientProduct = rhs * quotient;
-        nextQuotientProduct.m_isNegative = false;
-        if (nextQuotientProduct > currentDividend) {
-          break;
-        }
-        else {
-          quotientProduct = nextQuotientProduct;
-          currentQuotient = quotient;
-        }
-      }
-      
-      // The quotient product has to be subtracted from the current dividend (this is just part
-      // of the grade school algorithm).
-      currentDividend -= quotientProduct;
+  else {
+    // The recursive division needs the top bit of the divisor to be set, so both
+    // operands are shifted up, and the remainder is shifted back down at the end.
+    ShiftType const shift = (limbBits - bitLength(rhsMagnitude) % limbBits) % limbBits;
+    lhsMagnitude <<= shift;
+    rhsMagnitude <<= shift;
+    ShiftType remainingSize = (bitLength(lhsMagnitude) + limbBits - 1) / limbBits - rhsSize;
+    // The recursion needs a quotient no longer than the divisor, so a long quotient
+    // is found a divisor's length at a time, as in the grade school algorithm.
+    while (remainingSize > rhsSize) {
+      ShiftType const lowBits = (remainingSize - rhsSize) * limbBits;
+      Integer partQuot;
+      Integer partRem;
+      divideRecursive(lhsMagnitude >> lowBits, rhsMagnitude, rhsSize, rhsSize, partQuot, partRem);
+      quot <<= rhsSize * limbBits;
+      quot += partQuot;
+      lhsMagnitude = (partRem << lowBits) + extractBits(lhsMagnitude, 0, lowBits);
+      remainingSize -= rhsSize;
     }
-    // Then we have the next digit of the result.
-    quot_out.m_digits[i] = currentQuotient;
-  } while (i != 0);
-  
-  rem_out = currentDividend;
+    Integer partQuot;
+    divideRecursive(lhsMagnitude, rhsMagnitude, rhsSize, remainingSize, partQuot, rem);
+    quot <<= remainingSize * limbBits;
+    quot += partQuot;
+    rem >>= shift;
+  }
   
   // Make sure everything has the right sign.
-  if (quotSign == -1) {
-    quot_out.negate();
-  }
-  if (lhsSign == -1) {
-    rem_out.negate();
-  }
+  quot.m_isNegative = quotIsNegative;
+  rem.m_isNegative = remIsNegative;
+  quot.makeValid();
+  rem.makeValid();
+  quot_out = quot;
+  rem_out = rem;
   
-  // Validate just to be sure.
+  return true;
+}
+
+void Integer::divideGradeSchool(Integer const& lhs, Integer const& rhs, Integer& quot_out, Integer& rem_out) {
+  // Divides the magnitude of one Integer by the magnitude of another, using the grade
+  // school algorithm on half limbs.
+  StorageVector<limbs::HalfLimb> quot;
+  StorageVector<limbs::HalfLimb> rem;
+  limbs::divide(packWords<limbs::HalfLimb>(lhs.m_digits), packWords<limbs::HalfLimb>(rhs.m_digits), quot, rem);
+  quot_out = Integer();
+  rem_out = Integer();
+  unpackWords(quot, quot_out.m_digits);
+  unpackWords(rem, rem_out.m_digits);
   quot_out.makeValid();
   rem_out.makeValid();
+}
+
+void Integer::divideRecursive(Integer const& lhs, Integer const& rhs, ShiftType rhsSize, ShiftType quotSize,
+                              Integer& quot_out, Integer& rem_out) {
+  // Divides lhs by rhs, where both are non-negative, rhs is made up of rhsSize half limbs
+  // with the top bit set, and quotSize is no more than rhsSize. This is the recursive
+  // division of Burnikel and Ziegler, as given by Brent and Zimmermann (Modern Computer
+  // Arithmetic, algorithm 1.8). The top half of the quotient is found by dividing the top
+  // of lhs by the top half of rhs, and then corrected with one large multiplication, and
+  // then the same is done for the bottom half. The multiplications are where the work is,
+  // so they are what get split between threads.
+  checkCancelled();
+  ShiftType const limbBits = CHAR_BIT * sizeof(limbs::HalfLimb);
+  // lhs is expected to be less than rhs * B^quotSize (where B is the base of the half
+  // limbs), which is the case for the recursive calls once rhs * B^quotSize has been
+  // subtracted at most once.
+  Integer top = rhs << (quotSize * limbBits);
+  if (compareMagnitude(lhs, top) >= 0) {
+    divideRecursive(lhs - top, rhs, rhsSize, quotSize, quot_out, rem_out);
+    quot_out += Integer(1) << (quotSize * limbBits);
+    return;
+  }
+  if (quotSize < thresholds().recursiveDivision) {
+    divideGradeSchool(lhs, rhs, quot_out, rem_out);
+    return;
+  }
   
-  return true;
+  ShiftType const k = quotSize / 2;
+  ShiftType const lowBits = k * limbBits;
+  Integer rhsHigh = rhs >> lowBits;
+  Integer rhsLow = extractBits(rhs, 0, lowBits);
+  
+  // The top half of the quotient. The estimate can only be too large, by a little.
+  Integer quotHigh;
+  Integer remHigh;
+  divideRecursive(lhs >> (2 * lowBits), rhsHigh, rhsSize - k, quotSize - k, quotHigh, remHigh);
+  Integer partial = (remHigh << (2 * lowBits)) + extractBits(lhs, 0, 2 * lowBits);
+  partial -= (quotHigh * rhsLow) << lowBits;
+  Integer shiftedRhs = rhs << lowBits;
+  while (partial.m_isNegative) {
+    --quotHigh;
+    partial += shiftedRhs;
+  }
+  
+  // The bottom half of the quotient, from what is left.
+  Integer quotLow;
+  Integer remLow;
+  divideRecursive(partial >> lowBits, rhsHigh, rhsSize - k, k, quotLow, remLow);
+  rem_out = (remLow << lowBits) + extractBits(partial, 0, lowBits);
+  rem_out -= quotLow * rhsLow;
+  while (rem_out.m_isNegative) {
+    --quotLow;
+    rem_out += rhs;
+  }
+  quot_out = (quotHigh << lowBits) + quotLow;
 }
 
 Integer Integer::operator~() const {
-  // To get the bitwise not, just invert every digit.
-  Integer result;
-  result.m_digits.resize(m_digits.size());
-  for (SizeType i = 0; i < m_digits.size(); ++i) {
-    result.m_digits[i] = ~m_digits[i];
-  }
-  result.m_isNegative = !m_isNegative;
+  // In two's complement, inverting every bit (including the infinitely many sign bits)
+  // is the same as negating and subtracting one.
+  Integer result(*this);
+  result.negate();
+  --result;
   return result;
 }
 
 Integer& Integer::operator&=(Integer const& rhs) {
-  // & every digit with the corresponding digit.
-  if (rhs.m_digits.size() > m_digits.size()) {
-    m_digits.resize(rhs.m_digits.size(), 0);
+  if (m_isNegative || rhs.m_isNegative) {
+    return applyBitwise(rhs, andDigit);
   }
-  for (SizeType i = 0; i < m_digits.size(); ++i) {
-    m_digits[i] &= rhs.m_digits[i];
+  // & every digit with the corresponding digit. Any digits past the end of the
+  // shorter Integer would be anded with zero, so they can be dropped.
+  m_digits.resize(std::min(m_digits.size(), rhs.m_digits.size()));
+  if (!m_digits.empty()) {
+    kernels::kernels().andDigits(m_digits.data(), rhs.m_digits.data(), m_digits.size());
   }
-  // Also "and" the signs.
-  m_isNegative = rhs.m_isNegative && m_isNegative;
   makeValid();
   return *this;
 }
 
 Integer& Integer::operator|=(Integer const& rhs) {
-  // Or is similar to and.
+  if (m_isNegative || rhs.m_isNegative) {
+    return applyBitwise(rhs, orDigit);
+  }
+  // Or is similar to and, except that digits past the end of the shorter Integer
+  // are kept.
   if (rhs.m_digits.size() > m_digits.size()) {
     m_digits.resize(rhs.m_digits.size(), 0);
   }
-  for (SizeType i = 0; i < m_digits.size(); ++i) {
-    m_digits[i] |= rhs.m_digits[i];
+  if (!rhs.m_digits.empty()) {
+    kernels::kernels().orDigits(m_digits.data(), rhs.m_digits.data(), rhs.m_digits.size());
   }
-  m_isNegative = rhs.m_isNegative || m_isNegative;
   return *this;
 }
 
 Integer& Integer::operator^=(Integer const& rhs) {
+  if (m_isNegative || rhs.m_isNegative) {
+    return applyBitwise(rhs, xorDigit);
+  }
   // Xor is similar to or.
   if (rhs.m_digits.size() > m_digits.size()) {
-    m_digits.resize(rhs.m_digits.size());
+    m_digits.resize(rhs.m_digits.size(), 0);
   }
-  for (SizeType i = 0; i < m_digits.size(); ++i) {
-    m_digits[i] ^= rhs.m_digits[i];
+  if (!rhs.m_digits.empty()) {
+    kernels::kernels().xorDigits(m_digits.data(), rhs.m_digits.data(), rhs.m_digits.size());
+  }
+  makeValid();
+  return *this;
+}
+
+Integer& Integer::applyBitwise(Integer const& rhs, Digit (*op)(Digit, Digit)) {
+  // Applies a bitwise operation to Integers that may be negative, as though they were
+  // stored in two's complement with infinitely many copies of the sign bit above the
+  // top digit. The two's complement of a magnitude (invert, then add one) is found a
+  // digit at a time, carrying the one up until it is absorbed, so a negated copy is
+  // never made. If the result is negative, it is converted back the same way. Digits
+  // are only read at the position being written, so rhs may be this Integer.
+  bool const lhsIsNegative = m_isNegative;
+  bool const rhsIsNegative = rhs.m_isNegative;
+  bool const isNegative = op(lhsIsNegative ? MAX_DIGIT : 0, rhsIsNegative ? MAX_DIGIT : 0) != 0;
+  SizeType const rhsSize = rhs.m_digits.size();
+  SizeType const numDigits = std::max(m_digits.size(), rhsSize);
+  m_digits.resize(numDigits, 0);
+  bool lhsCarry = true;
+  bool rhsCarry = true;
+  bool resultCarry = true;
+  for (SizeType i = 0; i < numDigits; ++i) {
+    Digit lhsDigit = m_digits[i];
+    Digit rhsDigit = i < rhsSize ? rhs.m_digits[i] : 0;
+    if (lhsIsNegative) {
+      lhsDigit = (Digit) (~lhsDigit + lhsCarry);
+      lhsCarry = lhsCarry && lhsDigit == 0;
+    }
+    if (rhsIsNegative) {
+      rhsDigit = (Digit) (~rhsDigit + rhsCarry);
+      rhsCarry = rhsCarry && rhsDigit == 0;
+    }
+    Digit digit = op(lhsDigit, rhsDigit);
+    if (isNegative) {
+      digit = (Digit) (~digit + resultCarry);
+      resultCarry = resultCarry && digit == 0;
+    }
+    m_digits[i] = digit;
   }
-  m_isNegative = rhs.m_isNegative ^ m_isNegative;
+  // Above the digits, the result is all sign bits. When negated, those become zero,
+  // except that the carry may still have to be added to them.
+  if (isNegative && resultCarry) {
+    m_digits.push_back(1);
+  }
+  m_isNegative = isNegative;
   makeValid();
   return *this;
 }
@@ -521,32 +659,38 @@ Integer& Integer::operator>>=(ShiftType rhs) {
 }
 
 Integer& Integer::shiftRight(ShiftType rhs, Integer& rem_out) {
+  APRN_STATS_SCOPE(SHIFT, CHAR_BIT * m_digits.size());
   // Determine how many digits and how many bits to shift by.
   ShiftType numDigits = rhs / (CHAR_BIT * sizeof(Digit));
   ShiftType numBits = rhs % (CHAR_BIT * sizeof(Digit));
-  rem_out.m_digits.resize(numDigits + (numBits != 0), 0);
+  // The remainder is made up of the digits and bits that get shifted off of the
+  // end, and keeps the sign of this Integer.
+  SizeType remDigits = std::min<ShiftType>(numDigits + (numBits != 0), m_digits.size());
+  rem_out.m_digits.assign(m_digits.begin(), m_digits.begin() + remDigits);
+  if (numBits != 0 && remDigits == numDigits + 1) {
+    rem_out.m_digits.back() &= (Digit) ((1u << numBits) - 1);
+  }
   rem_out.m_isNegative = m_isNegative;
-  for (SizeType i = 0; i < m_digits.size(); ++i) {
-    // Because a shift might only be a fraction of a digit, each digit
-    // gets split into left and right parts that get moved to adjacent
-    // digits from each other.
-    Digit digit = m_digits[i];
-    i >= numDigits ? m_digits[i - numDigits] : rem_out.m_digits[i] |=
-      (digit >> numBits);
-    i > numDigits ? m_digits[i - numDigits - 1] : rem_out.m_digits[i - 1] |=
-      (digit << (CHAR_BIT * sizeof(Digit) - numBits));
-  }
-  // Make the remainder and this Integer valid again.
-  m_digits.resize(m_digits.size() - numDigits);
-  if (m_digits.back() == 0) {
-    m_digits.pop_back();
-    if (m_digits.size() == 0) {
-      m_isNegative = false;
-    }
+  rem_out.makeValid();
+  if (numDigits >= m_digits.size()) {
+    m_digits.clear();
+    m_isNegative = false;
+    return *this;
   }
-  if (rem_out.m_digits.size() == 0) {
-    rem_out.m_isNegative = false;
+  SizeType newSize = m_digits.size() - numDigits;
+  if (numBits == 0) {
+    std::copy(m_digits.begin() + numDigits, m_digits.end(), m_digits.begin());
   }
+  else {
+    // Because a shift might only be a fraction of a digit, each new digit is
+    // made of the left part of one digit and the right part of the next one.
+    // The top digit has nothing above it, so it is done separately.
+    Digit top = (Digit) (m_digits.back() >> numBits);
+    kernels::kernels().shiftRightDigits(m_digits.data(), m_digits.data() + numDigits, newSize - 1, numBits);
+    m_digits[newSize - 1] = top;
+  }
+  m_digits.resize(newSize);
+  makeValid();
   return *this;
 }
 
@@ -555,32 +699,36 @@ Integer& Integer::operator<<=(ShiftType rhs) {
 }
 
 Integer& Integer::shiftLeft(ShiftType rhs) {
+  APRN_STATS_SCOPE(SHIFT, CHAR_BIT * m_digits.size());
   // Very similar to shifting right, except it is unnecessary to check for going
   // off of the right side of the number.
   ShiftType numDigits = rhs / (CHAR_BIT * sizeof(Digit));
   ShiftType numBits = rhs % (CHAR_BIT * sizeof(Digit));
-  m_digits.resize(m_digits.size() + numDigits + 1, 0);
-  
-  SizeType i = m_digits.size();
-  do {
-    --i;
-    Digit digit = m_digits[i];
-    m_digits[i + numDigits] |= (digit << numBits);
-    m_digits[i + numDigits + 1] |= (digit >> (CHAR_BIT * sizeof(Digit) - numBits));
-  } while (i != 0);
-  if (m_digits.back() == 0) {
-    m_digits.pop_back();
+  if (m_digits.empty()) {
+    return *this;
+  }
+  SizeType oldSize = m_digits.size();
+  if (numBits == 0) {
+    m_digits.resize(oldSize + numDigits, 0);
+    std::copy_backward(m_digits.begin(), m_digits.begin() + oldSize, m_digits.end());
   }
+  else {
+    // The kernel works from the most significant digit down, so that no digit
+    // is overwritten before it has been moved.
+    m_digits.resize(oldSize + numDigits + 1, 0);
+    kernels::kernels().shiftLeftDigits(m_digits.data() + numDigits, m_digits.data(), oldSize, numBits);
+  }
+  std::fill(m_digits.begin(), m_digits.begin() + numDigits, 0);
+  makeValid();
   return *this;
 }
 
 std::ostream& aprn::operator<<(std::ostream& os, Integer const& obj) {
-  // This is just a huge mess of conditionals depending on what flags exactly are
-  // set in the stream.
+  // The digits are found by toString, and then the flags of the stream decide the
+  // base, the prefixes, and the case of the letters. The whole thing is written in
+  // one go, so that the width of the stream applies to all of it.
   int base = 10;
   int sign = signum(obj);
-  std::string digits = os.flags() & std::ios::uppercase ?
-    "0123456789ABCDEF" : "0123456789abcdef";
   
   // Read the base from the stream.
   switch (os.flags() & std::ios::basefield) {
@@ -595,70 +743,109 @@ std::ostream& aprn::operator<<(std::ostream& os, Integer const& obj) {
     break;
   }
   
+  std::string output = sign < 0 ? "-" : (os.flags() & std::ios::showpos ? "+" : "");
   // Output the base signifiers.
   if ((os.flags() & std::ios::showbase) && sign != 0) {
     if (base == 8) {
-      os << '0';
+      output += '0';
     }
     else if (base == 16) {
-      os << "0x";
+      output += os.flags() & std::ios::uppercase ? "0X" : "0x";
     }
   }
   
-  if (sign == 0) {
-    os << '0';
-  }
-  else if ((CHAR_BIT * sizeof(Integer::Digit)) % 4 == 0 && base == 16) {
-    // In this case, it is straightforward to convert the digits to hex one at
-    // a time and put all of the hex strings together.
-    os << (sign < 0 ? "-" : (os.flags() & std::ios::showpos ? "+" : ""));
-    std::ios::fmtflags oldFlags = os.flags();
-    os.unsetf(std::ios::showbase);
-    os.unsetf(std::ios::showpos);
-    Integer::SizeType i = obj.m_digits.size();
-    do {
-      --i;
-      std::ostringstream nextDigitStream;
-      nextDigitStream.flags(os.flags());
-      nextDigitStream << std::setw(sizeof(Integer::Digit) * 2);
-      nextDigitStream << std::setfill('0');
-      nextDigitStream << +obj.m_digits[i];
-      os << nextDigitStream.str();
-    } while (i != 0);
-    os.flags(oldFlags);
-  }
-  else {
-    // Otherwise, a more complicated system has to be used.
-    std::string output = "";
-    std::string signStr = sign < 0 ? "-" : (os.flags() & std::ios::showpos ? "+" : "");
-    Integer value = sign < 0 ? -obj : obj;
-    while (true) {
-      if (value < Integer(base) && !value.m_digits.empty()) {
-        output.insert(output.begin(), digits[value.m_digits.front()]);
-        break;
-      }
-      else {
-        Integer remainder;
-        if (base % 2 == 0) {
-          Integer::ShiftType power = base == 8 ? 3 : 4;
-          value.shiftRight(power, remainder);
-        }
-        else {
-          Integer quotient;
-          Integer::quotRem(value, base, quotient, remainder);
-          value = quotient;
-        }
-        output.insert(output.begin(), digits[remainder.m_digits.empty() ? 0 : remainder.m_digits.front()]);
-      }
+  std::string digits = toString(sign < 0 ? -obj : obj, base);
+  if (os.flags() & std::ios::uppercase) {
+    for (char& digit : digits) {
+      digit = (char) std::toupper((unsigned char) digit);
     }
-    os << signStr << output;
   }
+  output += digits;
   
-  return os;
+  return os << output;
 }
 
 std::istream& aprn::operator>>(std::istream& is, Integer& obj) {
-  if (/* no valid integer */true) {
+  // The characters are read the same way as for the built in types: an optional sign,
+  // then the digits in the base given by the flags of the stream. Hexadecimal Integers
+  // may start with 0x, and if no base is set, then the prefix decides the base as it
+  // does for integer literals. The digits are then converted all at once by fromString.
+  std::istream::sentry sentry(is);
+  if (!sentry) {
+    return is;
+  }
+  std::streambuf* buffer = is.rdbuf();
+  auto peek = [&]() {
+    int c = buffer->sgetc();
+    if (c == std::char_traits<char>::eof()) {
+      is.setstate(std::ios::eofbit);
+    }
+    return c;
+  };
+  
+  int base = 0;
+  switch (is.flags() & std::ios::basefield) {
+  case std::ios::dec:
+    base = 10;
+    break;
+  case std::ios::oct:
+    base = 8;
+    break;
+  case std::ios::hex:
+    base = 16;
+    break;
+  }
+  
+  std::string digits;
+  int c = peek();
+  if (c == '-' || c == '+') {
+    digits.push_back((char) c);
+    buffer->sbumpc();
+    c = peek();
+  }
+  bool hasDigits = false;
+  if ((base == 0 || base == 16) && c == '0') {
+    // The zero is kept, since it is a valid digit when no x follows it.
+    digits.push_back('0');
+    hasDigits = true;
+    buffer->sbumpc();
+    c = peek();
+    if (c == 'x' || c == 'X') {
+      base = 16;
+      hasDigits = false;
+      buffer->sbumpc();
+      c = peek();
+    }
+    else if (base == 0) {
+      base = 8;
+    }
+  }
+  if (base == 0) {
+    base = 10;
+  }
+  
+  while (c != std::char_traits<char>::eof()) {
+    int value = base;
+    if (c >= '0' && c <= '9') {
+      value = c - '0';
+    }
+    else if (c >= 'a' && c <= 'z') {
+      value = c - 'a' + 10;
+    }
+    else if (c >= 'A' && c <= 'Z') {
+      value = c - 'A' + 10;
+    }
+    if (value >= base) {
+      break;
+    }
+    digits.push_back((char) c);
+    hasDigits = true;
+    buffer->sbumpc();
+    c = peek();
+  }
+  
+  if (!hasDigits || !fromString(digits, base, obj)) {
+    obj = Integer();
     is.setstate(std::ios::failbit);
   }
   return is;
@@ -0,0 +1,202 @@
+#include "../include/integer_array.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <vector>
+
+#include "../include/math_integer.h"
+
+using namespace aprn;
+
+namespace {
+
+  // A type that can hold the product of two limbs, plus a carry.
+  using DoubleLimb = std::uint64_t;
+
+  std::size_t const LIMB_BITS = CHAR_BIT * sizeof(IntegerArray::Limb);
+
+}
+
+IntegerArray::IntegerArray(std::size_t size, unsigned long long bits) :
+  m_limbs(),
+  m_size(size),
+  m_limbCount((bits + LIMB_BITS - 1) / LIMB_BITS),
+  m_bits(bits) {
+  m_limbs.resize(m_size * m_limbCount, 0);
+}
+
+IntegerArray::IntegerArray(std::vector<Integer> const& values, unsigned long long bits) :
+  IntegerArray(values.size(), bits) {
+  for (std::size_t i = 0; i < values.size(); ++i) {
+    set(i, values[i]);
+  }
+}
+
+Integer IntegerArray::get(std::size_t index) const {
+  // The limbs are split directly into the digits of the Integer.
+  static_assert(sizeof(Limb) % sizeof(Integer::Digit) == 0,
+                "Limbs must be made up of whole digits");
+  std::size_t const digitsPerLimb = sizeof(Limb) / sizeof(Integer::Digit);
+  std::size_t const digitBits = CHAR_BIT * sizeof(Integer::Digit);
+  Integer result;
+  result.m_digits.resize(m_limbCount * digitsPerLimb);
+  for (std::size_t j = 0; j < m_limbCount; ++j) {
+    Limb limb = m_limbs[j * m_size + index];
+    for (std::size_t k = 0; k < digitsPerLimb; ++k) {
+      result.m_digits[j * digitsPerLimb + k] = (Integer::Digit) (limb >> (digitBits * k));
+    }
+  }
+  result.makeValid();
+  return result;
+}
+
+void IntegerArray::set(std::size_t index, Integer const& val) {
+  // The digits of the magnitude are packed into the limbs, and then the limbs
+  // are negated (invert and add one) if the Integer is negative.
+  std::size_t const digitsPerLimb = sizeof(Limb) / sizeof(Integer::Digit);
+  std::size_t const digitBits = CHAR_BIT * sizeof(Integer::Digit);
+  for (std::size_t j = 0; j < m_limbCount; ++j) {
+    Limb limb = 0;
+    for (std::size_t k = 0; k < digitsPerLimb; ++k) {
+      Integer::SizeType digit = j * digitsPerLimb + k;
+      if (digit < val.m_digits.size()) {
+        limb |= (Limb) val.m_digits[digit] << (digitBits * k);
+      }
+    }
+    m_limbs[j * m_size + index] = limb;
+  }
+  if (val.m_isNegative) {
+    bool hasCarry = true;
+    for (std::size_t j = 0; j < m_limbCount; ++j) {
+      Limb& limb = m_limbs[j * m_size + index];
+      limb = ~limb + hasCarry;
+      hasCarry = hasCarry && limb == 0;
+    }
+  }
+  if (m_bits % LIMB_BITS != 0) {
+    m_limbs[(m_limbCount - 1) * m_size + index] &= ((Limb) 1 << (m_bits % LIMB_BITS)) - 1;
+  }
+}
+
+std::vector<Integer> IntegerArray::toIntegers() const {
+  std::vector<Integer> result;
+  result.reserve(m_size);
+  for (std::size_t i = 0; i < m_size; ++i) {
+    result.push_back(get(i));
+  }
+  return result;
+}
+
+bool IntegerArray::matches(IntegerArray const& rhs) const {
+  // Element-wise operations only make sense between arrays of the same shape.
+  return m_size == rhs.m_size && m_bits == rhs.m_bits;
+}
+
+void IntegerArray::wrap() {
+  // Clears the bits of the top limb of each element that are beyond the width.
+  if (m_bits % LIMB_BITS == 0 || m_size == 0) {
+    return;
+  }
+  Limb const mask = ((Limb) 1 << (m_bits % LIMB_BITS)) - 1;
+  Limb* top = &m_limbs[(m_limbCount - 1) * m_size];
+  for (std::size_t i = 0; i < m_size; ++i) {
+    top[i] &= mask;
+  }
+}
+
+bool IntegerArray::add(IntegerArray const& rhs) {
+  // The grade school addition algorithm, run on every element side by side. The
+  // inner loop has no dependencies between iterations, so it can be vectorized.
+  if (!matches(rhs)) {
+    return false;
+  }
+  std::vector<Limb> carries(m_size, 0);
+  for (std::size_t j = 0; j < m_limbCount; ++j) {
+    Limb* lhsLimbs = &m_limbs[j * m_size];
+    Limb const* rhsLimbs = &rhs.m_limbs[j * m_size];
+    for (std::size_t i = 0; i < m_size; ++i) {
+      DoubleLimb sum = (DoubleLimb) lhsLimbs[i] + rhsLimbs[i] + carries[i];
+      lhsLimbs[i] = (Limb) sum;
+      carries[i] = (Limb) (sum >> LIMB_BITS);
+    }
+  }
+  wrap();
+  return true;
+}
+
+bool IntegerArray::sub(IntegerArray const& rhs) {
+  // Like addition, except that a borrow shows up as the high half of the
+  // difference wrapping around to all ones.
+  if (!matches(rhs)) {
+    return false;
+  }
+  std::vector<Limb> borrows(m_size, 0);
+  for (std::size_t j = 0; j < m_limbCount; ++j) {
+    Limb* lhsLimbs = &m_limbs[j * m_size];
+    Limb const* rhsLimbs = &rhs.m_limbs[j * m_size];
+    for (std::size_t i = 0; i < m_size; ++i) {
+      DoubleLimb difference = (DoubleLimb) lhsLimbs[i] - rhsLimbs[i] - borrows[i];
+      lhsLimbs[i] = (Limb) difference;
+      borrows[i] = (Limb) (difference >> LIMB_BITS) & 1;
+    }
+  }
+  wrap();
+  return true;
+}
+
+void IntegerArray::mulScalar(Limb factor) {
+  // The product of two limbs plus a carry always fits in a double limb.
+  std::vector<Limb> carries(m_size, 0);
+  for (std::size_t j = 0; j < m_limbCount; ++j) {
+    Limb* limbs = &m_limbs[j * m_size];
+    for (std::size_t i = 0; i < m_size; ++i) {
+      DoubleLimb product = (DoubleLimb) limbs[i] * factor + carries[i];
+      limbs[i] = (Limb) product;
+      carries[i] = (Limb) (product >> LIMB_BITS);
+    }
+  }
+  wrap();
+}
+
+std::vector<int> IntegerArray::compare(IntegerArray const& rhs) const {
+  // Work down from the most significant limbs. The first limb that differs
+  // decides the result for that element, and later limbs are ignored.
+  std::vector<int> result;
+  if (!matches(rhs)) {
+    return result;
+  }
+  result.resize(m_size, 0);
+  for (std::size_t j = m_limbCount; j != 0; --j) {
+    Limb const* lhsLimbs = &m_limbs[(j - 1) * m_size];
+    Limb const* rhsLimbs = &rhs.m_limbs[(j - 1) * m_size];
+    for (std::size_t i = 0; i < m_size; ++i) {
+      int limbCompare = (lhsLimbs[i] > rhsLimbs[i]) - (lhsLimbs[i] < rhsLimbs[i]);
+      result[i] = result[i] != 0 ? result[i] : limbCompare;
+    }
+  }
+  return result;
+}
+
+Integer IntegerArray::sum() const {
+  // Each limb position is summed across all of the elements into a double limb,
+  // and then the column sums are combined with their place values. A double
+  // limb can hold the sum of up to 2^LIMB_BITS limbs, so larger arrays are summed
+  // in blocks of that many elements.
+  DoubleLimb const blockSize = ((DoubleLimb) 1 << LIMB_BITS) - 1;
+  Integer result;
+  for (std::size_t j = 0; j < m_limbCount; ++j) {
+    Limb const* limbs = &m_limbs[j * m_size];
+    Integer column;
+    for (std::size_t first = 0; first < m_size; first += blockSize) {
+      std::size_t last = (std::size_t) std::min<DoubleLimb>(m_size, first + blockSize);
+      DoubleLimb blockSum = 0;
+      for (std::size_t i = first; i < last; ++i) {
+        blockSum += limbs[i];
+      }
+      column += Integer((unsigned long long) blockSum);
+    }
+    result += column << (j * LIMB_BITS);
+  }
+  return result;
+}
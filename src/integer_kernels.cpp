@@ -0,0 +1,746 @@
+#include "integer_kernels.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "../include/cpu_dispatch.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define APRN_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+using namespace aprn;
+using namespace aprn::kernels;
+
+bool isBigEndian();
+
+namespace {
+
+  // Generic Kernels
+  // ---------------
+  //   These work one digit at a time, and so they work on any processor with
+  // any byte order.
+
+  void andDigitsGeneric(Digit* lhs, Digit const* rhs, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+      lhs[i] &= rhs[i];
+    }
+  }
+
+  void orDigitsGeneric(Digit* lhs, Digit const* rhs, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+      lhs[i] |= rhs[i];
+    }
+  }
+
+  void xorDigitsGeneric(Digit* lhs, Digit const* rhs, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+      lhs[i] ^= rhs[i];
+    }
+  }
+
+  void notDigitsGeneric(Digit* out, Digit const* in, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+      out[i] = (Digit) ~in[i];
+    }
+  }
+
+  void shiftLeftDigitsGeneric(Digit* out, Digit const* in, std::size_t n, unsigned bits) {
+    // Work from the top down, so that the output can overlap the input.
+    out[n] = (Digit) (in[n - 1] >> (8 - bits));
+    for (std::size_t i = n - 1; i != 0; --i) {
+      out[i] = (Digit) ((in[i] << bits) | (in[i - 1] >> (8 - bits)));
+    }
+    out[0] = (Digit) (in[0] << bits);
+  }
+
+  void shiftRightDigitsGeneric(Digit* out, Digit const* in, std::size_t n, unsigned bits) {
+    for (std::size_t i = 0; i < n; ++i) {
+      out[i] = (Digit) ((in[i] >> bits) | (in[i + 1] << (8 - bits)));
+    }
+  }
+
+  int compareDigitsGeneric(Digit const* lhs, Digit const* rhs, std::size_t n) {
+    for (std::size_t i = n; i != 0; --i) {
+      if (lhs[i - 1] != rhs[i - 1]) {
+        return lhs[i - 1] > rhs[i - 1] ? 1 : -1;
+      }
+    }
+    return 0;
+  }
+
+  bool addDigitsGeneric(Digit* lhs, Digit const* rhs, std::size_t n) {
+    unsigned carry = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+      unsigned sum = (unsigned) lhs[i] + rhs[i] + carry;
+      lhs[i] = (Digit) sum;
+      carry = sum >> 8;
+    }
+    return carry != 0;
+  }
+
+  bool subDigitsGeneric(Digit* lhs, Digit const* rhs, std::size_t n) {
+    unsigned borrow = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+      unsigned difference = (unsigned) lhs[i] - rhs[i] - borrow;
+      lhs[i] = (Digit) difference;
+      borrow = (difference >> 8) & 1;
+    }
+    return borrow != 0;
+  }
+
+  Limb mulAddLimbsGeneric(Limb* out, Limb const* in, std::size_t n, Limb factor) {
+    // Without a type twice as wide as a limb, each limb is split into halves,
+    // and the four products of the halves are put back together by hand. The
+    // full sum of in[i] * factor + out[i] + carry always fits in two limbs.
+    Limb const MASK = 0xFFFFFFFF;
+    Limb const factorLow = factor & MASK;
+    Limb const factorHigh = factor >> 32;
+    Limb carry = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+      Limb inLow = in[i] & MASK;
+      Limb inHigh = in[i] >> 32;
+      Limb lowLow = inLow * factorLow;
+      Limb lowHigh = inLow * factorHigh;
+      Limb highLow = inHigh * factorLow;
+      Limb middle = (lowLow >> 32) + (lowHigh & MASK) + (highLow & MASK);
+      Limb low = (lowLow & MASK) | (middle << 32);
+      Limb high = inHigh * factorHigh + (lowHigh >> 32) + (highLow >> 32) + (middle >> 32);
+      low += out[i];
+      high += low < out[i];
+      low += carry;
+      high += low < carry;
+      out[i] = low;
+      carry = high;
+    }
+    return carry;
+  }
+
+  bool isAlwaysSupported() {
+    return true;
+  }
+
+  KernelTable const GENERIC_KERNELS = {
+    andDigitsGeneric,
+    orDigitsGeneric,
+    xorDigitsGeneric,
+    notDigitsGeneric,
+    shiftLeftDigitsGeneric,
+    shiftRightDigitsGeneric,
+    compareDigitsGeneric,
+    addDigitsGeneric,
+    subDigitsGeneric,
+    mulAddLimbsGeneric,
+    "generic",
+    isAlwaysSupported
+  };
+
+  // Word Kernels
+  // ------------
+  //   These treat each run of eight digits as a single 64 bit word. On a little
+  // endian processor, the digits of an Integer are laid out in memory exactly
+  // as the bytes of a word would be, so a word can be loaded straight from
+  // the digits and treated as a number. The ends that don't fill a whole word
+  // are handled by the generic kernels.
+
+  using Word = std::uint64_t;
+  std::size_t const WORD_DIGITS = sizeof(Word);
+
+  inline Word loadWord(Digit const* digits) {
+    Word result;
+    std::memcpy(&result, digits, sizeof(Word));
+    return result;
+  }
+
+  inline void storeWord(Digit* digits, Word word) {
+    std::memcpy(digits, &word, sizeof(Word));
+  }
+
+  void andDigitsWord(Digit* lhs, Digit const* rhs, std::size_t n) {
+    std::size_t i = 0;
+    for (; i + WORD_DIGITS <= n; i += WORD_DIGITS) {
+      storeWord(lhs + i, loadWord(lhs + i) & loadWord(rhs + i));
+    }
+    andDigitsGeneric(lhs + i, rhs + i, n - i);
+  }
+
+  void orDigitsWord(Digit* lhs, Digit const* rhs, std::size_t n) {
+    std::size_t i = 0;
+    for (; i + WORD_DIGITS <= n; i += WORD_DIGITS) {
+      storeWord(lhs + i, loadWord(lhs + i) | loadWord(rhs + i));
+    }
+    orDigitsGeneric(lhs + i, rhs + i, n - i);
+  }
+
+  void xorDigitsWord(Digit* lhs, Digit const* rhs, std::size_t n) {
+    std::size_t i = 0;
+    for (; i + WORD_DIGITS <= n; i += WORD_DIGITS) {
+      storeWord(lhs + i, loadWord(lhs + i) ^ loadWord(rhs + i));
+    }
+    xorDigitsGeneric(lhs + i, rhs + i, n - i);
+  }
+
+  void notDigitsWord(Digit* out, Digit const* in, std::size_t n) {
+    std::size_t i = 0;
+    for (; i + WORD_DIGITS <= n; i += WORD_DIGITS) {
+      storeWord(out + i, ~loadWord(in + i));
+    }
+    notDigitsGeneric(out + i, in + i, n - i);
+  }
+
+  // Finishes a left shift in which the digits from out[i] upwards have already
+  // been written. Since the shift works from the top down, none of the digits
+  // of the input below in[i] have been overwritten yet.
+  void shiftLeftTailWord(Digit* out, Digit const* in, std::size_t i, unsigned bits) {
+    // Each word of output is a word of input shifted left, with the top bits of
+    // the digit below the word shifted in at the bottom.
+    for (; i >= WORD_DIGITS + 1; i -= WORD_DIGITS) {
+      Word word = loadWord(in + i - WORD_DIGITS);
+      Word below = in[i - WORD_DIGITS - 1];
+      storeWord(out + i - WORD_DIGITS, (word << bits) | (below >> (8 - bits)));
+    }
+    for (; i > 1; --i) {
+      out[i - 1] = (Digit) ((in[i - 1] << bits) | (in[i - 2] >> (8 - bits)));
+    }
+    out[0] = (Digit) (in[0] << bits);
+  }
+
+  void shiftLeftDigitsWord(Digit* out, Digit const* in, std::size_t n, unsigned bits) {
+    out[n] = (Digit) (in[n - 1] >> (8 - bits));
+    shiftLeftTailWord(out, in, n, bits);
+  }
+
+  void shiftRightDigitsWord(Digit* out, Digit const* in, std::size_t n, unsigned bits) {
+    // Each word of output is a word of input shifted right, with the bottom
+    // bits of the digit above the word shifted in at the top.
+    std::size_t i = 0;
+    for (; i + WORD_DIGITS <= n; i += WORD_DIGITS) {
+      Word word = loadWord(in + i);
+      Word above = in[i + WORD_DIGITS];
+      storeWord(out + i, (word >> bits) | (above << (64 - bits)));
+    }
+    shiftRightDigitsGeneric(out + i, in + i, n - i, bits);
+  }
+
+  int compareDigitsWord(Digit const* lhs, Digit const* rhs, std::size_t n) {
+    // Words compare the same way as the digits in them, so the first word that
+    // differs decides the comparison.
+    std::size_t i = n;
+    for (; i >= WORD_DIGITS; i -= WORD_DIGITS) {
+      Word lhsWord = loadWord(lhs + i - WORD_DIGITS);
+      Word rhsWord = loadWord(rhs + i - WORD_DIGITS);
+      if (lhsWord != rhsWord) {
+        return lhsWord > rhsWord ? 1 : -1;
+      }
+    }
+    return compareDigitsGeneric(lhs, rhs, i);
+  }
+
+  // Finishes an addition in which the digits below i have already been added,
+  // by feeding the carry into the generic kernel by hand.
+  bool addTailWord(Digit* lhs, Digit const* rhs, std::size_t i, std::size_t n, bool carry) {
+    for (; i < n && carry; ++i) {
+      unsigned digitSum = (unsigned) lhs[i] + rhs[i] + 1;
+      lhs[i] = (Digit) digitSum;
+      carry = (digitSum >> 8) != 0;
+    }
+    return addDigitsGeneric(lhs + i, rhs + i, n - i) || carry;
+  }
+
+  // The same as addTailWord, but for subtraction.
+  bool subTailWord(Digit* lhs, Digit const* rhs, std::size_t i, std::size_t n, bool borrow) {
+    for (; i < n && borrow; ++i) {
+      unsigned difference = (unsigned) lhs[i] - rhs[i] - 1;
+      lhs[i] = (Digit) difference;
+      borrow = ((difference >> 8) & 1) != 0;
+    }
+    return subDigitsGeneric(lhs + i, rhs + i, n - i) || borrow;
+  }
+
+  bool addDigitsWord(Digit* lhs, Digit const* rhs, std::size_t n) {
+    Word carry = 0;
+    std::size_t i = 0;
+    for (; i + WORD_DIGITS <= n; i += WORD_DIGITS) {
+      Word lhsWord = loadWord(lhs + i);
+      Word sum = lhsWord + loadWord(rhs + i);
+      Word firstCarry = sum < lhsWord;
+      sum += carry;
+      carry = firstCarry | (sum < carry);
+      storeWord(lhs + i, sum);
+    }
+    return addTailWord(lhs, rhs, i, n, carry != 0);
+  }
+
+  bool subDigitsWord(Digit* lhs, Digit const* rhs, std::size_t n) {
+    Word borrow = 0;
+    std::size_t i = 0;
+    for (; i + WORD_DIGITS <= n; i += WORD_DIGITS) {
+      Word lhsWord = loadWord(lhs + i);
+      Word rhsWord = loadWord(rhs + i);
+      Word difference = lhsWord - rhsWord;
+      Word firstBorrow = lhsWord < rhsWord;
+      storeWord(lhs + i, difference - borrow);
+      borrow = firstBorrow | (difference < borrow);
+    }
+    return subTailWord(lhs, rhs, i, n, borrow != 0);
+  }
+
+#ifdef __SIZEOF_INT128__
+  Limb mulAddLimbsWord(Limb* out, Limb const* in, std::size_t n, Limb factor) {
+    // The compiler turns the double width product into a single instruction
+    // on processors that have one.
+    Limb carry = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+      unsigned __int128 product = (unsigned __int128) in[i] * factor + out[i] + carry;
+      out[i] = (Limb) product;
+      carry = (Limb) (product >> 64);
+    }
+    return carry;
+  }
+#else
+  Limb mulAddLimbsWord(Limb* out, Limb const* in, std::size_t n, Limb factor) {
+    return mulAddLimbsGeneric(out, in, n, factor);
+  }
+#endif
+
+  bool isLittleEndian() {
+    return !isBigEndian();
+  }
+
+  KernelTable const WORD_KERNELS = {
+    andDigitsWord,
+    orDigitsWord,
+    xorDigitsWord,
+    notDigitsWord,
+    shiftLeftDigitsWord,
+    shiftRightDigitsWord,
+    compareDigitsWord,
+    addDigitsWord,
+    subDigitsWord,
+    mulAddLimbsWord,
+    "word",
+    isLittleEndian
+  };
+
+#ifdef APRN_X86_KERNELS
+
+  // ADX Kernels
+  // -----------
+  //   These use the add with carry instructions for the carry chains, and mulx
+  // (from BMI2) for the products, which leaves the flags alone so that the
+  // two carry chains of a multiply row can run side by side. The bitwise
+  // kernels are the same as the word kernels.
+
+  __attribute__((target("adx")))
+  bool addDigitsAdx(Digit* lhs, Digit const* rhs, std::size_t n) {
+    unsigned char carry = 0;
+    std::size_t i = 0;
+    for (; i + WORD_DIGITS <= n; i += WORD_DIGITS) {
+      unsigned long long sum;
+      carry = _addcarryx_u64(carry, loadWord(lhs + i), loadWord(rhs + i), &sum);
+      storeWord(lhs + i, sum);
+    }
+    return addTailWord(lhs, rhs, i, n, carry != 0);
+  }
+
+  bool subDigitsAdx(Digit* lhs, Digit const* rhs, std::size_t n) {
+    unsigned char borrow = 0;
+    std::size_t i = 0;
+    for (; i + WORD_DIGITS <= n; i += WORD_DIGITS) {
+      unsigned long long difference;
+      borrow = _subborrow_u64(borrow, loadWord(lhs + i), loadWord(rhs + i), &difference);
+      storeWord(lhs + i, difference);
+    }
+    return subTailWord(lhs, rhs, i, n, borrow != 0);
+  }
+
+  __attribute__((target("bmi2,adx")))
+  Limb mulAddLimbsAdx(Limb* out, Limb const* in, std::size_t n, Limb factor) {
+    // One chain adds the high half of each product to the low half of the
+    // next, and the other adds the result into the output.
+    unsigned char productCarry = 0;
+    unsigned char outCarry = 0;
+    unsigned long long high = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+      unsigned long long nextHigh;
+      unsigned long long low = _mulx_u64(in[i], factor, &nextHigh);
+      unsigned long long sum;
+      unsigned long long result;
+      productCarry = _addcarryx_u64(productCarry, low, high, &sum);
+      outCarry = _addcarryx_u64(outCarry, out[i], sum, &result);
+      out[i] = result;
+      high = nextHigh;
+    }
+    // The full result fits in n + 1 limbs, so this can't overflow.
+    return high + productCarry + outCarry;
+  }
+
+  bool isAdxSupported() {
+    CpuFeatures const& features = cpuFeatures();
+    return features.adx && features.bmi2;
+  }
+
+  KernelTable const ADX_KERNELS = {
+    andDigitsWord,
+    orDigitsWord,
+    xorDigitsWord,
+    notDigitsWord,
+    shiftLeftDigitsWord,
+    shiftRightDigitsWord,
+    compareDigitsWord,
+    addDigitsAdx,
+    subDigitsAdx,
+    mulAddLimbsAdx,
+    "adx",
+    isAdxSupported
+  };
+
+  // AVX2 Kernels
+  // ------------
+  //   These work on 32 digits at a time. The shifts are done on 64 bit lanes,
+  // with the digit that has to be carried into each lane loaded separately.
+  // Addition doesn't vectorize, since the carries have to travel the whole
+  // length of the Integer, so the word kernel is used for it instead.
+
+  std::size_t const AVX2_DIGITS = 32;
+
+  __attribute__((target("avx2")))
+  void andDigitsAvx2(Digit* lhs, Digit const* rhs, std::size_t n) {
+    std::size_t i = 0;
+    for (; i + AVX2_DIGITS <= n; i += AVX2_DIGITS) {
+      __m256i a = _mm256_loadu_si256((__m256i const*) (lhs + i));
+      __m256i b = _mm256_loadu_si256((__m256i const*) (rhs + i));
+      _mm256_storeu_si256((__m256i*) (lhs + i), _mm256_and_si256(a, b));
+    }
+    andDigitsWord(lhs + i, rhs + i, n - i);
+  }
+
+  __attribute__((target("avx2")))
+  void orDigitsAvx2(Digit* lhs, Digit const* rhs, std::size_t n) {
+    std::size_t i = 0;
+    for (; i + AVX2_DIGITS <= n; i += AVX2_DIGITS) {
+      __m256i a = _mm256_loadu_si256((__m256i const*) (lhs + i));
+      __m256i b = _mm256_loadu_si256((__m256i const*) (rhs + i));
+      _mm256_storeu_si256((__m256i*) (lhs + i), _mm256_or_si256(a, b));
+    }
+    orDigitsWord(lhs + i, rhs + i, n - i);
+  }
+
+  __attribute__((target("avx2")))
+  void xorDigitsAvx2(Digit* lhs, Digit const* rhs, std::size_t n) {
+    std::size_t i = 0;
+    for (; i + AVX2_DIGITS <= n; i += AVX2_DIGITS) {
+      __m256i a = _mm256_loadu_si256((__m256i const*) (lhs + i));
+      __m256i b = _mm256_loadu_si256((__m256i const*) (rhs + i));
+      _mm256_storeu_si256((__m256i*) (lhs + i), _mm256_xor_si256(a, b));
+    }
+    xorDigitsWord(lhs + i, rhs + i, n - i);
+  }
+
+  __attribute__((target("avx2")))
+  void notDigitsAvx2(Digit* out, Digit const* in, std::size_t n) {
+    __m256i const ones = _mm256_set1_epi8(-1);
+    std::size_t i = 0;
+    for (; i + AVX2_DIGITS <= n; i += AVX2_DIGITS) {
+      __m256i a = _mm256_loadu_si256((__m256i const*) (in + i));
+      _mm256_storeu_si256((__m256i*) (out + i), _mm256_xor_si256(a, ones));
+    }
+    notDigitsWord(out + i, in + i, n - i);
+  }
+
+  __attribute__((target("avx2")))
+  void shiftLeftTailAvx2(Digit* out, Digit const* in, std::size_t i, unsigned bits) {
+    // The digit below each lane is the bottom digit of the lane loaded one digit
+    // further down, which is moved to the top of its lane and then shifted
+    // down into place.
+    for (; i >= AVX2_DIGITS + 1; i -= AVX2_DIGITS) {
+      __m256i lanes = _mm256_loadu_si256((__m256i const*) (in + i - AVX2_DIGITS));
+      __m256i below = _mm256_loadu_si256((__m256i const*) (in + i - AVX2_DIGITS - 1));
+      below = _mm256_srli_epi64(_mm256_slli_epi64(below, 56), 64 - bits);
+      lanes = _mm256_or_si256(_mm256_slli_epi64(lanes, bits), below);
+      _mm256_storeu_si256((__m256i*) (out + i - AVX2_DIGITS), lanes);
+    }
+    shiftLeftTailWord(out, in, i, bits);
+  }
+
+  __attribute__((target("avx2")))
+  void shiftLeftDigitsAvx2(Digit* out, Digit const* in, std::size_t n, unsigned bits) {
+    out[n] = (Digit) (in[n - 1] >> (8 - bits));
+    shiftLeftTailAvx2(out, in, n, bits);
+  }
+
+  __attribute__((target("avx2")))
+  void shiftRightDigitsAvx2(Digit* out, Digit const* in, std::size_t n, unsigned bits) {
+    // The digit above each lane is the top digit of the lane loaded one digit
+    // further up, which is moved to the bottom of its lane and then shifted up
+    // into place.
+    std::size_t i = 0;
+    for (; i + AVX2_DIGITS <= n; i += AVX2_DIGITS) {
+      __m256i lanes = _mm256_loadu_si256((__m256i const*) (in + i));
+      __m256i above = _mm256_loadu_si256((__m256i const*) (in + i + 1));
+      above = _mm256_slli_epi64(_mm256_srli_epi64(above, 56), 64 - bits);
+      lanes = _mm256_or_si256(_mm256_srli_epi64(lanes, bits), above);
+      _mm256_storeu_si256((__m256i*) (out + i), lanes);
+    }
+    shiftRightDigitsWord(out + i, in + i, n - i, bits);
+  }
+
+  __attribute__((target("avx2")))
+  int compareDigitsAvx2(Digit const* lhs, Digit const* rhs, std::size_t n) {
+    // Equal blocks are skipped over with a single comparison, and then the most
+    // significant digit that differs is found from the mask of equal digits.
+    std::size_t i = n;
+    for (; i >= AVX2_DIGITS; i -= AVX2_DIGITS) {
+      __m256i a = _mm256_loadu_si256((__m256i const*) (lhs + i - AVX2_DIGITS));
+      __m256i b = _mm256_loadu_si256((__m256i const*) (rhs + i - AVX2_DIGITS));
+      unsigned different = ~(unsigned) _mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b));
+      if (different != 0) {
+        std::size_t index = i - AVX2_DIGITS + (31 - __builtin_clz(different));
+        return lhs[index] > rhs[index] ? 1 : -1;
+      }
+    }
+    return compareDigitsWord(lhs, rhs, i);
+  }
+
+  bool isAvx2Supported() {
+    return cpuFeatures().avx2;
+  }
+
+  bool isAvx2AdxSupported() {
+    return isAvx2Supported() && isAdxSupported();
+  }
+
+  KernelTable const AVX2_KERNELS = {
+    andDigitsAvx2,
+    orDigitsAvx2,
+    xorDigitsAvx2,
+    notDigitsAvx2,
+    shiftLeftDigitsAvx2,
+    shiftRightDigitsAvx2,
+    compareDigitsAvx2,
+    addDigitsWord,
+    subDigitsWord,
+    mulAddLimbsWord,
+    "avx2",
+    isAvx2Supported
+  };
+
+  KernelTable const AVX2_ADX_KERNELS = {
+    andDigitsAvx2,
+    orDigitsAvx2,
+    xorDigitsAvx2,
+    notDigitsAvx2,
+    shiftLeftDigitsAvx2,
+    shiftRightDigitsAvx2,
+    compareDigitsAvx2,
+    addDigitsAdx,
+    subDigitsAdx,
+    mulAddLimbsAdx,
+    "avx2+adx",
+    isAvx2AdxSupported
+  };
+
+  // AVX-512 Kernels
+  // ---------------
+  //   These are the same as the AVX2 kernels, but on 64 digits at a time.
+
+  std::size_t const AVX512_DIGITS = 64;
+
+  __attribute__((target("avx512f")))
+  void andDigitsAvx512(Digit* lhs, Digit const* rhs, std::size_t n) {
+    std::size_t i = 0;
+    for (; i + AVX512_DIGITS <= n; i += AVX512_DIGITS) {
+      __m512i a = _mm512_loadu_si512(lhs + i);
+      __m512i b = _mm512_loadu_si512(rhs + i);
+      _mm512_storeu_si512(lhs + i, _mm512_and_si512(a, b));
+    }
+    andDigitsAvx2(lhs + i, rhs + i, n - i);
+  }
+
+  __attribute__((target("avx512f")))
+  void orDigitsAvx512(Digit* lhs, Digit const* rhs, std::size_t n) {
+    std::size_t i = 0;
+    for (; i + AVX512_DIGITS <= n; i += AVX512_DIGITS) {
+      __m512i a = _mm512_loadu_si512(lhs + i);
+      __m512i b = _mm512_loadu_si512(rhs + i);
+      _mm512_storeu_si512(lhs + i, _mm512_or_si512(a, b));
+    }
+    orDigitsAvx2(lhs + i, rhs + i, n - i);
+  }
+
+  __attribute__((target("avx512f")))
+  void xorDigitsAvx512(Digit* lhs, Digit const* rhs, std::size_t n) {
+    std::size_t i = 0;
+    for (; i + AVX512_DIGITS <= n; i += AVX512_DIGITS) {
+      __m512i a = _mm512_loadu_si512(lhs + i);
+      __m512i b = _mm512_loadu_si512(rhs + i);
+      _mm512_storeu_si512(lhs + i, _mm512_xor_si512(a, b));
+    }
+    xorDigitsAvx2(lhs + i, rhs + i, n - i);
+  }
+
+  __attribute__((target("avx512f")))
+  void notDigitsAvx512(Digit* out, Digit const* in, std::size_t n) {
+    __m512i const ones = _mm512_set1_epi32(-1);
+    std::size_t i = 0;
+    for (; i + AVX512_DIGITS <= n; i += AVX512_DIGITS) {
+      __m512i a = _mm512_loadu_si512(in + i);
+      _mm512_storeu_si512(out + i, _mm512_xor_si512(a, ones));
+    }
+    notDigitsAvx2(out + i, in + i, n - i);
+  }
+
+  // The 512 bit shift intrinsics in the headers of GCC 12 pass an undefined
+  // vector as the merge source, which it then reports as maybe uninitialized
+  // when the count is not a constant. The warning is spurious, since every lane
+  // is written, so it is only turned off for the shifts.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+  __attribute__((target("avx512f")))
+  void shiftLeftDigitsAvx512(Digit* out, Digit const* in, std::size_t n, unsigned bits) {
+    std::size_t i = n;
+    out[n] = (Digit) (in[n - 1] >> (8 - bits));
+    for (; i >= AVX512_DIGITS + 1; i -= AVX512_DIGITS) {
+      __m512i lanes = _mm512_loadu_si512(in + i - AVX512_DIGITS);
+      __m512i below = _mm512_loadu_si512(in + i - AVX512_DIGITS - 1);
+      below = _mm512_srli_epi64(_mm512_slli_epi64(below, 56), 64 - bits);
+      lanes = _mm512_or_si512(_mm512_slli_epi64(lanes, bits), below);
+      _mm512_storeu_si512(out + i - AVX512_DIGITS, lanes);
+    }
+    shiftLeftTailAvx2(out, in, i, bits);
+  }
+
+  __attribute__((target("avx512f")))
+  void shiftRightDigitsAvx512(Digit* out, Digit const* in, std::size_t n, unsigned bits) {
+    std::size_t i = 0;
+    for (; i + AVX512_DIGITS <= n; i += AVX512_DIGITS) {
+      __m512i lanes = _mm512_loadu_si512(in + i);
+      __m512i above = _mm512_loadu_si512(in + i + 1);
+      above = _mm512_slli_epi64(_mm512_srli_epi64(above, 56), 64 - bits);
+      lanes = _mm512_or_si512(_mm512_srli_epi64(lanes, bits), above);
+      _mm512_storeu_si512(out + i, lanes);
+    }
+    shiftRightDigitsAvx2(out + i, in + i, n - i, bits);
+  }
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+  __attribute__((target("avx512f,avx512bw")))
+  int compareDigitsAvx512(Digit const* lhs, Digit const* rhs, std::size_t n) {
+    std::size_t i = n;
+    for (; i >= AVX512_DIGITS; i -= AVX512_DIGITS) {
+      __m512i a = _mm512_loadu_si512(lhs + i - AVX512_DIGITS);
+      __m512i b = _mm512_loadu_si512(rhs + i - AVX512_DIGITS);
+      unsigned long long different = _mm512_cmpneq_epi8_mask(a, b);
+      if (different != 0) {
+        std::size_t index = i - AVX512_DIGITS + (63 - __builtin_clzll(different));
+        return lhs[index] > rhs[index] ? 1 : -1;
+      }
+    }
+    return compareDigitsAvx2(lhs, rhs, i);
+  }
+
+  bool isAvx512Supported() {
+    CpuFeatures const& features = cpuFeatures();
+    return features.avx512f && features.avx512bw;
+  }
+
+  bool isAvx512AdxSupported() {
+    return isAvx512Supported() && isAdxSupported();
+  }
+
+  KernelTable const AVX512_KERNELS = {
+    andDigitsAvx512,
+    orDigitsAvx512,
+    xorDigitsAvx512,
+    notDigitsAvx512,
+    shiftLeftDigitsAvx512,
+    shiftRightDigitsAvx512,
+    compareDigitsAvx512,
+    addDigitsWord,
+    subDigitsWord,
+    mulAddLimbsWord,
+    "avx512",
+    isAvx512Supported
+  };
+
+  KernelTable const AVX512_ADX_KERNELS = {
+    andDigitsAvx512,
+    orDigitsAvx512,
+    xorDigitsAvx512,
+    notDigitsAvx512,
+    shiftLeftDigitsAvx512,
+    shiftRightDigitsAvx512,
+    compareDigitsAvx512,
+    addDigitsAdx,
+    subDigitsAdx,
+    mulAddLimbsAdx,
+    "avx512+adx",
+    isAvx512AdxSupported
+  };
+
+#endif
+
+  std::vector<KernelTable const*> makeKernelList() {
+    std::vector<KernelTable const*> result;
+#ifdef APRN_X86_KERNELS
+    result.push_back(&AVX512_ADX_KERNELS);
+    result.push_back(&AVX512_KERNELS);
+    result.push_back(&AVX2_ADX_KERNELS);
+    result.push_back(&AVX2_KERNELS);
+    result.push_back(&ADX_KERNELS);
+#endif
+    result.push_back(&WORD_KERNELS);
+    result.push_back(&GENERIC_KERNELS);
+    return result;
+  }
+
+  KernelTable const* selectKernels() {
+    // The APRN_KERNELS environment variable can name a table to use instead of
+    // the best one, which is useful for comparing the tables on one machine.
+    // It is ignored if the table isn't supported.
+    char const* requested = std::getenv("APRN_KERNELS");
+    if (requested != nullptr) {
+      for (KernelTable const* table : allKernels()) {
+        if (std::strcmp(table->name, requested) == 0 && table->isSupported()) {
+          return table;
+        }
+      }
+    }
+    // Otherwise, take the first table that works. The generic table always does.
+    for (KernelTable const* table : allKernels()) {
+      if (table->isSupported()) {
+        return table;
+      }
+    }
+    return &GENERIC_KERNELS;
+  }
+
+  std::atomic<KernelTable const*>& currentTable() {
+    // The choice is made once, the first time that any kernel is needed.
+    static std::atomic<KernelTable const*> table(selectKernels());
+    return table;
+  }
+
+}
+
+KernelTable const& aprn::kernels::kernels() {
+  return *currentTable().load(std::memory_order_relaxed);
+}
+
+std::vector<KernelTable const*> const& aprn::kernels::allKernels() {
+  static std::vector<KernelTable const*> const list = makeKernelList();
+  return list;
+}
+
+void aprn::kernels::setKernels(KernelTable const& table) {
+  currentTable().store(&table, std::memory_order_relaxed);
+}
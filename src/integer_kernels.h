@@ -0,0 +1,68 @@
+#ifndef __APRN_INTEGER_KERNELS_H_
+#define __APRN_INTEGER_KERNELS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace aprn {
+  namespace kernels {
+
+    // The type of the digits that the kernels work on. This has to match
+    // Integer::Digit, which is checked in the Integer source file.
+    using Digit = std::uint8_t;
+    // The type of the limbs that the multiplication kernels work on. Digits are
+    // packed into limbs before multiplying, so that each step of the inner loop
+    // does as much work as the processor can.
+    using Limb = std::uint64_t;
+
+    // A set of implementations of the inner loops of Integer. All of the
+    // arrays of digits are least significant first, and may not overlap unless
+    // stated otherwise. Several versions of each table exist, using different
+    // instruction sets, and the best one that the processor supports is chosen
+    // the first time that the kernels are used.
+    struct KernelTable {
+      // lhs[i] = lhs[i] & rhs[i], for i < n.
+      void (*andDigits)(Digit* lhs, Digit const* rhs, std::size_t n);
+      // lhs[i] = lhs[i] | rhs[i], for i < n.
+      void (*orDigits)(Digit* lhs, Digit const* rhs, std::size_t n);
+      // lhs[i] = lhs[i] ^ rhs[i], for i < n.
+      void (*xorDigits)(Digit* lhs, Digit const* rhs, std::size_t n);
+      // out[i] = ~in[i], for i < n. The arrays may be the same.
+      void (*notDigits)(Digit* out, Digit const* in, std::size_t n);
+      // Shifts the n digits of in left by 0 < bits < 8 bits, writing n + 1 digits
+      // to out. The arrays may be the same if out is at least as far along in
+      // memory as in.
+      void (*shiftLeftDigits)(Digit* out, Digit const* in, std::size_t n, unsigned bits);
+      // Shifts the n + 1 digits of in right by 0 < bits < 8 bits, writing the
+      // lowest n digits of the result to out. The arrays may be the same if out
+      // is no further along in memory than in.
+      void (*shiftRightDigits)(Digit* out, Digit const* in, std::size_t n, unsigned bits);
+      // Returns the sign of (lhs - rhs), where both have n digits.
+      int (*compareDigits)(Digit const* lhs, Digit const* rhs, std::size_t n);
+      // lhs += rhs over n digits, returning the carry out of the top digit.
+      bool (*addDigits)(Digit* lhs, Digit const* rhs, std::size_t n);
+      // lhs -= rhs over n digits, returning the borrow out of the top digit.
+      bool (*subDigits)(Digit* lhs, Digit const* rhs, std::size_t n);
+      // out += in * factor over n limbs, returning the limb that is carried
+      // out of the top.
+      Limb (*mulAddLimbs)(Limb* out, Limb const* in, std::size_t n, Limb factor);
+      // The name of the instruction sets that the table uses.
+      char const* name;
+      // Whether the processor that the program is running on can use the table.
+      bool (*isSupported)();
+    };
+
+    // Returns the table of kernels in use. This is the best table for this
+    // processor, unless a different one has been chosen with setKernels.
+    KernelTable const& kernels();
+    // Returns every table that was compiled in, from best to worst. Not all of
+    // them are necessarily supported by the processor.
+    std::vector<KernelTable const*> const& allKernels();
+    // Changes the table of kernels in use. The table must be supported.
+    void setKernels(KernelTable const& table);
+
+  }
+}
+
+#endif
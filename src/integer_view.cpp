@@ -0,0 +1,221 @@
+#include "../include/integer_view.h"
+
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "../include/thread_pool.h"
+#include "integer_kernels.h"
+#include "limb_arithmetic.h"
+
+using namespace aprn;
+
+bool isBigEndian();
+
+namespace {
+
+  // Returns the sign of (|lhs| - |rhs|).
+  int compareMagnitude(IntegerView lhs, IntegerView rhs) {
+    if (lhs.byteCount() != rhs.byteCount()) {
+      return lhs.byteCount() > rhs.byteCount() ? 1 : -1;
+    }
+    else if (lhs.byteCount() == 0) {
+      return 0;
+    }
+    return kernels::kernels().compareDigits(lhs.bytes(), rhs.bytes(), lhs.byteCount());
+  }
+
+  // Adds the magnitudes of two views, giving digits that may have a leading zero.
+  StorageVector<std::uint8_t> addMagnitudes(IntegerView lhs, IntegerView rhs) {
+    if (lhs.byteCount() < rhs.byteCount()) {
+      std::swap(lhs, rhs);
+    }
+    StorageVector<std::uint8_t> result(lhs.bytes(), lhs.bytes() + lhs.byteCount());
+    result.push_back(0);
+    if (rhs.byteCount() == 0) {
+      return result;
+    }
+    bool hasCarry = kernels::kernels().addDigits(result.data(), rhs.bytes(), rhs.byteCount());
+    for (std::size_t i = rhs.byteCount(); hasCarry; ++i) {
+      hasCarry = (++result[i] == 0);
+    }
+    return result;
+  }
+
+  // Subtracts the magnitude of a view from a larger one, giving digits that may
+  // have leading zeros.
+  StorageVector<std::uint8_t> subtractMagnitudes(IntegerView lhs, IntegerView rhs) {
+    StorageVector<std::uint8_t> result(lhs.bytes(), lhs.bytes() + lhs.byteCount());
+    if (rhs.byteCount() == 0) {
+      return result;
+    }
+    bool hasBorrow = kernels::kernels().subDigits(result.data(), rhs.bytes(), rhs.byteCount());
+    for (std::size_t i = rhs.byteCount(); hasBorrow; ++i) {
+      hasBorrow = (result[i]-- == 0);
+    }
+    return result;
+  }
+
+  // Gives the limbs of a view as an array of native limbs. If the bytes of the view
+  // already are one, they are used directly, and otherwise they are copied into the
+  // storage.
+  limbs::Limb const* nativeLimbs(IntegerView val, StorageVector<limbs::Limb>& storage) {
+    if (!isBigEndian() &&
+        val.byteCount() % sizeof(limbs::Limb) == 0 &&
+        reinterpret_cast<std::uintptr_t>(val.bytes()) % alignof(limbs::Limb) == 0) {
+      return reinterpret_cast<limbs::Limb const*>(val.bytes());
+    }
+    storage.resize(val.limbCount());
+    for (std::size_t i = 0; i < storage.size(); ++i) {
+      storage[i] = val.limb(i);
+    }
+    return storage.data();
+  }
+
+}
+
+IntegerView::IntegerView() : m_bytes(nullptr), m_size(0), m_isNegative(false) {}
+
+IntegerView::IntegerView(Integer const& val) :
+  m_bytes(val.m_digits.data()),
+  m_size(val.m_digits.size()),
+  m_isNegative(val.m_isNegative) {}
+
+IntegerView::IntegerView(void const* limbs, std::size_t limbCount, bool isNegative) :
+  m_bytes(static_cast<std::uint8_t const*>(limbs)),
+  m_size(limbCount * sizeof(Limb)) {
+  // The leading zeros are left out, so that the size of a view is the same as the size
+  // of an Integer with the same value.
+  while (m_size != 0 && m_bytes[m_size - 1] == 0) {
+    --m_size;
+  }
+  m_isNegative = isNegative && m_size != 0;
+}
+
+IntegerView::Limb IntegerView::limb(std::size_t index) const {
+  // The bytes are put together one at a time, which works for any alignment and byte
+  // order. Compilers recognize this, and turn it into a single load where they can.
+  Limb result = 0;
+  if (index >= limbCount()) {
+    return result;
+  }
+  std::size_t first = index * sizeof(Limb);
+  std::size_t count = m_size - first < sizeof(Limb) ? m_size - first : sizeof(Limb);
+  for (std::size_t i = 0; i < count; ++i) {
+    result |= (Limb) m_bytes[first + i] << (CHAR_BIT * i);
+  }
+  return result;
+}
+
+Integer IntegerView::toInteger() const {
+  return makeInteger(StorageVector<std::uint8_t>(m_bytes, m_bytes + m_size), m_isNegative);
+}
+
+Integer IntegerView::makeInteger(StorageVector<std::uint8_t>&& digits, bool isNegative) {
+  Integer result;
+  result.m_digits = std::move(digits);
+  result.m_isNegative = isNegative;
+  result.makeValid();
+  return result;
+}
+
+int aprn::compare(IntegerView lhs, IntegerView rhs) {
+  if (lhs.isNegative() != rhs.isNegative()) {
+    return lhs.isNegative() ? -1 : 1;
+  }
+  int compMag = compareMagnitude(lhs, rhs);
+  return lhs.isNegative() ? -compMag : compMag;
+}
+
+Integer aprn::operator+(IntegerView lhs, IntegerView rhs) {
+  // The same as for Integers: magnitudes with the same sign are added, and otherwise the
+  // smaller magnitude is subtracted from the larger one, which decides the sign.
+  if (lhs.isNegative() == rhs.isNegative()) {
+    return IntegerView::makeInteger(addMagnitudes(lhs, rhs), lhs.isNegative());
+  }
+  if (compareMagnitude(lhs, rhs) < 0) {
+    std::swap(lhs, rhs);
+  }
+  return IntegerView::makeInteger(subtractMagnitudes(lhs, rhs), lhs.isNegative());
+}
+
+Integer aprn::operator-(IntegerView lhs, IntegerView rhs) {
+  if (lhs.isNegative() != rhs.isNegative()) {
+    return IntegerView::makeInteger(addMagnitudes(lhs, rhs), lhs.isNegative());
+  }
+  if (compareMagnitude(lhs, rhs) < 0) {
+    return IntegerView::makeInteger(subtractMagnitudes(rhs, lhs), !lhs.isNegative());
+  }
+  return IntegerView::makeInteger(subtractMagnitudes(lhs, rhs), lhs.isNegative());
+}
+
+Integer aprn::operator*(IntegerView lhs, IntegerView rhs) {
+  if (!lhs || !rhs) {
+    return Integer();
+  }
+  StorageVector<limbs::Limb> lhsStorage;
+  StorageVector<limbs::Limb> rhsStorage;
+  limbs::Limb const* lhsLimbs = nativeLimbs(lhs, lhsStorage);
+  limbs::Limb const* rhsLimbs = nativeLimbs(rhs, rhsStorage);
+  StorageVector<limbs::Limb> product(lhs.limbCount() + rhs.limbCount());
+  limbs::multiply(product.data(), lhsLimbs, lhs.limbCount(),
+                  rhsLimbs, rhs.limbCount(), threadLimit());
+
+  StorageVector<std::uint8_t> digits(product.size() * sizeof(limbs::Limb));
+  if (!isBigEndian()) {
+    std::memcpy(digits.data(), product.data(), digits.size());
+  }
+  else {
+    for (std::size_t i = 0; i < digits.size(); ++i) {
+      digits[i] = (std::uint8_t) (product[i / sizeof(limbs::Limb)] >> (CHAR_BIT * (i % sizeof(limbs::Limb))));
+    }
+  }
+  return IntegerView::makeInteger(std::move(digits), lhs.isNegative() != rhs.isNegative());
+}
+
+int aprn::signum(IntegerView val) {
+  if (!val) {
+    return 0;
+  }
+  return val.isNegative() ? -1 : 1;
+}
+
+unsigned long long aprn::bitLength(IntegerView val) {
+  if (!val) {
+    return 0;
+  }
+  unsigned long long result = (unsigned long long) (val.byteCount() - 1) * CHAR_BIT;
+  for (unsigned top = val.bytes()[val.byteCount() - 1]; top != 0; top >>= 1) {
+    ++result;
+  }
+  return result;
+}
+
+unsigned long long aprn::popcount(IntegerView val) {
+  unsigned long long result = 0;
+  for (std::size_t i = 0; i < val.limbCount(); ++i) {
+    result += __builtin_popcountll(val.limb(i));
+  }
+  return result;
+}
+
+bool aprn::testBit(IntegerView val, unsigned long long index) {
+  // In two's complement, -x is ~(x - 1). Subtracting one flips the lowest one bit of
+  // the magnitude and all of the zeros below it, so the bits at and below the lowest
+  // one bit are the same as in the magnitude, and all of the bits above it are flipped.
+  std::size_t byte = (std::size_t) (index / CHAR_BIT);
+  bool bit = byte < val.byteCount() && ((val.bytes()[byte] >> (index % CHAR_BIT)) & 1);
+  if (!val.isNegative()) {
+    return bit;
+  }
+  unsigned long long lowest = 0;
+  for (std::size_t i = 0; val.bytes()[i] == 0; ++i) {
+    lowest += CHAR_BIT;
+  }
+  for (unsigned low = val.bytes()[lowest / CHAR_BIT]; (low & 1) == 0; low >>= 1) {
+    ++lowest;
+  }
+  return index > lowest ? !bit : bit;
+}
@@ -0,0 +1,274 @@
+#include "limb_arithmetic.h"
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+#include "../include/async.h"
+#include "../include/thread_pool.h"
+
+using namespace aprn;
+using namespace aprn::limbs;
+
+namespace {
+
+  std::size_t const HALF_LIMB_BITS = 32;
+  // How many limbs of a quotient are found between checks for cancellation.
+  std::size_t const CANCELLATION_INTERVAL = 256;
+
+  // lhs[0, lhsSize) += rhs[0, rhsSize), where rhsSize <= lhsSize. Returns the carry.
+  bool addLimbs(Limb* lhs, std::size_t lhsSize, Limb const* rhs, std::size_t rhsSize) {
+    bool carry = false;
+    std::size_t i = 0;
+    for (; i < rhsSize; ++i) {
+      Limb sum = lhs[i] + rhs[i];
+      bool nextCarry = sum < rhs[i];
+      sum += carry;
+      nextCarry = nextCarry || sum < (Limb) carry;
+      lhs[i] = sum;
+      carry = nextCarry;
+    }
+    for (; carry && i < lhsSize; ++i) {
+      carry = ++lhs[i] == 0;
+    }
+    return carry;
+  }
+
+  // lhs[0, lhsSize) -= rhs[0, rhsSize), where rhsSize <= lhsSize. Returns the borrow.
+  bool subtractLimbs(Limb* lhs, std::size_t lhsSize, Limb const* rhs, std::size_t rhsSize) {
+    bool borrow = false;
+    std::size_t i = 0;
+    for (; i < rhsSize; ++i) {
+      Limb difference = lhs[i] - rhs[i];
+      bool nextBorrow = lhs[i] < rhs[i];
+      nextBorrow = nextBorrow || difference < (Limb) borrow;
+      lhs[i] = difference - borrow;
+      borrow = nextBorrow;
+    }
+    for (; borrow && i < lhsSize; ++i) {
+      borrow = lhs[i]-- == 0;
+    }
+    return borrow;
+  }
+
+  // Returns the number of limbs left once the leading zeros are dropped.
+  std::size_t trimmedSize(Limb const* limbs, std::size_t size) {
+    while (size != 0 && limbs[size - 1] == 0) {
+      --size;
+    }
+    return size;
+  }
+
+  void multiplyGradeSchool(Limb* out, Limb const* lhs, std::size_t lhsSize,
+                           Limb const* rhs, std::size_t rhsSize) {
+    // Each row of the product is added in by a kernel. The limb above the row hasn't
+    // been written yet, so the carry out of the row can be stored in it.
+    std::fill(out, out + lhsSize + rhsSize, 0);
+    kernels::KernelTable const& table = kernels::kernels();
+    for (std::size_t i = 0; i < rhsSize; ++i) {
+      out[i + lhsSize] = table.mulAddLimbs(out + i, lhs, lhsSize, rhs[i]);
+    }
+  }
+
+  void multiplyUnbalanced(Limb* out, Limb const* lhs, std::size_t lhsSize,
+                          Limb const* rhs, std::size_t rhsSize, unsigned threads) {
+    // The larger operand is cut into pieces the size of the smaller one, and each
+    // piece is multiplied separately. The product of each piece only overlaps the
+    // products of the pieces next to it, so the products of the even pieces can go
+    // straight into the output, with the odd ones added on afterwards.
+    std::size_t const numPieces = (lhsSize + rhsSize - 1) / rhsSize;
+    std::size_t const outSize = lhsSize + rhsSize;
+    StorageVector<Limb> odd(outSize, 0);
+    std::fill(out, out + outSize, 0);
+    bool const isParallel = threads > 1 && rhsSize >= thresholds().parallel;
+    unsigned const pieceThreads = isParallel ? std::max(1u, threads / (unsigned) numPieces) : 1;
+    std::vector<std::function<void()>> tasks;
+    for (std::size_t i = 0; i < numPieces; ++i) {
+      std::size_t offset = i * rhsSize;
+      std::size_t pieceSize = std::min(rhsSize, lhsSize - offset);
+      Limb* pieceOut = (i % 2 == 0 ? out : odd.data()) + offset;
+      tasks.push_back([=]() {
+        multiply(pieceOut, lhs + offset, pieceSize, rhs, rhsSize, pieceThreads);
+      });
+    }
+    runTasks(tasks, isParallel);
+    addLimbs(out, outSize, odd.data(), trimmedSize(odd.data(), outSize));
+  }
+
+  void multiplyKaratsuba(Limb* out, Limb const* lhs, std::size_t lhsSize,
+                         Limb const* rhs, std::size_t rhsSize, unsigned threads) {
+    // Both operands are split at the same place, as lhs = lhs1 * B + lhs0 and
+    // rhs = rhs1 * B + rhs0. Then
+    //   lhs * rhs = z2 * B^2 + (z1 - z2 - z0) * B + z0,
+    // where z0 = lhs0 * rhs0, z2 = lhs1 * rhs1 and z1 = (lhs0 + lhs1) * (rhs0 + rhs1).
+    // The three smaller products don't depend on each other. Since rhs is more than
+    // half the size of lhs, both high halves have at least one limb.
+    std::size_t const half = lhsSize / 2;
+    std::size_t const outSize = lhsSize + rhsSize;
+    std::size_t const lhsHighSize = lhsSize - half;
+    std::size_t const rhsHighSize = rhsSize - half;
+
+    // The sums of the halves.
+    StorageVector<Limb> lhsSum(lhs + half, lhs + lhsSize);
+    lhsSum.push_back(0);
+    addLimbs(lhsSum.data(), lhsSum.size(), lhs, half);
+    StorageVector<Limb> rhsSum(std::max(half, rhsHighSize) + 1, 0);
+    std::copy(rhs, rhs + half, rhsSum.begin());
+    addLimbs(rhsSum.data(), rhsSum.size(), rhs + half, rhsHighSize);
+    std::size_t const lhsSumSize = trimmedSize(lhsSum.data(), lhsSum.size());
+    std::size_t const rhsSumSize = trimmedSize(rhsSum.data(), rhsSum.size());
+    StorageVector<Limb> middle(lhsSumSize + rhsSumSize);
+
+    // z0 and z2 go straight into the output, where they don't overlap.
+    bool const isParallel = threads > 1 && rhsSize >= thresholds().parallel;
+    unsigned const partThreads = isParallel ? std::max(1u, threads / 3) : 1;
+    std::vector<std::function<void()>> tasks;
+    tasks.push_back([&]() {
+      multiply(out, lhs, half, rhs, half, partThreads);
+    });
+    tasks.push_back([&]() {
+      multiply(out + 2 * half, lhs + half, lhsHighSize, rhs + half, rhsHighSize, partThreads);
+    });
+    tasks.push_back([&]() {
+      multiply(middle.data(), lhsSum.data(), lhsSumSize, rhsSum.data(), rhsSumSize, partThreads);
+    });
+    runTasks(tasks, isParallel);
+
+    // z1 is at least as large as z0 and z2, so neither subtraction can borrow.
+    subtractLimbs(middle.data(), middle.size(), out, trimmedSize(out, 2 * half));
+    subtractLimbs(middle.data(), middle.size(), out + 2 * half, trimmedSize(out + 2 * half, outSize - 2 * half));
+    addLimbs(out + half, outSize - half, middle.data(), trimmedSize(middle.data(), middle.size()));
+  }
+
+  // Returns the number of leading zero bits of a half limb that isn't zero.
+  unsigned countLeadingZeros(HalfLimb value) {
+    unsigned result = 0;
+    while ((value & ((HalfLimb) 1 << (HALF_LIMB_BITS - 1))) == 0) {
+      value <<= 1;
+      ++result;
+    }
+    return result;
+  }
+
+  void trim(StorageVector<HalfLimb>& limbs) {
+    while (!limbs.empty() && limbs.back() == 0) {
+      limbs.pop_back();
+    }
+  }
+
+}
+
+void aprn::limbs::multiply(Limb* out, Limb const* lhs, std::size_t lhsSize,
+                           Limb const* rhs, std::size_t rhsSize, unsigned threads) {
+  checkCancelled();
+  if (lhsSize < rhsSize) {
+    std::swap(lhs, rhs);
+    std::swap(lhsSize, rhsSize);
+  }
+  if (rhsSize < thresholds().karatsuba) {
+    multiplyGradeSchool(out, lhs, lhsSize, rhs, rhsSize);
+  }
+  else if (lhsSize >= 2 * rhsSize) {
+    multiplyUnbalanced(out, lhs, lhsSize, rhs, rhsSize, threads);
+  }
+  else {
+    multiplyKaratsuba(out, lhs, lhsSize, rhs, rhsSize, threads);
+  }
+}
+
+void aprn::limbs::divide(StorageVector<HalfLimb> const& lhs, StorageVector<HalfLimb> const& rhs,
+                         StorageVector<HalfLimb>& quot_out, StorageVector<HalfLimb>& rem_out) {
+  // Knuth's algorithm D (The Art of Computer Programming, volume 2, section 4.3.1).
+  // Each limb of the quotient is estimated from the top two limbs of what is left of
+  // the dividend and the top limb of the divisor. Shifting both operands so that the
+  // top bit of the divisor is set makes the estimate at most two too large, and
+  // checking the next limb down almost always fixes it before the product is taken.
+  using Wide = std::uint64_t;
+  Wide const BASE = (Wide) 1 << HALF_LIMB_BITS;
+  std::size_t const n = rhs.size();
+  quot_out.clear();
+  if (lhs.size() < n) {
+    rem_out = lhs;
+    return;
+  }
+  std::size_t const m = lhs.size() - n;
+  quot_out.assign(m + 1, 0);
+
+  if (n == 1) {
+    // Dividing by a single limb is much simpler.
+    Wide remainder = 0;
+    for (std::size_t i = lhs.size(); i != 0; --i) {
+      Wide current = (remainder << HALF_LIMB_BITS) | lhs[i - 1];
+      quot_out[i - 1] = (HalfLimb) (current / rhs[0]);
+      remainder = current % rhs[0];
+    }
+    trim(quot_out);
+    rem_out.assign(1, (HalfLimb) remainder);
+    trim(rem_out);
+    return;
+  }
+
+  unsigned const shift = countLeadingZeros(rhs.back());
+  StorageVector<HalfLimb> divisor(n);
+  StorageVector<HalfLimb> dividend(lhs.size() + 1);
+  for (std::size_t i = n; i != 0; --i) {
+    Wide below = i > 1 ? rhs[i - 2] : 0;
+    divisor[i - 1] = (HalfLimb) ((((Wide) rhs[i - 1] << HALF_LIMB_BITS) | below) >> (HALF_LIMB_BITS - shift));
+  }
+  dividend[lhs.size()] = (HalfLimb) ((Wide) lhs.back() >> (HALF_LIMB_BITS - shift));
+  for (std::size_t i = lhs.size(); i != 0; --i) {
+    Wide below = i > 1 ? lhs[i - 2] : 0;
+    dividend[i - 1] = (HalfLimb) ((((Wide) lhs[i - 1] << HALF_LIMB_BITS) | below) >> (HALF_LIMB_BITS - shift));
+  }
+
+  for (std::size_t j = m + 1; j != 0; --j) {
+    std::size_t const k = j - 1;
+    if (k % CANCELLATION_INTERVAL == 0) {
+      checkCancelled();
+    }
+    Wide top = ((Wide) dividend[k + n] << HALF_LIMB_BITS) | dividend[k + n - 1];
+    Wide estimate = top / divisor[n - 1];
+    Wide remainder = top % divisor[n - 1];
+    while (estimate >= BASE ||
+           estimate * divisor[n - 2] > ((remainder << HALF_LIMB_BITS) | dividend[k + n - 2])) {
+      --estimate;
+      remainder += divisor[n - 1];
+      if (remainder >= BASE) {
+        break;
+      }
+    }
+    // Subtract estimate * divisor from the dividend.
+    Wide carry = 0;
+    Wide borrow = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+      Wide product = estimate * divisor[i] + carry;
+      carry = product >> HALF_LIMB_BITS;
+      Wide difference = (Wide) dividend[k + i] - (product & (BASE - 1)) - borrow;
+      dividend[k + i] = (HalfLimb) difference;
+      borrow = (difference >> HALF_LIMB_BITS) & 1;
+    }
+    Wide difference = (Wide) dividend[k + n] - carry - borrow;
+    dividend[k + n] = (HalfLimb) difference;
+    // If that went negative, the estimate was one too large, so add the divisor back.
+    if (((difference >> HALF_LIMB_BITS) & 1) != 0) {
+      --estimate;
+      Wide sumCarry = 0;
+      for (std::size_t i = 0; i < n; ++i) {
+        Wide sum = (Wide) dividend[k + i] + divisor[i] + sumCarry;
+        dividend[k + i] = (HalfLimb) sum;
+        sumCarry = sum >> HALF_LIMB_BITS;
+      }
+      dividend[k + n] = (HalfLimb) (dividend[k + n] + sumCarry);
+    }
+    quot_out[k] = (HalfLimb) estimate;
+  }
+
+  // The remainder is what is left of the dividend, shifted back.
+  rem_out.assign(n, 0);
+  for (std::size_t i = 0; i < n; ++i) {
+    Wide pair = ((Wide) dividend[i + 1] << HALF_LIMB_BITS) | dividend[i];
+    rem_out[i] = (HalfLimb) (pair >> shift);
+  }
+  trim(quot_out);
+  trim(rem_out);
+}
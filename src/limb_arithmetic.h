@@ -0,0 +1,44 @@
+#ifndef __APRN_LIMB_ARITHMETIC_H_
+#define __APRN_LIMB_ARITHMETIC_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "../include/storage.h"
+#include "../include/thresholds.h"
+#include "integer_kernels.h"
+
+namespace aprn {
+  namespace limbs {
+
+    // The algorithms that Integer uses for multiplying and dividing large
+    // magnitudes. The digits of an Integer are packed into wider limbs before
+    // being handed over, and all of the arrays of limbs are least significant
+    // first. Large arrays are kept in StorageVectors, so that they can be in
+    // mapped storage along with the digits of the Integers they come from.
+
+    using Limb = kernels::Limb;
+    // Division works on half size limbs, so that the product of two of them
+    // (and the quotient of two of them by one) fits in a built in type.
+    using HalfLimb = std::uint32_t;
+
+    // The sizes at which the algorithms change over are in aprn::thresholds(),
+    // measured in limbs for multiplication and in half limbs for division.
+
+    // Writes lhs * rhs to out, which must have room for lhsSize + rhsSize limbs
+    // and must not overlap either operand. Up to the given number of threads
+    // from the shared pool may work on the product.
+    void multiply(Limb* out, Limb const* lhs, std::size_t lhsSize,
+                  Limb const* rhs, std::size_t rhsSize, unsigned threads);
+
+    // Divides one magnitude by another with Knuth's algorithm D, giving the
+    // quotient and remainder without leading zeros. The divisor must not be
+    // zero, and neither operand may have leading zeros.
+    void divide(StorageVector<HalfLimb> const& lhs, StorageVector<HalfLimb> const& rhs,
+                StorageVector<HalfLimb>& quot_out, StorageVector<HalfLimb>& rem_out);
+
+  }
+}
+
+#endif
@@ -1,21 +1,329 @@
 #include "../include/math_integer.h"
 
+#include <algorithm>
+#include <cctype>
 #include <climits>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../include/async.h"
+#include "../include/thread_pool.h"
+#include "../include/thresholds.h"
+#include "instrumentation.h"
 
 using namespace aprn;
 
+namespace {
+  
+  // The smallest number of factors for which it is worth handing half of a
+  // product tree to the pool.
+  std::size_t const MIN_PARALLEL_FACTORS = 16;
+  
+  // Multiplies together the factors in the range [first, last) using a balanced
+  // tree, so that the operands of every multiplication are about the same size.
+  Integer productTree(std::vector<Integer> const& factors,
+                      std::size_t first, std::size_t last, unsigned threads) {
+    if (first >= last) {
+      return Integer(1);
+    }
+    else if (last - first == 1) {
+      return factors[first];
+    }
+    checkCancelled();
+    std::size_t middle = first + (last - first) / 2;
+    bool const isParallel = threads > 1 && last - first >= MIN_PARALLEL_FACTORS;
+    unsigned const leftThreads = isParallel ? threads / 2 : 1;
+    unsigned const rightThreads = isParallel ? threads - leftThreads : 1;
+    Integer left;
+    Integer right;
+    std::vector<std::function<void()>> tasks;
+    tasks.push_back([&]() {
+      right = productTree(factors, middle, last, rightThreads);
+    });
+    tasks.push_back([&]() {
+      left = productTree(factors, first, middle, leftThreads);
+    });
+    runTasks(tasks, isParallel);
+    return left * right;
+  }
+  
+  // The largest base that toString accepts, and the digits it uses.
+  int const MAX_BASE = 36;
+  char const DIGIT_CHARACTERS[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+  // When digits are written to a stream, they are passed on once this many have
+  // been collected.
+  std::size_t const STREAM_CHARACTERS = 1 << 16;
+  
+  // Passes the digits collected so far on to the stream, if there is one, once
+  // there are enough of them (or all of them if forced).
+  void flushDigits(std::string& out, std::ostream* sink, bool force = false) {
+    if (sink != nullptr && (force || out.size() >= STREAM_CHARACTERS)) {
+      sink->write(out.data(), (std::streamsize) out.size());
+      out.clear();
+    }
+  }
+  
+  // Writes the digits of a word to the end of a string, padded with zeros up to
+  // a width (if it is not zero).
+  void appendWord(unsigned long long small, unsigned long long width, int base, std::string& out) {
+    char buffer[CHAR_BIT * sizeof(unsigned long long)];
+    std::size_t numDigits = 0;
+    while (small != 0) {
+      buffer[numDigits++] = DIGIT_CHARACTERS[small % base];
+      small /= base;
+    }
+    if (width > numDigits) {
+      out.append(width - numDigits, '0');
+    }
+    while (numDigits != 0) {
+      out.push_back(buffer[--numDigits]);
+    }
+  }
+  
+  // Writes the digits of a non-negative value to the end of a string, padded
+  // with zeros up to a width (if it is not zero). At each level, the value is
+  // less than the square of powers[level - 1], so it can be split into two
+  // halves by dividing by that power. At level zero, the value fits in a word.
+  // The halves are done depth first, so the digits come out in order, and each
+  // division only touches the part of the value that it is splitting. Values
+  // below the radix conversion threshold are instead divided by the word sized
+  // power over and over, which is quicker when they are short.
+  void appendDigits(Integer const& value, std::vector<Integer> const& powers, std::size_t level,
+                    unsigned long long width, unsigned chunkDigits, int base,
+                    std::string& out, std::ostream* sink) {
+    checkCancelled();
+    if (level == 0) {
+      appendWord((unsigned long long) value, width, base, out);
+      flushDigits(out, sink);
+      return;
+    }
+    unsigned long long const limbBits = CHAR_BIT * sizeof(unsigned long long);
+    if (bitLength(value) < thresholds().radixConversion * limbBits) {
+      // The words of digits come out least significant first.
+      std::vector<unsigned long long> words;
+      Integer rest = value;
+      while (signum(rest) != 0) {
+        div_result parts = div(rest, powers[0]);
+        words.push_back((unsigned long long) parts.rem);
+        rest = std::move(parts.quot);
+      }
+      unsigned long long lowDigits = words.empty() ? 0 : (words.size() - 1) * chunkDigits;
+      appendWord(words.empty() ? 0 : words.back(), width > lowDigits ? width - lowDigits : 0, base, out);
+      for (std::size_t i = words.size(); i > 1; --i) {
+        appendWord(words[i - 2], chunkDigits, base, out);
+      }
+      flushDigits(out, sink);
+      return;
+    }
+    div_result parts = div(value, powers[level - 1]);
+    unsigned long long halfWidth = (unsigned long long) chunkDigits << (level - 1);
+    if (width == 0 && signum(parts.quot) == 0) {
+      appendDigits(parts.rem, powers, level - 1, 0, chunkDigits, base, out, sink);
+    }
+    else {
+      appendDigits(parts.quot, powers, level - 1, width > halfWidth ? width - halfWidth : 0,
+                   chunkDigits, base, out, sink);
+      appendDigits(parts.rem, powers, level - 1, halfWidth, chunkDigits, base, out, sink);
+    }
+  }
+  
+  // Collects small factors into single words before they are put into the list
+  // of factors, so that the leaves of the product tree aren't tiny.
+  class FactorList {
+  public:
+    FactorList() : m_word(1) {}
+    void push(unsigned long long factor) {
+      if (m_word > std::numeric_limits<unsigned long long>::max() / factor) {
+        m_factors.push_back(Integer(m_word));
+        m_word = 1;
+      }
+      m_word *= factor;
+    }
+    void push(Integer const& factor) {
+      m_factors.push_back(factor);
+    }
+    Integer product(unsigned threads) {
+      if (m_word != 1) {
+        m_factors.push_back(Integer(m_word));
+        m_word = 1;
+      }
+      return productTree(m_factors, 0, m_factors.size(), threads);
+    }
+  private:
+    std::vector<Integer> m_factors;
+    unsigned long long m_word;
+  };
+  
+  // Finds all of the primes less than or equal to n with the sieve of Eratosthenes.
+  std::vector<unsigned long long> primesUpTo(unsigned long long n) {
+    std::vector<unsigned long long> primes;
+    if (n < 2) {
+      return primes;
+    }
+    std::vector<bool> composite(n + 1, false);
+    for (unsigned long long i = 2; i <= n; ++i) {
+      if (!composite[i]) {
+        primes.push_back(i);
+        for (unsigned long long j = i * i; i <= n / i && j <= n; j += i) {
+          composite[j] = true;
+        }
+      }
+    }
+    return primes;
+  }
+  
+  // Gives the power of the prime p in the factorization of n!, using Legendre's formula.
+  unsigned long long factorialExponent(unsigned long long n, unsigned long long p) {
+    unsigned long long exponent = 0;
+    while (n != 0) {
+      n /= p;
+      exponent += n;
+    }
+    return exponent;
+  }
+  
+  // Adds the factor p^exponent to a list of factors.
+  void pushPrimePower(FactorList& factors, unsigned long long p, unsigned long long exponent) {
+    // Small powers are kept as words, while larger ones are computed by squaring.
+    if (exponent <= 4) {
+      for (unsigned long long i = 0; i < exponent; ++i) {
+        factors.push(p);
+      }
+    }
+    else {
+      factors.push(pow(Integer(p), exponent));
+    }
+  }
+  
+}
+
 int aprn::signum(Integer const& val) {
   return (val.m_digits.size() != 0) * (1 - 2 * val.m_isNegative);
 }
 
-Integer aprn::abs(Integer val) {
-  val.m_isNegative = 0;
-  return val;
+Integer aprn::abs(Integer const& val) {
+  Integer result(val);
+  result.m_isNegative = false;
+  return result;
 }
 
 bool aprn::even(Integer const& val) {
   return val.m_digits.empty() || (val.m_digits.front() % 2 == 0);
 }
+
+Integer::ShiftType aprn::bitLength(Integer const& val) {
+  if (val.m_digits.empty()) {
+    return 0;
+  }
+  // All digits but the leading one are full, so only the leading digit has to
+  // be examined bit by bit.
+  Integer::ShiftType result = (val.m_digits.size() - 1) * CHAR_BIT * sizeof(Integer::Digit);
+  for (Integer::Digit leading = val.m_digits.back(); leading != 0; leading >>= 1) {
+    ++result;
+  }
+  return result;
+}
+  
+Integer::ShiftType aprn::popcount(Integer const& val) {
+  // Each step clears the lowest one bit of the digit.
+  Integer::ShiftType result = 0;
+  for (Integer::Digit digit : val.m_digits) {
+    for (; digit != 0; digit &= (Integer::Digit) (digit - 1)) {
+      ++result;
+    }
+  }
+  return result;
+}
+
+Integer::ShiftType aprn::countTrailingZeros(Integer const& val) {
+  // Skip the zero digits, and then count the zero bits at the bottom of the first
+  // digit that isn't zero. Since the Integer is valid, there is such a digit unless
+  // the Integer is zero.
+  Integer::ShiftType const digitBits = CHAR_BIT * sizeof(Integer::Digit);
+  Integer::SizeType i = 0;
+  while (i < val.m_digits.size() && val.m_digits[i] == 0) {
+    ++i;
+  }
+  if (i == val.m_digits.size()) {
+    return 0;
+  }
+  Integer::ShiftType result = i * digitBits;
+  for (Integer::Digit digit = val.m_digits[i]; (digit & 1) == 0; digit >>= 1) {
+    ++result;
+  }
+  return result;
+}
+
+bool aprn::testBit(Integer const& val, Integer::ShiftType index) {
+  Integer::ShiftType const digitBits = CHAR_BIT * sizeof(Integer::Digit);
+  Integer::ShiftType const digitIndex = index / digitBits;
+  bool magnitudeBit = digitIndex < val.m_digits.size() &&
+    ((val.m_digits[digitIndex] >> (index % digitBits)) & 1) != 0;
+  if (!val.m_isNegative) {
+    return magnitudeBit;
+  }
+  // The two's complement of a magnitude keeps the lowest one bit and the zeros below
+  // it, and inverts every bit above it.
+  Integer::ShiftType lowest = countTrailingZeros(val);
+  return index <= lowest ? magnitudeBit : !magnitudeBit;
+}
+
+void aprn::setBit(Integer& val, Integer::ShiftType index, bool bit) {
+  if (val.m_isNegative) {
+    // Negative Integers go through the two's complement bitwise operators.
+    Integer mask = Integer(1) << index;
+    if (bit) {
+      val |= mask;
+    }
+    else {
+      val &= ~mask;
+    }
+    return;
+  }
+  Integer::ShiftType const digitBits = CHAR_BIT * sizeof(Integer::Digit);
+  Integer::SizeType const digitIndex = index / digitBits;
+  Integer::Digit const mask = (Integer::Digit) (1u << (index % digitBits));
+  if (bit) {
+    if (digitIndex >= val.m_digits.size()) {
+      val.m_digits.resize(digitIndex + 1, 0);
+    }
+    val.m_digits[digitIndex] |= mask;
+  }
+  else if (digitIndex < val.m_digits.size()) {
+    val.m_digits[digitIndex] &= (Integer::Digit) ~mask;
+    val.makeValid();
+  }
+}
+
+Integer aprn::extractBits(Integer const& val, Integer::ShiftType low, Integer::ShiftType high) {
+  if (high <= low) {
+    return Integer();
+  }
+  Integer result = val;
+  if (result.m_isNegative) {
+    // Masking off the bits above the range gives a non-negative Integer with the
+    // same bits in the range.
+    result &= (Integer(1) << high) - Integer(1);
+  }
+  result >>= low;
+  // Drop the bits above the range.
+  Integer::ShiftType const digitBits = CHAR_BIT * sizeof(Integer::Digit);
+  Integer::ShiftType const width = high - low;
+  Integer::SizeType const numDigits = (width + digitBits - 1) / digitBits;
+  if (result.m_digits.size() >= numDigits) {
+    result.m_digits.resize(numDigits);
+    if (width % digitBits != 0) {
+      result.m_digits.back() &= (Integer::Digit) ((1u << (width % digitBits)) - 1);
+    }
+    result.makeValid();
+  }
+  return result;
+}
   
 div_result aprn::div(Integer const& lhs, Integer const& rhs) {
   div_result result;
@@ -23,6 +331,16 @@ div_result aprn::div(Integer const& lhs, Integer const& rhs) {
   return result;
 }
 
+div_result aprn::div(Integer const& lhs, Integer const& rhs, unsigned threads) {
+  ThreadLimitScope scope(threads);
+  return div(lhs, rhs);
+}
+
+Integer aprn::mul(Integer const& lhs, Integer const& rhs, unsigned threads) {
+  ThreadLimitScope scope(threads);
+  return lhs * rhs;
+}
+
 div_result aprn::div2(Integer const& lhs, Integer::ShiftType power) {
   div_result result = { lhs, Integer(), true };
   result.quot.shiftRight(power, result.rem);
@@ -54,6 +372,10 @@ Integer aprn::mod2(Integer const& lhs, Integer::ShiftType power) {
 
 Integer aprn::gcd(Integer a, Integer b) {
   // This is just a straightforward implementation of the binary Euclid's algorithm.
+  // It works on the magnitudes, so that the shifts and the result are never negative.
+  APRN_STATS_SCOPE(GCD, std::max(bitLength(a), bitLength(b)));
+  a = abs(a);
+  b = abs(b);
   Integer::ShiftType resultPower = 0;
   // Instead of recursion, a loop is used to prevent going over the max recursive depth.
   while (true) {
@@ -92,3 +414,254 @@ Integer aprn::gcd(Integer a, Integer b) {
     }
   }
 }
+
+bool aprn::invmod(Integer const& a, Integer const& modulus, Integer& result_out) {
+  // The extended Euclidean algorithm. Throughout, a * s is congruent to r modulo
+  // the modulus for both pairs (s, r), and when r reaches the gcd of a and the
+  // modulus, s is the inverse (as long as the gcd is one).
+  Integer oldR = a % modulus;
+  Integer r = modulus;
+  Integer oldS(1);
+  Integer s;
+  while (signum(r) != 0) {
+    div_result step = div(oldR, r);
+    oldR = r;
+    r = step.rem;
+    Integer nextS = oldS - step.quot * s;
+    oldS = s;
+    s = nextS;
+  }
+  // The sign of the gcd follows the sign of a, so that case has to be checked as well.
+  if (oldR == Integer(-1)) {
+    oldR.negate();
+    oldS.negate();
+  }
+  if (oldR != Integer(1)) {
+    return false;
+  }
+  result_out = oldS % modulus;
+  if (signum(result_out) < 0) {
+    result_out += modulus;
+  }
+  return true;
+}
+
+Integer aprn::pow(Integer base, unsigned long long exponent) {
+  // Exponentiation by squaring, working through the bits of the exponent from
+  // least significant to most significant.
+  APRN_STATS_SCOPE(POW, bitLength(base));
+  Integer result(1);
+  while (exponent != 0) {
+    checkCancelled();
+    if (exponent % 2 != 0) {
+      result *= base;
+    }
+    exponent /= 2;
+    if (exponent != 0) {
+      base *= base;
+    }
+  }
+  return result;
+}
+
+namespace {
+  
+  // Writes the digits of an Integer to the end of a string, and if there is a
+  // stream, passes them on to it as they are written.
+  void writeDigits(Integer const& val, int base, std::string& result, std::ostream* sink) {
+    APRN_STATS_SCOPE(TO_STRING, bitLength(val));
+    if (signum(val) == 0) {
+      result.push_back('0');
+      flushDigits(result, sink, true);
+      return;
+    }
+    Integer magnitude = abs(val);
+    if (signum(val) < 0) {
+      result.push_back('-');
+    }
+    
+    // A base that is a power of two can be read straight from the bits.
+    int bitsPerDigit = 0;
+    while ((1 << bitsPerDigit) < base) {
+      ++bitsPerDigit;
+    }
+    if ((1 << bitsPerDigit) == base) {
+      unsigned long long numDigits = (bitLength(magnitude) + bitsPerDigit - 1) / bitsPerDigit;
+      for (unsigned long long i = numDigits; i != 0; --i) {
+        unsigned digit = 0;
+        for (int bit = bitsPerDigit; bit != 0; --bit) {
+          digit = 2 * digit + testBit(magnitude, (i - 1) * bitsPerDigit + (bit - 1));
+        }
+        result.push_back(DIGIT_CHARACTERS[digit]);
+        flushDigits(result, sink);
+      }
+      flushDigits(result, sink, true);
+      return;
+    }
+    
+    // Otherwise, the Integer is split up by powers of the base, starting from the
+    // largest power that fits in a word, and squaring it as many times as needed.
+    unsigned chunkDigits = 0;
+    unsigned long long chunk = 1;
+    while (chunk <= std::numeric_limits<unsigned long long>::max() / base) {
+      chunk *= base;
+      ++chunkDigits;
+    }
+    std::vector<Integer> powers(1, Integer(chunk));
+    while (!(magnitude < powers.back())) {
+      // Comparing the bit lengths first avoids squaring when it is obviously
+      // not needed, since the squares get very large.
+      if (2 * (bitLength(powers.back()) - 1) >= bitLength(magnitude)) {
+        break;
+      }
+      Integer square = powers.back() * powers.back();
+      if (magnitude < square) {
+        break;
+      }
+      powers.push_back(square);
+    }
+    std::size_t level = magnitude < powers.front() ? 0 : powers.size();
+    appendDigits(magnitude, powers, level, 0, chunkDigits, base, result, sink);
+    flushDigits(result, sink, true);
+  }
+  
+}
+
+std::string aprn::toString(Integer const& val, int base) {
+  std::string result;
+  if (base >= 2 && base <= MAX_BASE) {
+    writeDigits(val, base, result, nullptr);
+  }
+  return result;
+}
+
+bool aprn::writeString(std::ostream& os, Integer const& val, int base) {
+  if (base < 2 || base > MAX_BASE) {
+    return false;
+  }
+  std::string buffer;
+  writeDigits(val, base, buffer, &os);
+  return true;
+}
+
+bool aprn::fromString(std::string const& str, int base, Integer& result_out) {
+  if (base < 2 || base > MAX_BASE) {
+    return false;
+  }
+  // The size is that of the text, since the result isn't known yet.
+  APRN_STATS_SCOPE(FROM_STRING, CHAR_BIT * str.size());
+  std::size_t first = (!str.empty() && (str[0] == '-' || str[0] == '+')) ? 1 : 0;
+  if (first == str.size()) {
+    return false;
+  }
+  
+  // The digits are read in chunks that fit in a word, starting from the least
+  // significant end, so that only the most significant chunk can be short.
+  unsigned chunkDigits = 0;
+  unsigned long long chunk = 1;
+  while (chunk <= std::numeric_limits<unsigned long long>::max() / base) {
+    chunk *= base;
+    ++chunkDigits;
+  }
+  std::vector<Integer> parts;
+  parts.reserve((str.size() - first) / chunkDigits + 1);
+  for (std::size_t end = str.size(); end > first; ) {
+    std::size_t start = end - first > chunkDigits ? end - chunkDigits : first;
+    unsigned long long small = 0;
+    for (std::size_t i = start; i != end; ++i) {
+      char const* position = std::strchr(DIGIT_CHARACTERS, std::tolower((unsigned char) str[i]));
+      if (str[i] == '\0' || position == nullptr || position - DIGIT_CHARACTERS >= base) {
+        return false;
+      }
+      small = small * base + (position - DIGIT_CHARACTERS);
+    }
+    parts.push_back(Integer(small));
+    end = start;
+  }
+  
+  // Neighbouring parts are joined in pairs, which halves the number of parts and
+  // squares the power of the base that separates them.
+  Integer power(chunk);
+  while (parts.size() > 1) {
+    checkCancelled();
+    std::size_t joined = 0;
+    for (std::size_t i = 0; i + 1 < parts.size(); i += 2) {
+      parts[joined++] = parts[i + 1] * power + parts[i];
+    }
+    if (parts.size() % 2 != 0) {
+      parts[joined++] = parts.back();
+    }
+    parts.resize(joined);
+    if (parts.size() > 1) {
+      power *= power;
+    }
+  }
+  result_out = str[0] == '-' ? -parts[0] : parts[0];
+  return true;
+}
+
+Integer aprn::factorial(unsigned long long n, unsigned threads) {
+  // The power of two is handled separately with a shift, since it is by far the
+  // largest and would otherwise unbalance the product tree. Legendre's formula
+  // gives the power of two in n! as n minus the number of one bits in n.
+  std::vector<unsigned long long> primes = primesUpTo(n);
+  FactorList factors;
+  for (std::size_t i = 1; i < primes.size(); ++i) {
+    pushPrimePower(factors, primes[i], factorialExponent(n, primes[i]));
+  }
+  Integer result = factors.product(threads);
+  result <<= factorialExponent(n, 2);
+  return result;
+}
+
+Integer aprn::doubleFactorial(unsigned long long n, unsigned threads) {
+  // For even n = 2m, n!! = 2^m * m!
+  // For odd n = 2m + 1, n!! = (2m + 1)! / (2^m * m!), which has no factors of two.
+  unsigned long long m = n / 2;
+  if (n % 2 == 0) {
+    Integer result = factorial(m, threads);
+    result <<= m;
+    return result;
+  }
+  std::vector<unsigned long long> primes = primesUpTo(n);
+  FactorList factors;
+  for (std::size_t i = 1; i < primes.size(); ++i) {
+    unsigned long long p = primes[i];
+    pushPrimePower(factors, p, factorialExponent(n, p) - factorialExponent(m, p));
+  }
+  return factors.product(threads);
+}
+
+Integer aprn::binomial(unsigned long long n, unsigned long long k, unsigned threads) {
+  // C(n, k) = n! / (k! (n - k)!), and so the power of each prime in C(n, k) can be
+  // found from the powers of that prime in each of the factorials.
+  if (k > n) {
+    return Integer();
+  }
+  std::vector<unsigned long long> primes = primesUpTo(n);
+  FactorList factors;
+  unsigned long long twoExponent = 0;
+  for (std::size_t i = 0; i < primes.size(); ++i) {
+    unsigned long long p = primes[i];
+    unsigned long long exponent = factorialExponent(n, p)
+      - factorialExponent(k, p) - factorialExponent(n - k, p);
+    if (p == 2) {
+      twoExponent = exponent;
+    }
+    else {
+      pushPrimePower(factors, p, exponent);
+    }
+  }
+  Integer result = factors.product(threads);
+  result <<= twoExponent;
+  return result;
+}
+
+Integer aprn::primorial(unsigned long long n, unsigned threads) {
+  std::vector<unsigned long long> primes = primesUpTo(n);
+  FactorList factors;
+  for (std::size_t i = 0; i < primes.size(); ++i) {
+    factors.push(primes[i]);
+  }
+  return factors.product(threads);
+}
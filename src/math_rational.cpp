@@ -0,0 +1,202 @@
+#include "../include/math_rational.h"
+
+#include <vector>
+
+#include "../include/math_integer.h"
+
+using namespace aprn;
+
+namespace {
+
+  // The number of leading bits of the remainders that the single word steps
+  // work on. This leaves room for the cofactors in a signed word.
+  unsigned long long const LEHMER_BITS = 62;
+
+  /**
+   * @class Expansion
+   * @brief Produces the terms of a continued fraction one at a time.
+   *
+   * Only as much of the Euclidean algorithm is done as the terms asked for need,
+   * so that a caller can stop early. Once the remainders fit in a word, the rest
+   * of the algorithm is done on words.
+   */
+  class Expansion {
+
+  public:
+
+    explicit Expansion(Rational const& val) : m_isFirst(true), m_isSmall(false), m_smallU(0), m_smallV(0) {
+      // The first term is the floor of the value, and the rest come from the
+      // fractional part, as u / v = 1 / (val - floor(val)).
+      div_result result = div(val.numerator(), val.denominator());
+      if (signum(result.rem) < 0) {
+        --result.quot;
+        result.rem += val.denominator();
+      }
+      m_first = result.quot;
+      m_u = val.denominator();
+      m_v = result.rem;
+    }
+
+    /// @brief Finds the next term, or returns false if there are none left.
+    bool next(Integer& term_out) {
+      if (m_isFirst) {
+        m_isFirst = false;
+        term_out = m_first;
+        return true;
+      }
+      if (!m_pending.empty()) {
+        term_out = Integer(m_pending.back());
+        m_pending.pop_back();
+        return true;
+      }
+      if (!m_isSmall && bitLength(m_u) <= 64) {
+        m_isSmall = true;
+        m_smallU = (unsigned long long) m_u;
+        m_smallV = (unsigned long long) m_v;
+      }
+      if (m_isSmall) {
+        if (m_smallV == 0) {
+          return false;
+        }
+        unsigned long long const quotient = m_smallU / m_smallV;
+        unsigned long long const remainder = m_smallU % m_smallV;
+        m_smallU = m_smallV;
+        m_smallV = remainder;
+        term_out = Integer(quotient);
+        return true;
+      }
+      if (signum(m_v) == 0) {
+        return false;
+      }
+      if (!lehmerStep()) {
+        div_result result = div(m_u, m_v);
+        m_u = m_v;
+        m_v = result.rem;
+        term_out = result.quot;
+        return true;
+      }
+      term_out = Integer(m_pending.back());
+      m_pending.pop_back();
+      return true;
+    }
+
+  private:
+
+    // Runs the Euclidean algorithm on the leading bits of the remainders, for as
+    // long as the quotients are certain to match the ones of the full remainders
+    // (Knuth's Algorithm L), and then brings the full remainders up to date with
+    // the cofactors. Returns false if no quotients could be found this way.
+    bool lehmerStep() {
+      unsigned long long const shift = bitLength(m_u) - LEHMER_BITS;
+      long long x = (long long) (unsigned long long) (m_u >> shift);
+      long long y = (long long) (unsigned long long) (m_v >> shift);
+      long long a = 1;
+      long long b = 0;
+      long long c = 0;
+      long long d = 1;
+      std::vector<unsigned long long> quotients;
+      while (y + c != 0 && y + d != 0) {
+        long long const quotient = (x + a) / (y + c);
+        if (quotient != (x + b) / (y + d)) {
+          break;
+        }
+        quotients.push_back((unsigned long long) quotient);
+        long long temp = a - quotient * c;
+        a = c;
+        c = temp;
+        temp = b - quotient * d;
+        b = d;
+        d = temp;
+        temp = x - quotient * y;
+        x = y;
+        y = temp;
+      }
+      if (b == 0) {
+        return false;
+      }
+
+      Integer u = Integer(a) * m_u;
+      u += Integer(b) * m_v;
+      Integer v = Integer(c) * m_u;
+      v += Integer(d) * m_v;
+      m_u = u;
+      m_v = v;
+      // The terms are handed out from the back.
+      m_pending.assign(quotients.rbegin(), quotients.rend());
+      return true;
+    }
+
+    bool m_isFirst;
+    Integer m_first;
+    // The remainders of the Euclidean algorithm, with u > v >= 0.
+    Integer m_u;
+    Integer m_v;
+    bool m_isSmall;
+    unsigned long long m_smallU;
+    unsigned long long m_smallV;
+    // Terms that have been found but not yet handed out, in reverse order.
+    std::vector<unsigned long long> m_pending;
+
+  };
+
+}
+
+std::vector<Integer> aprn::continuedFraction(Rational const& val) {
+  std::vector<Integer> result;
+  Expansion expansion(val);
+  Integer term;
+  while (expansion.next(term)) {
+    result.push_back(term);
+  }
+  return result;
+}
+
+bool aprn::bestApproximation(Rational const& val, Integer const& maxDenominator, Rational& result_out) {
+  if (maxDenominator < Integer(1)) {
+    return false;
+  }
+  if (!(maxDenominator < val.denominator())) {
+    result_out = val;
+    return true;
+  }
+
+  // The convergents p / q of the continued fraction, starting from the two
+  // formal ones, 0 / 1 and 1 / 0. Since the denominator of the value is over the
+  // limit, some convergent's denominator must be as well.
+  Integer previousP(0);
+  Integer previousQ(1);
+  Integer p(1);
+  Integer q(0);
+  Expansion expansion(val);
+  Integer term;
+  while (expansion.next(term)) {
+    Integer nextQ = term * q;
+    nextQ += previousQ;
+    if (maxDenominator < nextQ) {
+      break;
+    }
+    Integer nextP = term * p;
+    nextP += previousP;
+    previousP = p;
+    previousQ = q;
+    p = nextP;
+    q = nextQ;
+  }
+
+  // The best semiconvergent between the last two convergents that is still
+  // within the limit competes with the last convergent. Their distances from
+  // n / d are compared as |P * d - n * Q| / Q, leaving out the common factor of
+  // 1 / d, so that no Rationals as large as the value have to be normalized.
+  Integer const steps = (maxDenominator - previousQ) / q;
+  Integer const semiconvergentP = previousP + steps * p;
+  Integer const semiconvergentQ = previousQ + steps * q;
+  Integer const semiconvergentError = abs(semiconvergentP * val.denominator() - val.numerator() * semiconvergentQ);
+  Integer const convergentError = abs(p * val.denominator() - val.numerator() * q);
+  if (semiconvergentError * q < convergentError * semiconvergentQ) {
+    p = semiconvergentP;
+    q = semiconvergentQ;
+  }
+  result_out = Rational(p);
+  result_out /= Rational(q);
+  return true;
+}
@@ -0,0 +1,294 @@
+#include "../include/matrix.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "../include/math_integer.h"
+#include "../include/product_tree.h"
+#include "../include/serialization.h"
+#include "../include/thread_pool.h"
+
+using namespace aprn;
+
+namespace {
+
+  // Every prime used for the multi-modular determinant lies between 2^30 and
+  // 2^31, so that the product of two residues fits in 64 bits.
+  std::uint64_t const MAX_PRIME = (std::uint64_t(1) << 31) - 1;
+  unsigned long long const PRIME_BITS = 30;
+  // Entries with more bytes than this are reduced with a product tree.
+  std::size_t const TREE_MIN_BYTES = 256;
+
+  std::uint64_t powMod(std::uint64_t base, std::uint64_t exponent, std::uint64_t modulus) {
+    std::uint64_t result = 1;
+    base %= modulus;
+    while (exponent != 0) {
+      if (exponent & 1) {
+        result = result * base % modulus;
+      }
+      base = base * base % modulus;
+      exponent >>= 1;
+    }
+    return result;
+  }
+
+  // Miller-Rabin with the bases 2, 7 and 61, which is exact below 4759123141.
+  bool isPrime(std::uint64_t val) {
+    if (val < 2) {
+      return false;
+    }
+    for (std::uint64_t small : { 2, 3, 5, 7, 61 }) {
+      if (val % small == 0) {
+        return val == small;
+      }
+    }
+    std::uint64_t odd = val - 1;
+    unsigned twos = 0;
+    while (odd % 2 == 0) {
+      odd /= 2;
+      ++twos;
+    }
+    for (std::uint64_t base : { 2, 7, 61 }) {
+      std::uint64_t x = powMod(base, odd, val);
+      if (x == 1 || x == val - 1) {
+        continue;
+      }
+      bool isWitness = true;
+      for (unsigned i = 1; i < twos && isWitness; ++i) {
+        x = x * x % val;
+        isWitness = x != val - 1;
+      }
+      if (isWitness) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Finds the determinant modulo a prime by Gaussian elimination, destroying the
+  // matrix of residues along the way.
+  std::uint64_t determinantMod(std::vector<std::uint64_t>& val, std::size_t size, std::uint64_t prime) {
+    std::uint64_t result = 1;
+    for (std::size_t col = 0; col < size; ++col) {
+      std::size_t pivot = col;
+      while (pivot < size && val[pivot * size + col] == 0) {
+        ++pivot;
+      }
+      if (pivot == size) {
+        return 0;
+      }
+      if (pivot != col) {
+        for (std::size_t j = col; j < size; ++j) {
+          std::swap(val[pivot * size + j], val[col * size + j]);
+        }
+        result = prime - result;
+      }
+      std::uint64_t const* pivotRow = &val[col * size];
+      result = result * pivotRow[col] % prime;
+      std::uint64_t const inverse = powMod(pivotRow[col], prime - 2, prime);
+      for (std::size_t i = col + 1; i < size; ++i) {
+        std::uint64_t* row = &val[i * size];
+        if (row[col] == 0) {
+          continue;
+        }
+        std::uint64_t const factor = prime - row[col] * inverse % prime;
+        for (std::size_t j = col + 1; j < size; ++j) {
+          row[j] = (row[j] + factor * pivotRow[j]) % prime;
+        }
+      }
+    }
+    return result % prime;
+  }
+
+  // Finds the residue of a magnitude, given as little endian bytes, modulo a
+  // prime, four bytes at a time.
+  std::uint64_t residue(std::vector<std::uint8_t> const& bytes, std::uint64_t prime) {
+    std::uint64_t result = 0;
+    std::size_t i = bytes.size();
+    while (i % 4 != 0) {
+      --i;
+      result = ((result << 8) | bytes[i]) % prime;
+    }
+    while (i != 0) {
+      i -= 4;
+      std::uint64_t const word = (std::uint64_t(bytes[i + 3]) << 24) | (std::uint64_t(bytes[i + 2]) << 16) |
+                                 (std::uint64_t(bytes[i + 1]) << 8) | bytes[i];
+      result = ((result << 32) | word) % prime;
+    }
+    return result;
+  }
+
+  // Finds the determinant modulo each of a range of primes. Small entries are
+  // reduced one prime at a time with word arithmetic, and large ones modulo all
+  // of the primes at once, with a product tree.
+  void determinantsMod(Matrix<Integer> const& val, std::vector<Integer> const& primes,
+                       std::size_t begin, std::size_t end, std::vector<Integer>& results_out) {
+    std::size_t const size = val.rows();
+    std::size_t const count = end - begin;
+    std::vector<std::uint64_t> moduli;
+    for (std::size_t k = begin; k < end; ++k) {
+      moduli.push_back((std::uint64_t) (unsigned long long) primes[k]);
+    }
+    ProductTree const tree(std::vector<Integer>(primes.begin() + begin, primes.begin() + end));
+    std::vector<std::vector<std::uint64_t> > residues(count, std::vector<std::uint64_t>(size * size));
+    for (std::size_t entry = 0; entry < size * size; ++entry) {
+      Integer const& current = val.entries()[entry];
+      std::vector<std::uint8_t> const bytes = exportBytes(current);
+      if (bytes.size() > TREE_MIN_BYTES) {
+        std::vector<Integer> const remainders = tree.remainders(current);
+        for (std::size_t k = 0; k < count; ++k) {
+          residues[k][entry] = (std::uint64_t) (unsigned long long) remainders[k];
+        }
+        continue;
+      }
+      bool const isNegative = signum(current) < 0;
+      for (std::size_t k = 0; k < count; ++k) {
+        std::uint64_t const magnitude = residue(bytes, moduli[k]);
+        residues[k][entry] = isNegative && magnitude != 0 ? moduli[k] - magnitude : magnitude;
+      }
+    }
+    for (std::size_t k = 0; k < count; ++k) {
+      results_out[begin + k] = Integer((unsigned long long) determinantMod(residues[k], size, moduli[k]));
+    }
+  }
+
+  // Multiplies each row by the lowest common denominator of its entries, giving
+  // an Integer matrix. The product of the multipliers is stored in scale_out.
+  Matrix<Integer> clearDenominators(Matrix<Rational> const& val, Integer& scale_out) {
+    Matrix<Integer> result(val.rows(), val.cols());
+    Integer scale(1);
+    for (std::size_t i = 0; i < val.rows(); ++i) {
+      Integer multiple(1);
+      for (std::size_t j = 0; j < val.cols(); ++j) {
+        Integer const& denominator = val(i, j).denominator();
+        multiple *= denominator / gcd(multiple, denominator);
+      }
+      for (std::size_t j = 0; j < val.cols(); ++j) {
+        result(i, j) = val(i, j).numerator() * (multiple / val(i, j).denominator());
+      }
+      scale *= multiple;
+    }
+    scale_out = scale;
+    return result;
+  }
+
+}
+
+bool aprn::determinant(Matrix<Rational> const& val, Rational& result_out) {
+  if (val.rows() != val.cols()) {
+    return false;
+  }
+  Integer scale;
+  Integer result;
+  determinant(clearDenominators(val, scale), result);
+  result_out = Rational(result);
+  result_out /= Rational(scale);
+  return true;
+}
+
+std::size_t aprn::rank(Matrix<Rational> const& val) {
+  Integer scale;
+  return rank(clearDenominators(val, scale));
+}
+
+bool aprn::solve(Matrix<Rational> const& lhs, Matrix<Rational> const& rhs, Matrix<Rational>& result_out) {
+  std::size_t const size = lhs.rows();
+  if (lhs.cols() != size || rhs.rows() != size) {
+    return false;
+  }
+  // The rows of lhs and rhs have to be scaled together, so they are cleared as
+  // one matrix and then split apart again.
+  std::size_t const numSystems = rhs.cols();
+  Matrix<Rational> both(size, size + numSystems);
+  for (std::size_t i = 0; i < size; ++i) {
+    for (std::size_t j = 0; j < size; ++j) {
+      both(i, j) = lhs(i, j);
+    }
+    for (std::size_t j = 0; j < numSystems; ++j) {
+      both(i, size + j) = rhs(i, j);
+    }
+  }
+  Integer scale;
+  Matrix<Integer> const cleared = clearDenominators(both, scale);
+  Matrix<Integer> coefficients(size, size);
+  Matrix<Integer> constants(size, numSystems);
+  for (std::size_t i = 0; i < size; ++i) {
+    for (std::size_t j = 0; j < size; ++j) {
+      coefficients(i, j) = cleared(i, j);
+    }
+    for (std::size_t j = 0; j < numSystems; ++j) {
+      constants(i, j) = cleared(i, size + j);
+    }
+  }
+  Matrix<Integer> numerators;
+  Integer denominator;
+  if (!solve(coefficients, constants, numerators, denominator)) {
+    return false;
+  }
+  Matrix<Rational> result(size, numSystems);
+  for (std::size_t i = 0; i < size; ++i) {
+    for (std::size_t j = 0; j < numSystems; ++j) {
+      result(i, j) = Rational(numerators(i, j));
+      result(i, j) /= Rational(denominator);
+    }
+  }
+  result_out = std::move(result);
+  return true;
+}
+
+bool aprn::determinantMultiModular(Matrix<Integer> const& val, Integer& result_out) {
+  std::size_t const size = val.rows();
+  if (val.cols() != size) {
+    return false;
+  }
+  if (size == 0) {
+    result_out = Integer(1);
+    return true;
+  }
+  // Hadamard's bound: the determinant is at most the product of the lengths of
+  // the rows. Each length is at most 2^(ceil(b / 2)), where 2^b bounds the sum
+  // of the squares of the entries of the row.
+  unsigned long long boundBits = 0;
+  for (std::size_t i = 0; i < size; ++i) {
+    Integer squares;
+    for (std::size_t j = 0; j < size; ++j) {
+      squares += val(i, j) * val(i, j);
+    }
+    boundBits += (bitLength(squares) + 1) / 2;
+  }
+  // The product of the primes has to be more than twice the bound, so that
+  // negative determinants can be told apart.
+  std::size_t const numPrimes = (std::size_t) ((boundBits + 1) / PRIME_BITS + 1);
+  std::vector<Integer> primes;
+  primes.reserve(numPrimes);
+  for (std::uint64_t candidate = MAX_PRIME; primes.size() < numPrimes; candidate -= 2) {
+    if (isPrime(candidate)) {
+      primes.push_back(Integer((unsigned long long) candidate));
+    }
+  }
+
+  // The primes are split into one contiguous range for each thread.
+  std::vector<Integer> determinants(numPrimes);
+  std::size_t const numTasks = std::min<std::size_t>(std::max(threadLimit(), 1u), numPrimes);
+  std::vector<std::function<void()> > tasks;
+  for (std::size_t task = 0; task < numTasks; ++task) {
+    std::size_t const begin = numPrimes * task / numTasks;
+    std::size_t const end = numPrimes * (task + 1) / numTasks;
+    tasks.push_back([&val, &primes, &determinants, begin, end]() {
+      determinantsMod(val, primes, begin, end, determinants);
+    });
+  }
+  runTasks(tasks);
+
+  ProductTree const tree(primes);
+  Integer result;
+  tree.crt(determinants, result);
+  if (tree.product() < (result << 1)) {
+    result -= tree.product();
+  }
+  result_out = result;
+  return true;
+}
@@ -0,0 +1,87 @@
+#include "../include/polynomial.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <vector>
+
+#include "../include/math_integer.h"
+#include "../include/serialization.h"
+
+using namespace aprn;
+
+namespace {
+
+  // Products where either polynomial has fewer terms than this are done with the
+  // schoolbook algorithm, since there are too few products to be worth packing.
+  std::size_t const KRONECKER_MIN_TERMS = 4;
+
+  unsigned long long maxBitLength(std::vector<Integer> const& coefficients) {
+    unsigned long long result = 0;
+    for (Integer const& coefficient : coefficients) {
+      result = std::max(result, bitLength(coefficient));
+    }
+    return result;
+  }
+
+  // Evaluates a polynomial at 2^(CHAR_BIT * width), by laying the coefficients out
+  // width bytes apart. The positive and negative coefficients are laid out
+  // separately, so that no borrows are needed, and then subtracted.
+  Integer pack(std::vector<Integer> const& coefficients, std::size_t width) {
+    std::vector<std::uint8_t> positive(coefficients.size() * width, 0);
+    std::vector<std::uint8_t> negative(coefficients.size() * width, 0);
+    for (std::size_t i = 0; i < coefficients.size(); ++i) {
+      std::vector<std::uint8_t>& target = signum(coefficients[i]) < 0 ? negative : positive;
+      exportBytes(coefficients[i], target.data() + i * width, width);
+    }
+    return importBytes(positive.data(), positive.size()) - importBytes(negative.data(), negative.size());
+  }
+
+  // Reads the coefficients back out of a value packed width bytes apart, where
+  // each coefficient is less than half of 2^(CHAR_BIT * width) in magnitude. The
+  // pieces are read as balanced digits: a piece in the top half of its range
+  // stands for a negative coefficient, which borrowed one from the piece above.
+  std::vector<Integer> unpack(Integer const& val, std::size_t width, std::size_t count) {
+    std::vector<std::uint8_t> bytes = exportBytes(val);
+    bytes.resize(count * width, 0);
+    bool const isNegative = signum(val) < 0;
+    Integer const half = Integer(1) << (CHAR_BIT * width - 1);
+    Integer const whole = Integer(1) << (CHAR_BIT * width);
+    std::vector<Integer> result;
+    result.reserve(count);
+    bool hasCarry = false;
+    for (std::size_t i = 0; i < count; ++i) {
+      Integer piece = importBytes(bytes.data() + i * width, width);
+      if (hasCarry) {
+        ++piece;
+      }
+      hasCarry = !(piece < half);
+      if (hasCarry) {
+        piece -= whole;
+      }
+      if (isNegative) {
+        piece.negate();
+      }
+      result.push_back(piece);
+    }
+    return result;
+  }
+
+}
+
+std::vector<Integer> aprn::multiplyCoefficients(std::vector<Integer> const& lhs,
+                                                std::vector<Integer> const& rhs) {
+  if (lhs.empty() || rhs.empty()) {
+    return std::vector<Integer>();
+  }
+  if (std::min(lhs.size(), rhs.size()) < KRONECKER_MIN_TERMS) {
+    return multiplyCoefficients<Integer>(lhs, rhs);
+  }
+  // Each coefficient of the product is a sum of at most min(size) products, so
+  // this many bits (plus one for the sign) keeps them from overlapping.
+  unsigned long long const bits = maxBitLength(lhs) + maxBitLength(rhs) +
+                                  bitLength(Integer((unsigned long long) std::min(lhs.size(), rhs.size()))) + 1;
+  std::size_t const width = (std::size_t) ((bits + CHAR_BIT - 1) / CHAR_BIT);
+  Integer product = pack(lhs, width) * pack(rhs, width);
+  return unpack(product, width, lhs.size() + rhs.size() - 1);
+}
@@ -0,0 +1,126 @@
+#include "../include/product_tree.h"
+
+#include <utility>
+
+#include "../include/math_integer.h"
+
+using namespace aprn;
+
+ProductTree::ProductTree(std::vector<Integer> moduli) :
+  m_levels(),
+  m_coefficientsFlag(new std::once_flag()),
+  m_coefficients() {
+  // Each level is built by multiplying together neighbouring pairs from the
+  // level below it, until only one node is left.
+  m_levels.push_back(std::move(moduli));
+  if (m_levels.back().empty()) {
+    m_levels.push_back(std::vector<Integer>(1, Integer(1)));
+  }
+  while (m_levels.back().size() > 1) {
+    std::vector<Integer> const& below = m_levels.back();
+    std::vector<Integer> level;
+    level.reserve((below.size() + 1) / 2);
+    for (std::size_t i = 0; i + 1 < below.size(); i += 2) {
+      level.push_back(below[i] * below[i + 1]);
+    }
+    if (below.size() % 2 != 0) {
+      level.push_back(below.back());
+    }
+    m_levels.push_back(std::move(level));
+  }
+}
+
+std::vector<Integer> ProductTree::remainders(Integer const& x) const {
+  // The remainder tree: reducing by a node of the tree gives a value that is
+  // still congruent to x modulo each of the node's children, but that is much
+  // smaller than x. So each division on the way down is only about as big as the
+  // node being divided by.
+  std::vector<Integer> current(1, x % product());
+  if (signum(current.front()) < 0) {
+    current.front() += product();
+  }
+  for (std::size_t level = m_levels.size() - 1; level != 0; --level) {
+    std::vector<Integer> const& below = m_levels[level - 1];
+    std::vector<Integer> next(below.size());
+    for (std::size_t i = 0; i < below.size(); ++i) {
+      Integer const& parent = current[i / 2];
+      // A node that was carried up unchanged doesn't need to be reduced again.
+      if (i % 2 == 0 && i + 1 == below.size()) {
+        next[i] = parent;
+      }
+      else {
+        next[i] = parent % below[i];
+      }
+    }
+    current.swap(next);
+  }
+  current.resize(size());
+  return current;
+}
+
+void ProductTree::computeCoefficients() const {
+  // The coefficient for the modulus m is the inverse of M / m modulo m, where M
+  // is the product of all of the moduli. The value of (M / m) mod m can be found
+  // for every modulus at once by running a remainder tree of M over the tree of
+  // the squares of the moduli, since (M mod m^2) / m = (M / m) mod m.
+  std::vector<Integer> current(1, product());
+  for (std::size_t level = m_levels.size() - 1; level != 0; --level) {
+    std::vector<Integer> const& below = m_levels[level - 1];
+    std::vector<Integer> next(below.size());
+    for (std::size_t i = 0; i < below.size(); ++i) {
+      next[i] = current[i / 2] % (below[i] * below[i]);
+    }
+    current.swap(next);
+  }
+  std::vector<Integer> coefficients(size());
+  for (std::size_t i = 0; i < size(); ++i) {
+    Integer const& modulus = m_levels.front()[i];
+    if (!invmod(current[i] / modulus, modulus, coefficients[i])) {
+      // The moduli aren't coprime, so there is no way to reconstruct from them.
+      return;
+    }
+  }
+  m_coefficients.swap(coefficients);
+}
+
+bool ProductTree::crt(std::vector<Integer> const& residues, Integer& result_out) const {
+  if (residues.size() != size()) {
+    return false;
+  }
+  if (size() == 0) {
+    result_out = Integer();
+    return true;
+  }
+  std::call_once(*m_coefficientsFlag, &ProductTree::computeCoefficients, this);
+  if (m_coefficients.size() != size()) {
+    return false;
+  }
+  // The result is the sum of r_i * c_i * (M / m_i). This is built up from the
+  // bottom of the tree, where the value at each node is the sum over its leaves
+  // with M replaced by the node itself. The value at a node with children L and R
+  // is then value(L) * R + value(R) * L.
+  std::vector<Integer> current(size());
+  for (std::size_t i = 0; i < size(); ++i) {
+    Integer const& modulus = m_levels.front()[i];
+    current[i] = residues[i] * m_coefficients[i] % modulus;
+  }
+  for (std::size_t level = 0; level + 1 < m_levels.size(); ++level) {
+    std::vector<Integer> const& nodes = m_levels[level];
+    std::vector<Integer> next;
+    next.reserve((nodes.size() + 1) / 2);
+    for (std::size_t i = 0; i + 1 < nodes.size(); i += 2) {
+      Integer value = current[i] * nodes[i + 1];
+      value += current[i + 1] * nodes[i];
+      next.push_back(value);
+    }
+    if (nodes.size() % 2 != 0) {
+      next.push_back(current.back());
+    }
+    current.swap(next);
+  }
+  result_out = current.front() % product();
+  if (signum(result_out) < 0) {
+    result_out += product();
+  }
+  return true;
+}
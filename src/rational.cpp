@@ -1,12 +1,21 @@
 #include "../include/rational.h"
 
+#include <algorithm>
+#include <cfloat>
 #include <climits>
 #include <cmath>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <sstream>
 
 #include "../include/math_integer.h"
+#include "instrumentation.h"
 
 using namespace aprn;
 
+Rational::Rational() : m_numerator(0), m_denominator(1) {}
+
 Rational::Rational(Integer val) : m_numerator(val), m_denominator(1) {}
 
 Rational::Rational(float val) : Rational((long double) val) {}
@@ -14,31 +23,31 @@ Rational::Rational(float val) : Rational((long double) val) {}
 Rational::Rational(double val) : Rational((long double) val) {}
 
 Rational::Rational(long double val) {
-  const long double MAX_VALUE = std::ldexp(1.0L, std::numeric_limits<int>::max());
-  const long double MIN_VALUE = std::ldexp(1.0L, std::numeric_limits<int>::min());
-  
-  unsigned long long power = 0;
-  while (std::abs(val) >= MAX_VALUE) {
-    val /= MAX_VALUE;
-    power += std::numeric_limits<int>::max();
-  }
-  while (std::abs(val) <= MIN_VALUE) {
-    val *= MIN_VALUE;
-    power -= std::numeric_limits<int>::min();
-  }
-  int small_power;
-  long double fractional = std::abs(std::frexp(val, small_power));
-  m_numerator = (unsigned long long) (fractional * (1ULL << LDBL_MANT_DIG));
-  power += small_power;
-  power -= LDBL_MANT_DIG;
+  // The mantissa is read off 32 bits at a time, which is exact since each step only
+  // moves the binary point. Values that are not finite have no Rational equivalent,
+  // and are taken to be zero.
+  int const BITS_PER_STEP = 32;
+  m_numerator = 0;
+  m_denominator = 1;
+  if (!std::isfinite(val)) {
+    return;
+  }
+  int exponent = 0;
+  long double fractional = std::frexp(std::abs(val), &exponent);
+  while (fractional != 0) {
+    fractional = std::ldexp(fractional, BITS_PER_STEP);
+    long double whole = std::floor(fractional);
+    m_numerator <<= BITS_PER_STEP;
+    m_numerator += (unsigned long long) whole;
+    fractional -= whole;
+    exponent -= BITS_PER_STEP;
+  }
   
-  if (power >= 0) {
-    m_numerator <<= power;
-    m_denominator = 1;
+  if (exponent >= 0) {
+    m_numerator <<= exponent;
   }
   else {
-    m_denominator = 1;
-    m_denominator <<= -power;
+    m_denominator <<= -exponent;
   }
   
   if (val < 0) {
@@ -47,3 +56,190 @@ Rational::Rational(long double val) {
   
   makeValid();
 }
+
+void Rational::makeValid() {
+  // Takes a Rational in invalid form and makes it valid. This means dividing out any
+  // common factors and making the denominator positive.
+  APRN_STATS_SCOPE(RATIONAL_NORMALIZE, std::max(bitLength(m_numerator), bitLength(m_denominator)));
+  if (signum(m_denominator) < 0) {
+    m_numerator.negate();
+    m_denominator.negate();
+  }
+  Integer divisor = gcd(m_numerator, m_denominator);
+  if (divisor != 1 && signum(divisor) != 0) {
+    m_numerator /= divisor;
+    m_denominator /= divisor;
+  }
+}
+
+bool aprn::operator==(Rational const& lhs, Rational const& rhs) {
+  // Both are in lowest terms, so they are equal only if their parts are.
+  return lhs.numerator() == rhs.numerator() && lhs.denominator() == rhs.denominator();
+}
+
+bool aprn::operator<(Rational const& lhs, Rational const& rhs) {
+  // The denominators are positive, so multiplying them across keeps the order.
+  return lhs.numerator() * rhs.denominator() < rhs.numerator() * lhs.denominator();
+}
+
+Rational::operator Integer() const {
+  // Integer division truncates towards zero.
+  return m_numerator / m_denominator;
+}
+
+Rational::operator float() const {
+  return (float) operator long double();
+}
+
+Rational::operator double() const {
+  return (double) operator long double();
+}
+
+Rational::operator long double() const {
+  // The numerator is scaled so that the quotient has a couple more bits than the
+  // mantissa of a long double, and then the top bits of the quotient are converted.
+  // Any exponent that is too large ends up as an infinity in std::ldexp.
+  if (signum(m_numerator) == 0) {
+    return 0.0L;
+  }
+  int const QUOTIENT_BITS = LDBL_MANT_DIG + 2;
+  int const WORD_BITS = std::numeric_limits<unsigned long long>::digits;
+  Integer magnitude = abs(m_numerator);
+  long long shift = QUOTIENT_BITS - ((long long) bitLength(magnitude) - (long long) bitLength(m_denominator));
+  Integer quotient = shift >= 0 ? (magnitude << shift) / m_denominator : magnitude / (m_denominator << -shift);
+  long long dropped = std::max((long long) bitLength(quotient) - WORD_BITS, 0LL);
+  long double result = (long double) (unsigned long long) (quotient >> dropped);
+  result = std::ldexp(result, (int) std::max(std::min(dropped - shift, (long long) INT_MAX), (long long) INT_MIN));
+  return signum(m_numerator) < 0 ? -result : result;
+}
+
+Rational Rational::operator-() const {
+  Rational result(*this);
+  result.negate();
+  return result;
+}
+
+Rational& Rational::negate() {
+  m_numerator.negate();
+  return *this;
+}
+
+Rational& Rational::operator++() {
+  m_numerator += m_denominator;
+  return *this;
+}
+
+Rational& Rational::operator--() {
+  m_numerator -= m_denominator;
+  return *this;
+}
+
+Rational& Rational::operator+=(Rational const& rhs) {
+  // Henrici's method: with g = gcd(b, d),
+  //   a/b + c/d = (a * (d/g) + c * (b/g)) / (b * d/g),
+  // and the only common factors the result can have are factors of g, so the final
+  // gcd is taken with g instead of with the whole denominator.
+  Integer divisor = gcd(m_denominator, rhs.m_denominator);
+  if (divisor == 1) {
+    m_numerator = m_numerator * rhs.m_denominator + rhs.m_numerator * m_denominator;
+    m_denominator *= rhs.m_denominator;
+    return *this;
+  }
+  Integer lhsFactor = m_denominator / divisor;
+  Integer numerator = m_numerator * (rhs.m_denominator / divisor) + rhs.m_numerator * lhsFactor;
+  if (signum(numerator) == 0) {
+    m_numerator = 0;
+    m_denominator = 1;
+    return *this;
+  }
+  Integer common = gcd(numerator, divisor);
+  m_numerator = numerator / common;
+  m_denominator = lhsFactor * (rhs.m_denominator / common);
+  return *this;
+}
+
+Rational& Rational::operator-=(Rational const& rhs) {
+  return operator+=(-rhs);
+}
+
+Rational& Rational::operator*=(Rational const& rhs) {
+  // Common factors are divided out across the fractions before multiplying, so that
+  // the products are already in lowest terms and no gcd of the products is needed.
+  Integer lhsCommon = gcd(m_numerator, rhs.m_denominator);
+  Integer rhsCommon = gcd(rhs.m_numerator, m_denominator);
+  if (signum(lhsCommon) == 0 || signum(rhsCommon) == 0) {
+    m_numerator = 0;
+    m_denominator = 1;
+    return *this;
+  }
+  m_numerator = (m_numerator / lhsCommon) * (rhs.m_numerator / rhsCommon);
+  m_denominator = (m_denominator / rhsCommon) * (rhs.m_denominator / lhsCommon);
+  return *this;
+}
+
+Rational& Rational::operator/=(Rational const& rhs) {
+  // Dividing by zero gives zero, as it does for Integers.
+  if (signum(rhs.m_numerator) == 0) {
+    m_numerator = 0;
+    m_denominator = 1;
+    return *this;
+  }
+  Rational reciprocal;
+  reciprocal.m_numerator = rhs.m_denominator;
+  reciprocal.m_denominator = rhs.m_numerator;
+  if (signum(reciprocal.m_denominator) < 0) {
+    reciprocal.m_numerator.negate();
+    reciprocal.m_denominator.negate();
+  }
+  return operator*=(reciprocal);
+}
+
+Rational& Rational::operator%=(Rational const& rhs) {
+  // The remainder after truncating the quotient towards zero, as for Integers.
+  if (signum(rhs.m_numerator) == 0) {
+    m_numerator = 0;
+    m_denominator = 1;
+    return *this;
+  }
+  Rational quotient(*this);
+  quotient /= rhs;
+  return operator-=(rhs * Rational(Integer(quotient)));
+}
+
+std::ostream& aprn::operator<<(std::ostream& os, Rational const& obj) {
+  // The fraction is put together first, so that the width of the stream applies to
+  // all of it.
+  std::ostringstream output;
+  output.flags(os.flags());
+  output << obj.m_numerator;
+  if (obj.m_denominator != 1) {
+    output.unsetf(std::ios::showpos);
+    output << '/' << obj.m_denominator;
+  }
+  return os << output.str();
+}
+
+std::istream& aprn::operator>>(std::istream& is, Rational& obj) {
+  // A Rational is read as an Integer, optionally followed by a slash and a positive
+  // denominator.
+  Integer numerator;
+  Integer denominator(1);
+  if (!(is >> numerator)) {
+    return is;
+  }
+  if (is.rdbuf()->sgetc() == '/') {
+    is.rdbuf()->sbumpc();
+    std::ios::fmtflags flags = is.flags();
+    is.unsetf(std::ios::skipws);
+    is >> denominator;
+    is.flags(flags);
+    if (!is || signum(denominator) <= 0) {
+      is.setstate(std::ios::failbit);
+      return is;
+    }
+  }
+  obj.m_numerator = numerator;
+  obj.m_denominator = denominator;
+  obj.makeValid();
+  return is;
+}
@@ -0,0 +1,219 @@
+#include "../include/real.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+
+#include "../include/math_integer.h"
+
+using namespace aprn;
+
+Real::Real() : m_mantissa(), m_exponent(0) {}
+
+Real::Real(Integer val) : m_mantissa(val), m_exponent(0) {}
+
+Real::Real(double val) : m_mantissa(), m_exponent(0) {
+  // The double is split into a fraction in [0.5, 1) and a power of two. The
+  // fraction is then scaled up so that all of its bits are stored in an integer.
+  // Infinities and NaNs have no such fraction, and converting them would be
+  // undefined.
+  if (!std::isfinite(val)) {
+    throw std::invalid_argument("Real can't hold an infinite or NaN value");
+  }
+  int power;
+  double fraction = std::frexp(val, &power);
+  int const mantissaBits = std::numeric_limits<double>::digits;
+  m_mantissa = Integer((signed long long) std::ldexp(fraction, mantissaBits));
+  m_exponent = (long long) power - mantissaBits;
+  makeValid();
+}
+
+Real::Real(Integer mantissa, long long exponent) : m_mantissa(mantissa), m_exponent(exponent) {
+  makeValid();
+}
+
+Real::operator double() const {
+  // Round to the number of bits in a double first, so that the conversion of
+  // the mantissa is exact and the only error comes from the rounding. An
+  // exponent outside the range of an int is clamped, and still ends up as an
+  // infinity or a zero in std::ldexp.
+  Real rounded(*this);
+  rounded.round(std::numeric_limits<double>::digits, RoundingMode::Nearest);
+  double mantissa = (double) (signed long long) rounded.m_mantissa;
+  return std::ldexp(mantissa, (int) std::max(std::min(rounded.m_exponent, (long long) INT_MAX), (long long) INT_MIN));
+}
+
+void Real::makeValid() {
+  // The exponent of zero is meaningless, so it is fixed at zero.
+  if (signum(m_mantissa) == 0) {
+    m_exponent = 0;
+  }
+}
+
+Real Real::operator-() const {
+  Real result(*this);
+  return result.negate();
+}
+
+Real& Real::negate() {
+  m_mantissa.negate();
+  return *this;
+}
+
+Real& Real::operator+=(Real const& rhs) {
+  // The mantissa with the larger exponent is shifted so that both mantissas
+  // are in units of the smaller exponent, and then they can be added directly.
+  if (signum(rhs.m_mantissa) == 0) {
+    return *this;
+  }
+  if (signum(m_mantissa) == 0) {
+    return *this = rhs;
+  }
+  if (m_exponent <= rhs.m_exponent) {
+    m_mantissa += rhs.m_mantissa << (unsigned long long) (rhs.m_exponent - m_exponent);
+  }
+  else {
+    m_mantissa <<= (unsigned long long) (m_exponent - rhs.m_exponent);
+    m_mantissa += rhs.m_mantissa;
+    m_exponent = rhs.m_exponent;
+  }
+  makeValid();
+  return *this;
+}
+
+Real& Real::operator-=(Real const& rhs) {
+  return operator+=(-rhs);
+}
+
+Real& Real::operator*=(Real const& rhs) {
+  m_mantissa *= rhs.m_mantissa;
+  m_exponent += rhs.m_exponent;
+  makeValid();
+  return *this;
+}
+
+bool Real::round(unsigned long long precision, RoundingMode mode) {
+  unsigned long long length = bitLength(m_mantissa);
+  if (length <= precision) {
+    return false;
+  }
+  // Chop off the extra bits. The quotient is truncated towards zero, and the
+  // remainder has the same sign as the mantissa.
+  unsigned long long extraBits = length - precision;
+  div_result chopped = div2(m_mantissa, extraBits);
+  int sign = signum(m_mantissa);
+  bool awayFromZero = false;
+  if (signum(chopped.rem) != 0) {
+    switch (mode) {
+    case RoundingMode::Down:
+      awayFromZero = sign < 0;
+      break;
+    case RoundingMode::Up:
+      awayFromZero = sign > 0;
+      break;
+    case RoundingMode::TowardZero:
+      awayFromZero = false;
+      break;
+    case RoundingMode::AwayFromZero:
+      awayFromZero = true;
+      break;
+    case RoundingMode::Nearest:
+    case RoundingMode::NearestAwayFromZero:
+    case RoundingMode::NearestTowardZero:
+      // Compare the remainder against half of the last place kept.
+      {
+        Integer half = Integer(1) << (extraBits - 1);
+        Integer remainder = abs(chopped.rem);
+        bool isTieAway = mode == RoundingMode::NearestAwayFromZero ||
+                         (mode == RoundingMode::Nearest && !even(chopped.quot));
+        awayFromZero = remainder > half || (remainder == half && isTieAway);
+      }
+      break;
+    }
+  }
+  m_mantissa = chopped.quot;
+  if (awayFromZero) {
+    m_mantissa += Integer(sign);
+  }
+  m_exponent += extraBits;
+  makeValid();
+  return signum(chopped.rem) != 0;
+}
+
+namespace {
+
+  // Compares two Reals, returning a negative number, zero or a positive number.
+  // The exact difference is only found when the leading bits of both values are
+  // in the same place, since otherwise it could need a huge shift to line up.
+  int compare(Real const& lhs, Real const& rhs) {
+    int const lhsSign = signum(lhs);
+    int const rhsSign = signum(rhs);
+    if (lhsSign != rhsSign) {
+      return lhsSign < rhsSign ? -1 : 1;
+    }
+    if (lhsSign == 0) {
+      return 0;
+    }
+    // A nonzero value lies in [2^(top - 1), 2^top) in magnitude.
+    long long const lhsTop = lhs.exponent() + (long long) bitLength(lhs.mantissa());
+    long long const rhsTop = rhs.exponent() + (long long) bitLength(rhs.mantissa());
+    if (lhsTop != rhsTop) {
+      return (lhsTop < rhsTop) == (lhsSign > 0) ? -1 : 1;
+    }
+    return signum(lhs - rhs);
+  }
+
+}
+
+bool aprn::operator==(Real const& lhs, Real const& rhs) {
+  return compare(lhs, rhs) == 0;
+}
+
+bool aprn::operator<(Real const& lhs, Real const& rhs) {
+  return compare(lhs, rhs) < 0;
+}
+
+int aprn::signum(Real const& val) {
+  return signum(val.mantissa());
+}
+
+Real aprn::abs(Real const& val) {
+  return signum(val) < 0 ? -val : val;
+}
+
+Real aprn::div(Real const& lhs, Real const& rhs, unsigned long long precision, RoundingMode mode) {
+  if (signum(rhs) == 0 || signum(lhs) == 0) {
+    return Real();
+  }
+  // The dividend is scaled up so that the quotient has at least two more bits
+  // than are needed. Then the remainder only matters in that it makes the value
+  // slightly larger in magnitude than the quotient, which is recorded in an
+  // extra sticky bit so that the final rounding is still correct.
+  unsigned long long lhsLength = bitLength(lhs.mantissa());
+  unsigned long long rhsLength = bitLength(rhs.mantissa());
+  unsigned long long scale = 0;
+  if (precision + 2 + rhsLength > lhsLength) {
+    scale = precision + 2 + rhsLength - lhsLength;
+  }
+  div_result result = div(lhs.mantissa() << scale, rhs.mantissa());
+  Integer mantissa = result.quot << 1;
+  if (signum(result.rem) != 0) {
+    mantissa += Integer(signum(result.quot));
+  }
+  Real quotient(mantissa, lhs.exponent() - rhs.exponent() - (long long) scale - 1);
+  quotient.round(precision, mode);
+  return quotient;
+}
+
+std::ostream& aprn::operator<<(std::ostream& os, Real const& obj) {
+  os << obj.m_mantissa;
+  if (obj.m_exponent != 0) {
+    std::ios::fmtflags oldFlags = os.flags();
+    os << std::dec << std::noshowpos << "*2^" << obj.m_exponent;
+    os.flags(oldFlags);
+  }
+  return os;
+}
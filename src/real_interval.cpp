@@ -0,0 +1,222 @@
+#include "../include/real_interval.h"
+
+#include <algorithm>
+#include <limits>
+#include <ostream>
+
+#include "../include/math_integer.h"
+
+using namespace aprn;
+
+namespace {
+
+  // The radius is only an error bound, so it doesn't need many bits.
+  unsigned long long const RADIUS_PRECISION = 30;
+
+  // The number of extra bits to add on top of what was missing when raising the
+  // precision in refine. This leaves room for the error to grow a little.
+  unsigned long long const REFINE_MARGIN = 16;
+
+  // Gives a power of two that is strictly larger than the magnitude of a nonzero Real.
+  long long upperExponent(Real const& val) {
+    return val.exponent() + (long long) bitLength(val.mantissa());
+  }
+
+  // Gives a power of two that is at most the magnitude of a nonzero Real.
+  long long lowerExponent(Real const& val) {
+    return upperExponent(val) - 1;
+  }
+
+}
+
+unsigned long long const RealInterval::DEFAULT_PRECISION = 64;
+
+RealInterval::RealInterval() : RealInterval(Real()) {}
+
+RealInterval::RealInterval(Real val, unsigned long long precision) :
+  m_midpoint(val),
+  m_radius(),
+  m_precision(precision),
+  m_isInfinite(false) {}
+
+RealInterval::RealInterval(Integer val, unsigned long long precision) :
+  RealInterval(Real(val), precision) {}
+
+RealInterval::RealInterval(Real midpoint, Real radius, unsigned long long precision) :
+  m_midpoint(midpoint),
+  m_radius(abs(radius)),
+  m_precision(precision),
+  m_isInfinite(false) {
+  roundMidpoint();
+  roundRadius();
+}
+
+void RealInterval::roundMidpoint() {
+  // Whatever is lost when rounding the midpoint has to be covered by the radius.
+  Real exact = m_midpoint;
+  if (m_midpoint.round(m_precision, RoundingMode::Nearest)) {
+    m_radius += abs(exact - m_midpoint);
+  }
+}
+
+void RealInterval::roundRadius() {
+  // Rounding the radius up can only make the ball bigger, so it stays valid.
+  m_radius.round(RADIUS_PRECISION, RoundingMode::Up);
+}
+
+void RealInterval::makeInfinite() {
+  m_midpoint = Real();
+  m_radius = Real();
+  m_isInfinite = true;
+}
+
+bool RealInterval::isExact() const {
+  return !m_isInfinite && signum(m_radius) == 0;
+}
+
+bool RealInterval::contains(Real const& val) const {
+  return m_isInfinite || abs(val - m_midpoint) <= m_radius;
+}
+
+bool RealInterval::containsZero() const {
+  return m_isInfinite || abs(m_midpoint) <= m_radius;
+}
+
+bool RealInterval::lower(Real& result_out) const {
+  if (m_isInfinite) {
+    return false;
+  }
+  result_out = m_midpoint - m_radius;
+  return true;
+}
+
+bool RealInterval::upper(Real& result_out) const {
+  if (m_isInfinite) {
+    return false;
+  }
+  result_out = m_midpoint + m_radius;
+  return true;
+}
+
+unsigned long long RealInterval::accuracy() const {
+  if (isExact()) {
+    return std::numeric_limits<unsigned long long>::max();
+  }
+  if (containsZero()) {
+    return 0;
+  }
+  // The midpoint is at least 2^lower, and the radius is less than 2^upper.
+  long long bits = lowerExponent(m_midpoint) - upperExponent(m_radius);
+  return bits > 0 ? (unsigned long long) bits : 0;
+}
+
+RealInterval RealInterval::operator-() const {
+  RealInterval result(*this);
+  return result.negate();
+}
+
+RealInterval& RealInterval::negate() {
+  m_midpoint.negate();
+  return *this;
+}
+
+RealInterval& RealInterval::operator+=(RealInterval const& rhs) {
+  m_precision = std::max(m_precision, rhs.m_precision);
+  if (m_isInfinite || rhs.m_isInfinite) {
+    makeInfinite();
+    return *this;
+  }
+  m_midpoint += rhs.m_midpoint;
+  m_radius += rhs.m_radius;
+  roundMidpoint();
+  roundRadius();
+  return *this;
+}
+
+RealInterval& RealInterval::operator-=(RealInterval const& rhs) {
+  return operator+=(-rhs);
+}
+
+RealInterval& RealInterval::operator*=(RealInterval const& rhs) {
+  m_precision = std::max(m_precision, rhs.m_precision);
+  if (m_isInfinite || rhs.m_isInfinite) {
+    makeInfinite();
+    return *this;
+  }
+  // For x = a + e and y = b + f, with |e| <= r and |f| <= s,
+  //   |xy - ab| <= |a| s + |b| r + r s
+  Real radius = abs(m_midpoint) * rhs.m_radius;
+  radius += abs(rhs.m_midpoint) * m_radius;
+  radius += m_radius * rhs.m_radius;
+  m_midpoint *= rhs.m_midpoint;
+  m_radius = radius;
+  roundMidpoint();
+  roundRadius();
+  return *this;
+}
+
+RealInterval& RealInterval::operator/=(RealInterval const& rhs) {
+  m_precision = std::max(m_precision, rhs.m_precision);
+  if (m_isInfinite || rhs.containsZero()) {
+    makeInfinite();
+    return *this;
+  }
+  // For x = a + e and y = b + f, with |e| <= r and |f| <= s < |b|,
+  //   |x/y - a/b| <= (r + |a/b| s) / (|b| - s)
+  // Every step is rounded up so that the bound stays valid.
+  Real ratio = div(abs(m_midpoint), abs(rhs.m_midpoint), RADIUS_PRECISION, RoundingMode::Up);
+  Real numerator = m_radius + ratio * rhs.m_radius;
+  Real denominator = abs(rhs.m_midpoint) - rhs.m_radius;
+  Real radius = div(numerator, denominator, RADIUS_PRECISION, RoundingMode::Up);
+  // The midpoint can't be divided exactly, but the error is within one unit in
+  // the last place of the rounded quotient.
+  Real midpoint = div(m_midpoint, rhs.m_midpoint, m_precision, RoundingMode::Nearest);
+  if (signum(midpoint) != 0) {
+    radius += Real(Integer(1), midpoint.exponent());
+  }
+  m_midpoint = midpoint;
+  m_radius = radius;
+  roundRadius();
+  return *this;
+}
+
+bool aprn::refine(std::function<RealInterval(unsigned long long)> const& compute,
+                  unsigned long long accuracy, RealInterval& result_out,
+                  unsigned long long initialPrecision, unsigned long long maxPrecision) {
+  // The number of bits lost over a computation tends to stay about the same as
+  // the precision goes up. So rather than blindly doubling the precision, it is
+  // raised by however many bits the previous attempt fell short.
+  unsigned long long precision = std::min(initialPrecision, maxPrecision);
+  bool hasResult = false;
+  while (true) {
+    RealInterval result = compute(precision);
+    unsigned long long resultAccuracy = result.accuracy();
+    if (!hasResult || resultAccuracy >= result_out.accuracy()) {
+      result_out = result;
+      hasResult = true;
+    }
+    if (resultAccuracy >= accuracy) {
+      return true;
+    }
+    if (precision >= maxPrecision) {
+      return false;
+    }
+    unsigned long long nextPrecision;
+    if (resultAccuracy == 0) {
+      // Nothing is known about how many bits are being lost, so fall back to
+      // doubling the precision.
+      nextPrecision = 2 * precision;
+    }
+    else {
+      nextPrecision = precision + (accuracy - resultAccuracy) + REFINE_MARGIN;
+    }
+    precision = std::min(std::max(nextPrecision, precision + 1), maxPrecision);
+  }
+}
+
+std::ostream& aprn::operator<<(std::ostream& os, RealInterval const& obj) {
+  if (obj.m_isInfinite) {
+    return os << "[unbounded]";
+  }
+  return os << '[' << obj.m_midpoint << " +/- " << obj.m_radius << ']';
+}
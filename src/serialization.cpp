@@ -0,0 +1,243 @@
+#include "../include/serialization.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <istream>
+#include <iterator>
+#include <limits>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+using namespace aprn;
+
+namespace {
+
+  // The number of bytes in each limb of the binary format.
+  std::size_t const LIMB_BYTES = sizeof(IntegerView::Limb);
+  // The number of bits of a variable length integer stored in each byte, and the bit
+  // that marks that another byte follows.
+  unsigned const VARINT_BITS = 7;
+  std::uint8_t const VARINT_CONTINUE = 0x80;
+  // The most bytes a variable length integer of 64 bits can take up.
+  std::size_t const MAX_VARINT_BYTES = 10;
+  // Limbs read from a stream are read this many bytes at a time, so that a bad header
+  // can't make a huge amount of memory be allocated up front.
+  std::size_t const STREAM_CHUNK_BYTES = 1 << 20;
+
+  // The header of an integer holds its number of limbs and its sign.
+  unsigned long long makeHeader(IntegerView val) {
+    return 2 * (unsigned long long) val.limbCount() + (val.isNegative() ? 1 : 0);
+  }
+
+  std::size_t varintSize(unsigned long long value) {
+    std::size_t result = 1;
+    while (value >>= VARINT_BITS) {
+      ++result;
+    }
+    return result;
+  }
+
+  // Writes a variable length integer to a buffer, which must have room for it.
+  std::uint8_t* writeVarint(unsigned long long value, std::uint8_t* out) {
+    while (value >= VARINT_CONTINUE) {
+      *out++ = (std::uint8_t) (value | VARINT_CONTINUE);
+      value >>= VARINT_BITS;
+    }
+    *out++ = (std::uint8_t) value;
+    return out;
+  }
+
+  // Adds a byte to a variable length integer that is being read. Returns false if the
+  // integer is too long, or isn't in its shortest form.
+  bool readVarintByte(std::uint8_t byte, std::size_t index, unsigned long long& value) {
+    unsigned shift = VARINT_BITS * (unsigned) index;
+    unsigned long long bits = byte & ~VARINT_CONTINUE;
+    if (index >= MAX_VARINT_BYTES ||
+        (shift != 0 && bits == 0 && !(byte & VARINT_CONTINUE)) ||
+        (bits << shift) >> shift != bits) {
+      return false;
+    }
+    value |= bits << shift;
+    return true;
+  }
+
+  // Splits a header into the number of limbs and the sign, and checks that the sign is
+  // valid.
+  bool readHeader(unsigned long long header, std::size_t& limbCount_out, bool& isNegative_out) {
+    limbCount_out = (std::size_t) (header / 2);
+    isNegative_out = (header % 2 != 0);
+    return (header / 2) <= std::numeric_limits<std::size_t>::max() / LIMB_BYTES &&
+           !(isNegative_out && limbCount_out == 0);
+  }
+
+  // Checks that the top limb of an encoded integer isn't zero.
+  bool hasLeadingZeros(std::uint8_t const* limbs, std::size_t limbCount) {
+    if (limbCount == 0) {
+      return false;
+    }
+    std::uint8_t const* top = limbs + (limbCount - 1) * LIMB_BYTES;
+    return std::all_of(top, top + LIMB_BYTES, [](std::uint8_t byte) { return byte == 0; });
+  }
+
+}
+
+std::size_t aprn::byteLength(IntegerView val) {
+  return val.byteCount();
+}
+
+bool aprn::exportBytes(IntegerView val, void* buffer, std::size_t size, ByteOrder order) {
+  if (size < val.byteCount()) {
+    return false;
+  }
+  std::uint8_t* out = static_cast<std::uint8_t*>(buffer);
+  if (size == 0) {
+    return true;
+  }
+  if (order == ByteOrder::LittleEndian) {
+    if (val.byteCount() != 0) {
+      std::memcpy(out, val.bytes(), val.byteCount());
+    }
+    std::fill(out + val.byteCount(), out + size, 0);
+  }
+  else {
+    std::fill(out, out + (size - val.byteCount()), 0);
+    std::reverse_copy(val.bytes(), val.bytes() + val.byteCount(), out + (size - val.byteCount()));
+  }
+  return true;
+}
+
+std::vector<std::uint8_t> aprn::exportBytes(IntegerView val, ByteOrder order) {
+  std::vector<std::uint8_t> result(val.byteCount());
+  exportBytes(val, result.data(), result.size(), order);
+  return result;
+}
+
+Integer aprn::importBytes(void const* buffer, std::size_t size, ByteOrder order, bool isNegative) {
+  // The digits of an Integer are bytes, least significant first, so they can be
+  // copied straight from a little endian buffer.
+  std::uint8_t const* in = static_cast<std::uint8_t const*>(buffer);
+  Integer result;
+  if (size == 0) {
+    return result;
+  }
+  if (order == ByteOrder::LittleEndian) {
+    result.m_digits.assign(in, in + size);
+  }
+  else {
+    result.m_digits.assign(std::reverse_iterator<std::uint8_t const*>(in + size),
+                           std::reverse_iterator<std::uint8_t const*>(in));
+  }
+  result.m_isNegative = isNegative;
+  result.makeValid();
+  return result;
+}
+
+Integer aprn::importBytes(StorageVector<std::uint8_t>&& bytes, bool isNegative) {
+  Integer result;
+  result.m_digits = std::move(bytes);
+  result.m_isNegative = isNegative;
+  result.makeValid();
+  return result;
+}
+
+std::size_t aprn::serializedSize(IntegerView val) {
+  return varintSize(makeHeader(val)) + val.limbCount() * LIMB_BYTES;
+}
+
+void aprn::serialize(IntegerView val, std::vector<std::uint8_t>& buffer_out) {
+  std::size_t start = buffer_out.size();
+  buffer_out.resize(start + serializedSize(val));
+  std::uint8_t* limbs = writeVarint(makeHeader(val), buffer_out.data() + start);
+  exportBytes(val, limbs, val.limbCount() * LIMB_BYTES, ByteOrder::LittleEndian);
+}
+
+bool aprn::deserialize(void const* buffer, std::size_t size,
+                       IntegerView& view_out, std::size_t& read_out) {
+  std::uint8_t const* in = static_cast<std::uint8_t const*>(buffer);
+  unsigned long long header = 0;
+  std::size_t headerSize = 0;
+  do {
+    if (headerSize == size || !readVarintByte(in[headerSize], headerSize, header)) {
+      return false;
+    }
+  } while (in[headerSize++] & VARINT_CONTINUE);
+
+  std::size_t limbCount;
+  bool isNegative;
+  if (!readHeader(header, limbCount, isNegative) ||
+      limbCount > (size - headerSize) / LIMB_BYTES ||
+      hasLeadingZeros(in + headerSize, limbCount)) {
+    return false;
+  }
+  view_out = IntegerView(in + headerSize, limbCount, isNegative);
+  read_out = headerSize + limbCount * LIMB_BYTES;
+  return true;
+}
+
+bool aprn::deserialize(void const* buffer, std::size_t size,
+                       Integer& result_out, std::size_t& read_out) {
+  IntegerView view;
+  if (!deserialize(buffer, size, view, read_out)) {
+    return false;
+  }
+  result_out = view.toInteger();
+  return true;
+}
+
+std::ostream& aprn::writeBinary(std::ostream& os, IntegerView val) {
+  // The limbs are written straight from the view, followed by the zeros that pad out
+  // the top limb, so that the integer isn't copied.
+  std::uint8_t header[MAX_VARINT_BYTES];
+  std::uint8_t const padding[LIMB_BYTES] = {};
+  std::size_t headerSize = writeVarint(makeHeader(val), header) - header;
+  os.write(reinterpret_cast<char const*>(header), headerSize);
+  if (val.byteCount() != 0) {
+    os.write(reinterpret_cast<char const*>(val.bytes()), val.byteCount());
+  }
+  os.write(reinterpret_cast<char const*>(padding), val.limbCount() * LIMB_BYTES - val.byteCount());
+  return os;
+}
+
+std::istream& aprn::readBinary(std::istream& is, Integer& result_out) {
+  unsigned long long header = 0;
+  std::size_t headerSize = 0;
+  std::uint8_t byte;
+  do {
+    int next = is.get();
+    if (next == std::char_traits<char>::eof()) {
+      is.setstate(std::ios::failbit);
+      return is;
+    }
+    byte = (std::uint8_t) next;
+    if (!readVarintByte(byte, headerSize++, header)) {
+      is.setstate(std::ios::failbit);
+      return is;
+    }
+  } while (byte & VARINT_CONTINUE);
+
+  std::size_t limbCount;
+  bool isNegative;
+  if (!readHeader(header, limbCount, isNegative)) {
+    is.setstate(std::ios::failbit);
+    return is;
+  }
+  StorageVector<std::uint8_t> limbs;
+  std::size_t remaining = limbCount * LIMB_BYTES;
+  while (remaining != 0) {
+    std::size_t chunk = std::min(remaining, STREAM_CHUNK_BYTES);
+    std::size_t start = limbs.size();
+    limbs.resize(start + chunk);
+    if (!is.read(reinterpret_cast<char*>(limbs.data() + start), chunk)) {
+      return is;
+    }
+    remaining -= chunk;
+  }
+  if (hasLeadingZeros(limbs.data(), limbCount)) {
+    is.setstate(std::ios::failbit);
+    return is;
+  }
+  result_out = importBytes(limbs.data(), limbs.size(), ByteOrder::LittleEndian, isNegative);
+  return is;
+}
@@ -0,0 +1,210 @@
+#include "../include/stats.h"
+
+#include <atomic>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+#include "../include/storage.h"
+#include "instrumentation.h"
+
+using namespace aprn;
+using namespace aprn::instrumentation;
+
+namespace {
+
+  char const* const OPERATION_NAMES[NUM_OPERATIONS] = {
+    "add",
+    "subtract",
+    "multiply",
+    "divide",
+    "shift",
+    "gcd",
+    "pow",
+    "to_string",
+    "from_string",
+    "rational_normalize"
+  };
+  // One bucket for zero, and one for each possible bit length of a size.
+  std::size_t const NUM_BUCKETS = 65;
+
+#ifdef APRN_STATS
+  // The counters are only ever added to, with relaxed atomics, so that threads
+  // don't have to wait for each other to record their operations.
+  struct Counters {
+    std::atomic<unsigned long long> calls{0};
+    std::atomic<unsigned long long> nanoseconds{0};
+    std::atomic<unsigned long long> allocatedBytes{0};
+    std::atomic<unsigned long long> sizeHistogram[NUM_BUCKETS] = {};
+  };
+
+  struct TraceEvent {
+    Operation operation;
+    unsigned long long bits;
+    unsigned thread;
+    long long start;
+    long long duration;
+  };
+
+  struct Recorder {
+    Counters operations[NUM_OPERATIONS];
+    std::atomic<unsigned long long> allocations{0};
+    std::atomic<unsigned long long> allocatedBytes{0};
+    // Events are only taken while a trace is running, and then under the lock.
+    std::atomic<bool> isTracing{false};
+    std::mutex traceMutex;
+    std::vector<TraceEvent> events;
+    std::size_t maxEvents = 0;
+    std::chrono::steady_clock::time_point traceStart;
+    std::atomic<unsigned> nextThread{0};
+  };
+
+  Recorder& recorder() {
+    static Recorder result;
+    return result;
+  }
+
+  // The bytes allocated by this thread so far, which the scopes use to work out
+  // how much each operation allocated.
+  thread_local unsigned long long threadAllocatedBytes = 0;
+
+  // A small number for each thread, for the trace.
+  unsigned threadNumber() {
+    thread_local unsigned const number = recorder().nextThread.fetch_add(1, std::memory_order_relaxed);
+    return number;
+  }
+
+  std::size_t bucket(unsigned long long bits) {
+    std::size_t result = 0;
+    while (bits != 0) {
+      bits >>= 1;
+      ++result;
+    }
+    return result;
+  }
+#endif
+
+}
+
+#ifdef APRN_STATS
+void aprn::recordAllocation(std::size_t bytes) {
+  Recorder& current = recorder();
+  current.allocations.fetch_add(1, std::memory_order_relaxed);
+  current.allocatedBytes.fetch_add(bytes, std::memory_order_relaxed);
+  threadAllocatedBytes += bytes;
+}
+
+instrumentation::Scope::Scope(Operation operation, unsigned long long bits) :
+    m_operation(operation),
+    m_bits(bits),
+    m_allocatedBytes(threadAllocatedBytes),
+    m_start(std::chrono::steady_clock::now()) {
+}
+
+instrumentation::Scope::~Scope() {
+  auto end = std::chrono::steady_clock::now();
+  long long duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - m_start).count();
+  Recorder& current = recorder();
+  Counters& counters = current.operations[m_operation];
+  counters.calls.fetch_add(1, std::memory_order_relaxed);
+  counters.nanoseconds.fetch_add((unsigned long long) duration, std::memory_order_relaxed);
+  counters.allocatedBytes.fetch_add(threadAllocatedBytes - m_allocatedBytes, std::memory_order_relaxed);
+  counters.sizeHistogram[bucket(m_bits)].fetch_add(1, std::memory_order_relaxed);
+  if (current.isTracing.load(std::memory_order_relaxed)) {
+    std::lock_guard<std::mutex> lock(current.traceMutex);
+    long long start = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      m_start - current.traceStart).count();
+    // Operations that started before the trace did are left out.
+    if (current.isTracing.load(std::memory_order_relaxed) && start >= 0 &&
+        current.events.size() < current.maxEvents) {
+      current.events.push_back({ m_operation, m_bits, threadNumber(), start, duration });
+    }
+  }
+}
+#endif
+
+Stats aprn::stats() {
+  Stats result;
+  result.allocations = 0;
+  result.allocatedBytes = 0;
+#ifdef APRN_STATS
+  Recorder& current = recorder();
+  result.isEnabled = true;
+  for (std::size_t i = 0; i < NUM_OPERATIONS; ++i) {
+    Counters const& counters = current.operations[i];
+    OperationStats operation;
+    operation.name = OPERATION_NAMES[i];
+    operation.calls = counters.calls.load(std::memory_order_relaxed);
+    operation.nanoseconds = counters.nanoseconds.load(std::memory_order_relaxed);
+    operation.allocatedBytes = counters.allocatedBytes.load(std::memory_order_relaxed);
+    for (std::size_t j = 0; j < NUM_BUCKETS; ++j) {
+      operation.sizeHistogram.push_back(counters.sizeHistogram[j].load(std::memory_order_relaxed));
+    }
+    result.operations.push_back(operation);
+  }
+  result.allocations = current.allocations.load(std::memory_order_relaxed);
+  result.allocatedBytes = current.allocatedBytes.load(std::memory_order_relaxed);
+#else
+  result.isEnabled = false;
+#endif
+  return result;
+}
+
+void aprn::resetStats() {
+#ifdef APRN_STATS
+  Recorder& current = recorder();
+  for (Counters& counters : current.operations) {
+    counters.calls.store(0, std::memory_order_relaxed);
+    counters.nanoseconds.store(0, std::memory_order_relaxed);
+    counters.allocatedBytes.store(0, std::memory_order_relaxed);
+    for (auto& count : counters.sizeHistogram) {
+      count.store(0, std::memory_order_relaxed);
+    }
+  }
+  current.allocations.store(0, std::memory_order_relaxed);
+  current.allocatedBytes.store(0, std::memory_order_relaxed);
+#endif
+}
+
+bool aprn::startTrace(std::size_t maxEvents) {
+#ifdef APRN_STATS
+  Recorder& current = recorder();
+  std::lock_guard<std::mutex> lock(current.traceMutex);
+  current.events.clear();
+  current.maxEvents = maxEvents;
+  current.traceStart = std::chrono::steady_clock::now();
+  current.isTracing.store(true, std::memory_order_relaxed);
+  return true;
+#else
+  (void) maxEvents;
+  return false;
+#endif
+}
+
+void aprn::stopTrace() {
+#ifdef APRN_STATS
+  Recorder& current = recorder();
+  std::lock_guard<std::mutex> lock(current.traceMutex);
+  current.isTracing.store(false, std::memory_order_relaxed);
+#endif
+}
+
+bool aprn::writeTrace(std::ostream& os) {
+  // Each event is a complete event ("X"), with its times in microseconds.
+  os << "{\"traceEvents\":[";
+#ifdef APRN_STATS
+  Recorder& current = recorder();
+  std::lock_guard<std::mutex> lock(current.traceMutex);
+  for (std::size_t i = 0; i < current.events.size(); ++i) {
+    TraceEvent const& event = current.events[i];
+    os << (i == 0 ? "\n" : ",\n");
+    os << "{\"name\":\"" << OPERATION_NAMES[event.operation] << "\",\"cat\":\"aprn\",\"ph\":\"X\"";
+    os << ",\"ts\":" << event.start / 1000 << '.' << (char) ('0' + event.start / 100 % 10);
+    os << ",\"dur\":" << event.duration / 1000 << '.' << (char) ('0' + event.duration / 100 % 10);
+    os << ",\"pid\":1,\"tid\":" << event.thread;
+    os << ",\"args\":{\"bits\":" << event.bits << "}}";
+  }
+#endif
+  os << "\n],\"displayTimeUnit\":\"ns\"}\n";
+  return (bool) os;
+}
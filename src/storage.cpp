@@ -0,0 +1,142 @@
+#include "../include/storage.h"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define APRN_HAS_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+using namespace aprn;
+
+namespace {
+
+  // The settings of mapped storage, and the blocks that are currently mapped along with
+  // their mapped sizes. Blocks are only looked up when they are large, so the lock is
+  // never taken for everyday Integers.
+  struct MappedStorage {
+    std::mutex mutex;
+    bool isEnabled = false;
+    std::string directory;
+    std::size_t threshold = MIN_MAPPED_BYTES;
+    std::unordered_map<void*, std::size_t> blocks;
+    std::atomic<std::size_t> mappedBytes{0};
+  };
+
+  MappedStorage& mappedStorage() {
+    static MappedStorage storage;
+    return storage;
+  }
+
+#ifdef APRN_HAS_MMAP
+  // Maps a new file of at least the given size, returning null if it can't be done.
+  void* mapFile(std::string const& directory, std::size_t& bytes) {
+    std::size_t pageSize = (std::size_t) sysconf(_SC_PAGESIZE);
+    bytes = (bytes + pageSize - 1) / pageSize * pageSize;
+    std::string path = directory + "/aprn-XXXXXX";
+    std::vector<char> name(path.begin(), path.end());
+    name.push_back('\0');
+    int fd = mkstemp(name.data());
+    if (fd < 0) {
+      return nullptr;
+    }
+    // The file is unlinked straight away, so that it goes away with the mapping.
+    unlink(name.data());
+    void* block = MAP_FAILED;
+    if (ftruncate(fd, (off_t) bytes) == 0) {
+      block = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    return block == MAP_FAILED ? nullptr : block;
+  }
+#endif
+
+}
+
+bool aprn::setMappedStorage(std::string const& directory, std::size_t threshold) {
+#ifdef APRN_HAS_MMAP
+  // A small file is mapped to check that the directory can be used.
+  std::size_t testBytes = 1;
+  void* test = mapFile(directory, testBytes);
+  if (test == nullptr) {
+    return false;
+  }
+  munmap(test, testBytes);
+  MappedStorage& storage = mappedStorage();
+  std::lock_guard<std::mutex> lock(storage.mutex);
+  storage.isEnabled = true;
+  storage.directory = directory;
+  storage.threshold = std::max(threshold, MIN_MAPPED_BYTES);
+  return true;
+#else
+  (void) directory;
+  (void) threshold;
+  return false;
+#endif
+}
+
+void aprn::disableMappedStorage() {
+  MappedStorage& storage = mappedStorage();
+  std::lock_guard<std::mutex> lock(storage.mutex);
+  storage.isEnabled = false;
+}
+
+std::size_t aprn::mappedBytes() {
+  return mappedStorage().mappedBytes.load(std::memory_order_relaxed);
+}
+
+void* aprn::allocateStorage(std::size_t bytes) {
+#ifdef APRN_HAS_MMAP
+  MappedStorage& storage = mappedStorage();
+  std::string directory;
+  {
+    std::lock_guard<std::mutex> lock(storage.mutex);
+    if (storage.isEnabled && bytes >= storage.threshold) {
+      directory = storage.directory;
+    }
+  }
+  if (!directory.empty()) {
+    // The file is made outside of the lock, since it can be slow. If it fails, then
+    // the heap is used instead.
+    std::size_t mappedSize = bytes;
+    void* block = mapFile(directory, mappedSize);
+    if (block != nullptr) {
+      std::lock_guard<std::mutex> lock(storage.mutex);
+      storage.blocks.emplace(block, mappedSize);
+      storage.mappedBytes += mappedSize;
+      return block;
+    }
+  }
+#endif
+  return ::operator new(bytes);
+}
+
+void aprn::deallocateStorage(void* block, std::size_t bytes) {
+#ifdef APRN_HAS_MMAP
+  MappedStorage& storage = mappedStorage();
+  std::size_t mappedSize = 0;
+  {
+    std::lock_guard<std::mutex> lock(storage.mutex);
+    auto it = storage.blocks.find(block);
+    if (it != storage.blocks.end()) {
+      mappedSize = it->second;
+      storage.blocks.erase(it);
+    }
+  }
+  if (mappedSize != 0) {
+    storage.mappedBytes -= mappedSize;
+    munmap(block, mappedSize);
+    return;
+  }
+#endif
+  (void) bytes;
+  ::operator delete(block);
+}
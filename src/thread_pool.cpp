@@ -0,0 +1,187 @@
+#include "../include/thread_pool.h"
+
+#include <algorithm>
+#include <exception>
+
+#include "../include/async.h"
+
+using namespace aprn;
+
+namespace {
+
+  // The pool that the current thread is a worker of (if any), and its index.
+  thread_local ThreadPool* currentPool = nullptr;
+  thread_local std::size_t currentIndex = 0;
+
+  thread_local unsigned currentThreadLimit = 1;
+
+  std::mutex sharedPoolMutex;
+  std::unique_ptr<ThreadPool> sharedPool;
+  unsigned sharedPoolSize = 0;
+
+}
+
+ThreadPool::ThreadPool(unsigned threads) :
+  m_queues(),
+  m_threads(),
+  m_mutex(),
+  m_condition(),
+  m_pending(0),
+  m_nextQueue(0),
+  m_isStopping(false) {
+  threads = std::max(threads, 1u);
+  for (unsigned i = 0; i < threads; ++i) {
+    m_queues.emplace_back(new Queue());
+  }
+  for (unsigned i = 0; i < threads; ++i) {
+    m_threads.emplace_back(&ThreadPool::work, this, i);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_isStopping = true;
+  }
+  m_condition.notify_all();
+  for (std::thread& thread : m_threads) {
+    thread.join();
+  }
+}
+
+bool ThreadPool::runPendingTask() {
+  Task task;
+  if (!pop(task)) {
+    return false;
+  }
+  task();
+  return true;
+}
+
+void ThreadPool::push(Task task) {
+  // Workers add to their own queues. Other threads spread their tasks out over
+  // all of the queues.
+  std::size_t index = currentPool == this ?
+    currentIndex :
+    m_nextQueue.fetch_add(1, std::memory_order_relaxed) % m_queues.size();
+  // The count goes up before the task can be taken, so that it never goes below zero.
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_pending;
+  }
+  {
+    std::lock_guard<std::mutex> lock(m_queues[index]->mutex);
+    m_queues[index]->tasks.push_back(std::move(task));
+  }
+  m_condition.notify_one();
+}
+
+bool ThreadPool::pop(Task& task_out) {
+  // A worker looks at its own queue first, taking the newest task. Then it (or a
+  // thread from outside the pool) goes around the other queues, taking the oldest.
+  std::size_t first = 0;
+  if (currentPool == this) {
+    Queue& own = *m_queues[currentIndex];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    if (!own.tasks.empty()) {
+      task_out = std::move(own.tasks.back());
+      own.tasks.pop_back();
+      --m_pending;
+      return true;
+    }
+    first = currentIndex + 1;
+  }
+  for (std::size_t i = 0; i < m_queues.size(); ++i) {
+    Queue& other = *m_queues[(first + i) % m_queues.size()];
+    std::lock_guard<std::mutex> lock(other.mutex);
+    if (!other.tasks.empty()) {
+      task_out = std::move(other.tasks.front());
+      other.tasks.pop_front();
+      --m_pending;
+      return true;
+    }
+  }
+  return false;
+}
+
+void ThreadPool::work(std::size_t index) {
+  currentPool = this;
+  currentIndex = index;
+  while (true) {
+    if (runPendingTask()) {
+      continue;
+    }
+    // Sleep until there is something to do. The pool only stops once every task
+    // has been run.
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_condition.wait(lock, [this]() { return m_isStopping || m_pending != 0; });
+    if (m_isStopping && m_pending == 0) {
+      return;
+    }
+  }
+}
+
+ThreadPool& aprn::threadPool() {
+  std::lock_guard<std::mutex> lock(sharedPoolMutex);
+  if (!sharedPool) {
+    unsigned threads = sharedPoolSize != 0 ? sharedPoolSize : std::thread::hardware_concurrency();
+    sharedPool.reset(new ThreadPool(threads));
+  }
+  return *sharedPool;
+}
+
+bool aprn::setThreadPoolSize(unsigned threads) {
+  std::lock_guard<std::mutex> lock(sharedPoolMutex);
+  if (sharedPool) {
+    return false;
+  }
+  sharedPoolSize = threads;
+  return true;
+}
+
+unsigned aprn::threadLimit() {
+  return currentThreadLimit;
+}
+
+void aprn::setThreadLimit(unsigned threads) {
+  currentThreadLimit = std::max(threads, 1u);
+}
+
+void aprn::runTasks(std::vector<std::function<void()>> const& tasks, bool isParallel) {
+  if (!isParallel || tasks.size() <= 1) {
+    for (std::function<void()> const& task : tasks) {
+      task();
+    }
+    return;
+  }
+  ThreadPool& pool = threadPool();
+  CancellationToken token = currentCancellationToken();
+  std::vector<std::future<void>> futures;
+  for (std::size_t i = 1; i < tasks.size(); ++i) {
+    std::function<void()> const& task = tasks[i];
+    futures.push_back(pool.submit([&task, token]() {
+      CancellationScope scope(token);
+      task();
+    }));
+  }
+  std::exception_ptr error;
+  try {
+    tasks[0]();
+  }
+  catch (...) {
+    error = std::current_exception();
+  }
+  for (std::future<void>& future : futures) {
+    try {
+      pool.wait(future);
+    }
+    catch (...) {
+      if (!error) {
+        error = std::current_exception();
+      }
+    }
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
@@ -0,0 +1,163 @@
+#include "../include/thresholds.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+// A header written by the tune program can replace the defaults below.
+#if defined(__has_include)
+#if __has_include("tuned_thresholds.h")
+#include "tuned_thresholds.h"
+#endif
+#endif
+
+#ifndef APRN_KARATSUBA_THRESHOLD
+#define APRN_KARATSUBA_THRESHOLD 32
+#endif
+#ifndef APRN_PARALLEL_THRESHOLD
+#define APRN_PARALLEL_THRESHOLD 1024
+#endif
+#ifndef APRN_RECURSIVE_DIVISION_THRESHOLD
+#define APRN_RECURSIVE_DIVISION_THRESHOLD 128
+#endif
+#ifndef APRN_RADIX_CONVERSION_THRESHOLD
+#define APRN_RADIX_CONVERSION_THRESHOLD 8
+#endif
+
+using namespace aprn;
+
+namespace {
+
+  struct CurrentThresholds {
+    std::atomic<std::size_t> karatsuba;
+    std::atomic<std::size_t> parallel;
+    std::atomic<std::size_t> recursiveDivision;
+    std::atomic<std::size_t> radixConversion;
+  };
+
+  void store(CurrentThresholds& current, Thresholds const& values) {
+    // Karatsuba and the recursive division both split their operands in half,
+    // which would never reach the base case for operands of a single limb.
+    current.karatsuba.store(std::max<std::size_t>(values.karatsuba, 2), std::memory_order_relaxed);
+    current.parallel.store(std::max<std::size_t>(values.parallel, 1), std::memory_order_relaxed);
+    current.recursiveDivision.store(std::max<std::size_t>(values.recursiveDivision, 2),
+                                    std::memory_order_relaxed);
+    current.radixConversion.store(std::max<std::size_t>(values.radixConversion, 1),
+                                  std::memory_order_relaxed);
+  }
+
+  CurrentThresholds& currentThresholds() {
+    // The thresholds are set up the first time that any of them is needed. The
+    // APRN_THRESHOLDS environment variable can name a file to read them from,
+    // which is ignored if it can't be read.
+    static CurrentThresholds* current = []() {
+      static CurrentThresholds result;
+      Thresholds values = defaultThresholds();
+      char const* path = std::getenv("APRN_THRESHOLDS");
+      if (path != nullptr) {
+        std::ifstream file(path);
+        Thresholds loaded = values;
+        if (file && readThresholds(file, loaded)) {
+          values = loaded;
+        }
+      }
+      store(result, values);
+      return &result;
+    }();
+    return *current;
+  }
+
+  // Finds the field of a Thresholds with a certain name.
+  std::size_t* findField(Thresholds& values, std::string const& name) {
+    if (name == "karatsuba") {
+      return &values.karatsuba;
+    }
+    if (name == "parallel") {
+      return &values.parallel;
+    }
+    if (name == "recursiveDivision") {
+      return &values.recursiveDivision;
+    }
+    if (name == "radixConversion") {
+      return &values.radixConversion;
+    }
+    return nullptr;
+  }
+
+}
+
+Thresholds aprn::defaultThresholds() {
+  Thresholds result;
+  result.karatsuba = APRN_KARATSUBA_THRESHOLD;
+  result.parallel = APRN_PARALLEL_THRESHOLD;
+  result.recursiveDivision = APRN_RECURSIVE_DIVISION_THRESHOLD;
+  result.radixConversion = APRN_RADIX_CONVERSION_THRESHOLD;
+  return result;
+}
+
+Thresholds aprn::thresholds() {
+  CurrentThresholds& current = currentThresholds();
+  Thresholds result;
+  result.karatsuba = current.karatsuba.load(std::memory_order_relaxed);
+  result.parallel = current.parallel.load(std::memory_order_relaxed);
+  result.recursiveDivision = current.recursiveDivision.load(std::memory_order_relaxed);
+  result.radixConversion = current.radixConversion.load(std::memory_order_relaxed);
+  return result;
+}
+
+void aprn::setThresholds(Thresholds const& values) {
+  store(currentThresholds(), values);
+}
+
+bool aprn::readThresholds(std::istream& is, Thresholds& result_out) {
+  Thresholds result = result_out;
+  std::string line;
+  while (std::getline(is, line)) {
+    std::size_t comment = line.find('#');
+    if (comment != std::string::npos) {
+      line.erase(comment);
+    }
+    std::size_t equals = line.find('=');
+    if (equals == std::string::npos) {
+      // Only blank lines are allowed to have no value.
+      if (line.find_first_not_of(" \t\r") != std::string::npos) {
+        return false;
+      }
+      continue;
+    }
+    std::istringstream name(line.substr(0, equals));
+    std::istringstream value(line.substr(equals + 1));
+    std::string field;
+    unsigned long long number;
+    std::string rest;
+    if (!(name >> field) || (name >> rest) || !(value >> number) || (value >> rest)) {
+      return false;
+    }
+    std::size_t* target = findField(result, field);
+    if (target == nullptr) {
+      return false;
+    }
+    *target = (std::size_t) number;
+  }
+  result_out = result;
+  return true;
+}
+
+void aprn::writeThresholds(std::ostream& os, Thresholds const& values) {
+  os << "karatsuba = " << values.karatsuba << '\n';
+  os << "parallel = " << values.parallel << '\n';
+  os << "recursiveDivision = " << values.recursiveDivision << '\n';
+  os << "radixConversion = " << values.radixConversion << '\n';
+}
+
+bool aprn::loadThresholds(std::string const& path) {
+  std::ifstream file(path);
+  Thresholds values = thresholds();
+  if (!file || !readThresholds(file, values)) {
+    return false;
+  }
+  setThresholds(values);
+  return true;
+}
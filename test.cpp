@@ -1,11 +1,1498 @@
 #include "include/integer.h"
+#include "include/async.h"
+#include "include/binary_splitting.h"
+#include "include/cpu_dispatch.h"
+#include "include/decimal.h"
+#include "include/fixed_integer.h"
+#include "include/hash.h"
+#include "include/integer_array.h"
+#include "include/integer_view.h"
+#include "include/math_integer.h"
+#include "include/math_rational.h"
+#include "include/matrix.h"
+#include "include/polynomial.h"
+#include "include/product_tree.h"
+#include "include/random.h"
+#include "include/rational.h"
+#include "include/real.h"
+#include "include/real_interval.h"
+#include "include/serialization.h"
+#include "include/stats.h"
+#include "include/storage.h"
+#include "include/thread_pool.h"
+#include "include/thresholds.h"
+#include <algorithm>
+#include <atomic>
 #include <iostream>
 #include <iomanip>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <unordered_set>
 #include <ctime>
+#include <cstdint>
 #include <cstdlib>
+#include <functional>
+#include <future>
+#include <vector>
 
 using namespace aprn;
 
+namespace {
+  
+  int num_failed_checks = 0;
+  
+  // Reports a check that failed, so that all of the failures are listed at once.
+  void check(bool condition, char const* description) {
+    if (!condition) {
+      std::cout << "check failed: " << description << '\n';
+      ++num_failed_checks;
+    }
+  }
+  
+  void check_binary_splitting() {
+    // The partial sums of e = sum 1 / k! match a term by term sum. Scaled by
+    // k!, the sum up to k is a whole number.
+    SeriesTerm const one = [](unsigned long long) { return Integer(1); };
+    SeriesTerm const index = [](unsigned long long k) { return Integer(k == 0 ? 1 : k); };
+    Integer scaled_sum(1);
+    Integer factorial(1);
+    for (unsigned long long k = 0; k < 40; ++k) {
+      if (k != 0) {
+        scaled_sum = scaled_sum * Integer(k) + Integer(1);
+        factorial *= Integer(k);
+      }
+      series_result partial = binarySplit(0, k + 1, one, index, one);
+      check(partial.t * factorial == scaled_sum * partial.q, "binarySplit sums the series for e");
+    }
+    
+    series_result const empty = binarySplit(5, 5, one, index, one);
+    check(empty.p == Integer(1) && empty.q == Integer(1) && empty.t == Integer(), "binarySplit of an empty range");
+    
+    // Splitting a range in two and combining gives the same fraction, and so
+    // does evaluating with several threads.
+    SeriesTerm const alternating = [](unsigned long long k) { return Integer(k % 2 == 0 ? 1 : -1); };
+    SeriesTerm const odd = [](unsigned long long k) { return Integer(2 * k + 1); };
+    series_result const whole = binarySplit(0, 200, alternating, odd, index);
+    series_result const joined = combine(binarySplit(0, 73, alternating, odd, index),
+                                         binarySplit(73, 200, alternating, odd, index));
+    series_result const threaded = binarySplit(0, 200, alternating, odd, index, 4);
+    check(joined.t * whole.q == whole.t * joined.q && joined.p == whole.p, "binarySplit combines ranges");
+    check(threaded.t * whole.q == whole.t * threaded.q, "binarySplit gives the same result on threads");
+    
+    // Cancelling the token of the calling thread stops the work on every
+    // thread. Here it is cancelled from inside one of the terms.
+    CancellationToken token;
+    SeriesTerm const cancelling = [token](unsigned long long k) mutable {
+      if (k == 10) {
+        token.cancel();
+      }
+      return Integer(2 * k + 1);
+    };
+    bool is_cancelled = false;
+    try {
+      CancellationScope const scope(token);
+      binarySplit(0, 4000, alternating, cancelling, index, 4);
+    }
+    catch (OperationCancelled const&) {
+      is_cancelled = true;
+    }
+    check(is_cancelled && token.isCancelled(), "binarySplit stops on every thread when cancelled");
+  }
+  
+  void check_real() {
+    // Doubles convert exactly, and back again.
+    double const values[] = { 0.0, 1.0, -0.1, 3.141592653589793, 1e300, -5e-324, 123456789.125 };
+    for (double value : values) {
+      check((double) Real(value) == value, "Real converts doubles exactly");
+    }
+    bool hasThrown = false;
+    try {
+      Real infinite(std::numeric_limits<double>::infinity());
+    }
+    catch (std::invalid_argument const&) {
+      hasThrown = true;
+    }
+    check(hasThrown, "Real rejects infinity");
+    hasThrown = false;
+    try {
+      Real notANumber(std::nan(""));
+    }
+    catch (std::invalid_argument const&) {
+      hasThrown = true;
+    }
+    check(hasThrown, "Real rejects NaN");
+    // Exponents outside the range of an int still give an infinity or a zero.
+    double const infinity = std::numeric_limits<double>::infinity();
+    check((double) Real(Integer(1), 1LL << 32) == infinity && (double) Real(Integer(-3), 1LL << 40) == -infinity,
+          "Real converts huge values to infinity");
+    check((double) Real(Integer(1), -(1LL << 32)) == 0.0, "Real converts tiny values to zero");
+    
+    Real const third = div(Real(Integer(1)), Real(Integer(3)), 64, RoundingMode::Nearest);
+    check(bitLength(third.mantissa()) <= 64, "Real division rounds to the precision");
+    Real const product = third * Real(Integer(3));
+    check(abs(product - Real(Integer(1))) < Real(Integer(1), -62), "Real division is close");
+    check(div(Real(Integer(1)), Real(Integer(3)), 64, RoundingMode::Down) <
+          div(Real(Integer(1)), Real(Integer(3)), 64, RoundingMode::Up), "Real division rounds in a direction");
+    check(Real(Integer(3), 2) + Real(Integer(1), -2) == Real(Integer(49), -2), "Real adds exactly");
+    check(Real(Integer(6), 0) == Real(Integer(3), 1), "Real compares by value");
+    // Values far apart are compared without lining up their mantissas, which
+    // would take a shift of about 2^40 bits here.
+    Real huge(Integer(1), 1LL << 40);
+    Real tiny(Integer(1), -(1LL << 40));
+    check(huge > Real(Integer(1)) && tiny < Real(Integer(1)) && huge != tiny, "Real compares far apart values");
+    check(-huge < -tiny && -huge < tiny && huge > -huge, "Real compares far apart negative values");
+    check(Real(Integer(5), 0) < Real(Integer(7), 0) && Real(Integer(-7), 0) < Real(Integer(-5), 0) &&
+          Real(Integer(3), 1) < Real(Integer(7), 0) && Real(Integer(13), -1) < Real(Integer(7), 0),
+          "Real compares values with the same leading bit");
+    check(!(Real() < Real()) && Real() < Real(Integer(1), -1000) && Real(Integer(-1), 1000) < Real(),
+          "Real compares against zero");
+  }
+  
+  // Checks that an exact value lies between the bounds of a RealInterval.
+  bool encloses(RealInterval const& interval, Real const& exact) {
+    Real lower;
+    Real upper;
+    if (!interval.lower(lower) || !interval.upper(upper)) {
+      return false;
+    }
+    return lower <= exact && exact <= upper;
+  }
+  
+  // Checks that the exact quotient num / den lies between the bounds of a
+  // RealInterval, by multiplying the bounds back up by the divisor.
+  bool encloses_quotient(RealInterval const& interval, Real const& num, Real const& den) {
+    Real lower;
+    Real upper;
+    if (!interval.lower(lower) || !interval.upper(upper)) {
+      return false;
+    }
+    if (signum(den) < 0) {
+      return upper * den <= num && num <= lower * den;
+    }
+    return lower * den <= num && num <= upper * den;
+  }
+  
+  void check_real_interval() {
+    // Results worked out at a low precision still contain the exact results.
+    std::srand(5);
+    for (int i = 0; i < 300; ++i) {
+      Real a(Integer((long long) std::rand() - RAND_MAX / 2), (long long) (std::rand() % 40) - 20);
+      Real b(Integer((long long) std::rand() - RAND_MAX / 2), (long long) (std::rand() % 40) - 20);
+      if (signum(b) == 0) {
+        continue;
+      }
+      RealInterval x(a, Real(Integer(1), -30), 12);
+      RealInterval y(b, 12);
+      check(encloses(x + y, a + b), "RealInterval sum contains the exact sum");
+      check(encloses(x - y, a - b), "RealInterval difference contains the exact difference");
+      check(encloses(x * y, a * b), "RealInterval product contains the exact product");
+      check(encloses_quotient(x / y, a, b), "RealInterval quotient contains the exact quotient");
+    }
+    
+    // Dividing by an interval around zero gives an unbounded interval, which
+    // has no bounds to report.
+    RealInterval unbounded = RealInterval(Integer(1)) / RealInterval(Real(), Real(Integer(1)));
+    Real bound(Integer(7));
+    check(!unbounded.isBounded(), "RealInterval division by zero is unbounded");
+    check(!unbounded.lower(bound) && !unbounded.upper(bound) && bound == Real(Integer(7)),
+          "RealInterval has no bounds when unbounded");
+    check(unbounded.contains(Real(Integer(1), 1000)), "RealInterval unbounded contains everything");
+    check(!(unbounded + RealInterval(Integer(1))).isBounded(), "RealInterval unbounded stays unbounded");
+    RealInterval exact(Integer(5));
+    check(exact.isBounded() && exact.isExact() && exact.lower(bound) && bound == Real(Integer(5)),
+          "RealInterval of one value");
+    
+    // Refining finds 1/3 to the accuracy asked for.
+    RealInterval third;
+    bool isRefined = refine([](unsigned long long precision) {
+      return RealInterval(Integer(1), precision) / RealInterval(Integer(3), precision);
+    }, 300, third);
+    check(isRefined && third.accuracy() >= 300 && encloses_quotient(third, Real(Integer(1)), Real(Integer(3))),
+          "RealInterval refine reaches the accuracy");
+  }
+  void check_factorials() {
+    // Each function matches a naive running product.
+    Integer naive_factorial(1);
+    Integer naive_primorial(1);
+    for (unsigned long long n = 0; n <= 300; ++n) {
+      if (n != 0) {
+        naive_factorial *= Integer(n);
+      }
+      bool is_prime = n >= 2;
+      for (unsigned long long d = 2; d * d <= n && is_prime; ++d) {
+        is_prime = n % d != 0;
+      }
+      if (is_prime) {
+        naive_primorial *= Integer(n);
+      }
+      check(factorial(n) == naive_factorial, "factorial matches a naive product");
+      check(primorial(n) == naive_primorial, "primorial matches a naive product");
+      Integer naive_double(1);
+      for (unsigned long long k = n; k >= 2; k -= 2) {
+        naive_double *= Integer(k);
+      }
+      check(doubleFactorial(n) == naive_double, "doubleFactorial matches a naive product");
+    }
+    
+    // Binomials follow Pascal's triangle, and vanish past the end of a row.
+    std::vector<Integer> row(1, Integer(1));
+    for (unsigned long long n = 0; n <= 120; ++n) {
+      for (unsigned long long k = 0; k <= n; k += (n < 40 ? 1 : 7)) {
+        check(binomial(n, k) == row[k], "binomial matches Pascal's triangle");
+      }
+      check(signum(binomial(n, n + 1)) == 0, "binomial is zero past n");
+      std::vector<Integer> next(row.size() + 1, Integer(1));
+      for (std::size_t k = 1; k < row.size(); ++k) {
+        next[k] = row[k - 1] + row[k];
+      }
+      row = next;
+    }
+    
+    check(factorial(3000, 4) == factorial(3000), "factorial gives the same result on threads");
+    check(binomial(5000, 1700, 4) == binomial(5000, 1700), "binomial gives the same result on threads");
+    
+    // The threaded product tree checks the token of the calling thread.
+    CancellationToken cancelled;
+    cancelled.cancel();
+    bool is_cancelled = false;
+    try {
+      CancellationScope const scope(cancelled);
+      factorial(3000, 4);
+    }
+    catch (OperationCancelled const&) {
+      is_cancelled = true;
+    }
+    check(is_cancelled, "factorial stops on every thread when cancelled");
+  }
+  
+  // Makes an Integer of up to a certain number of bits from std::rand, which
+  // is negative about half of the time if it is signed.
+  Integer random_integer(unsigned long long bits, bool is_signed = true) {
+    Integer result;
+    unsigned long long i = 0;
+    for (; i < bits; i += 8) {
+      result <<= 8;
+      result += Integer(std::rand() % 256);
+    }
+    result >>= i - bits;
+    if (is_signed && std::rand() % 2 == 0) {
+      result.negate();
+    }
+    return result;
+  }
+  
+  void check_product_tree() {
+    std::srand(7);
+    std::vector<Integer> moduli;
+    for (int i = 0; i < 37; ++i) {
+      moduli.push_back(random_integer(1 + std::rand() % 200, false) + Integer(1));
+    }
+    ProductTree const tree(moduli);
+    Integer product(1);
+    for (Integer const& modulus : moduli) {
+      product *= modulus;
+    }
+    check(tree.size() == moduli.size() && tree.product() == product, "ProductTree multiplies the moduli");
+    
+    // A remainder tree gives the same remainders as dividing one at a time.
+    for (int i = 0; i < 20; ++i) {
+      Integer const x = random_integer(std::rand() % 9000);
+      std::vector<Integer> const remainders = tree.remainders(x);
+      bool is_match = remainders.size() == moduli.size();
+      for (std::size_t j = 0; j < moduli.size() && is_match; ++j) {
+        Integer expected = div(x, moduli[j]).rem;
+        if (signum(expected) < 0) {
+          expected += moduli[j];
+        }
+        is_match = remainders[j] == expected;
+      }
+      check(is_match, "ProductTree remainders match division");
+    }
+    
+    // The Chinese remainder theorem undoes the remainders for coprime moduli.
+    std::vector<Integer> primes;
+    for (unsigned long long n = 3; primes.size() < 50; ++n) {
+      bool is_prime = true;
+      for (unsigned long long d = 2; d * d <= n && is_prime; ++d) {
+        is_prime = n % d != 0;
+      }
+      if (is_prime) {
+        primes.push_back(Integer(n));
+      }
+    }
+    primes.push_back(Integer(1) << 100);
+    ProductTree const coprime(primes);
+    for (int i = 0; i < 20; ++i) {
+      Integer const x = random_integer(bitLength(coprime.product()) - 1, false);
+      Integer reconstructed;
+      check(coprime.crt(coprime.remainders(x), reconstructed) && reconstructed == x, "ProductTree crt round trips");
+    }
+    Integer unused;
+    check(!coprime.crt(std::vector<Integer>(3, Integer(1)), unused), "ProductTree crt needs every residue");
+    ProductTree const shared({ Integer(6), Integer(10), Integer(7) });
+    check(!shared.crt({ Integer(1), Integer(1), Integer(1) }, unused), "ProductTree crt needs coprime moduli");
+  }
+  
+  // Reduces an Integer to the range [0, 2^bits), the way unsigned types wrap.
+  Integer wrap_to_bits(Integer const& val, unsigned long long bits) {
+    Integer const modulus = Integer(1) << bits;
+    Integer result = div(val, modulus).rem;
+    if (signum(result) < 0) {
+      result += modulus;
+    }
+    return result;
+  }
+  
+  void check_integer_array() {
+    // Every operation matches Integer arithmetic reduced to the width.
+    std::srand(11);
+    unsigned long long const widths[] = { 1, 7, 32, 45, 64, 100, 129 };
+    for (unsigned long long bits : widths) {
+      std::size_t const size = 1 + std::rand() % 40;
+      std::vector<Integer> lhs_values;
+      std::vector<Integer> rhs_values;
+      for (std::size_t i = 0; i < size; ++i) {
+        lhs_values.push_back(random_integer(bits + 10));
+        rhs_values.push_back(random_integer(bits + 10));
+      }
+      IntegerArray lhs(lhs_values, bits);
+      IntegerArray const rhs(rhs_values, bits);
+      std::vector<Integer> const stored = lhs.toIntegers();
+      bool is_match = stored.size() == size && lhs.limbs() == (bits + 31) / 32;
+      Integer expected_sum;
+      for (std::size_t i = 0; i < size && is_match; ++i) {
+        is_match = stored[i] == wrap_to_bits(lhs_values[i], bits) && lhs.get(i) == stored[i];
+        expected_sum += stored[i];
+      }
+      check(is_match, "IntegerArray stores Integers wrapped to the width");
+      check(lhs.sum() == expected_sum, "IntegerArray sum is exact");
+      
+      std::vector<int> const order = lhs.compare(rhs);
+      is_match = order.size() == size;
+      for (std::size_t i = 0; i < size && is_match; ++i) {
+        Integer const a = lhs.get(i);
+        Integer const b = rhs.get(i);
+        is_match = order[i] == (a < b ? -1 : (a == b ? 0 : 1));
+      }
+      check(is_match, "IntegerArray compare matches Integer comparison");
+      
+      IntegerArray::Limb const factor = (IntegerArray::Limb) std::rand();
+      IntegerArray sum(lhs);
+      IntegerArray difference(lhs);
+      IntegerArray product(lhs);
+      check(sum.add(rhs) && difference.sub(rhs), "IntegerArray operations on matching arrays");
+      product.mulScalar(factor);
+      is_match = true;
+      for (std::size_t i = 0; i < size && is_match; ++i) {
+        Integer const a = lhs.get(i);
+        Integer const b = rhs.get(i);
+        is_match = sum.get(i) == wrap_to_bits(a + b, bits) && difference.get(i) == wrap_to_bits(a - b, bits) &&
+                   product.get(i) == wrap_to_bits(a * Integer((unsigned long long) factor), bits);
+      }
+      check(is_match, "IntegerArray arithmetic wraps like unsigned types");
+    }
+    
+    IntegerArray narrow(3, 8);
+    IntegerArray const wide(3, 16);
+    IntegerArray const shorter(2, 8);
+    check(!narrow.add(wide) && !narrow.sub(shorter) && narrow.compare(wide).empty(),
+          "IntegerArray rejects mismatched arrays");
+    narrow.set(1, Integer(-1));
+    check(narrow.get(1) == Integer(255) && signum(narrow.get(0)) == 0, "IntegerArray stores negatives as two's complement");
+  }
+  
+  // Shifts an Integer right the way two's complement does, rounding towards
+  // negative infinity. The shifts of an Integer keep the sign and magnitude
+  // apart, and round towards zero instead.
+  Integer floor_shift(Integer const& val, unsigned long long bits) {
+    div_result result = div2(val, bits);
+    if (signum(result.rem) < 0) {
+      --result.quot;
+    }
+    return result.quot;
+  }
+  
+  // Reduces an Integer to the range of a signed type with a certain number of bits.
+  Integer wrap_to_signed(Integer const& val, unsigned long long bits) {
+    Integer result = wrap_to_bits(val, bits);
+    if (bitLength(result) == bits) {
+      result -= Integer(1) << bits;
+    }
+    return result;
+  }
+  
+  template <std::size_t Bits>
+  void check_fixed_integer_width() {
+    using Fixed = FixedInteger<Bits>;
+    using UnsignedFixed = FixedInteger<Bits, false>;
+    for (int i = 0; i < 200; ++i) {
+      Integer const a = wrap_to_signed(random_integer(std::rand() % (Bits + 20)), Bits);
+      Integer const b = wrap_to_signed(random_integer(std::rand() % (Bits + 20)), Bits);
+      unsigned long long const shift = std::rand() % (Bits + 5);
+      Fixed const x(a);
+      Fixed const y(b);
+      check((Integer) x == a && Fixed(a + (Integer(1) << Bits)) == x, "FixedInteger converts from Integer with wrapping");
+      check((Integer) (x + y) == wrap_to_signed(a + b, Bits), "FixedInteger sum wraps");
+      check((Integer) (x - y) == wrap_to_signed(a - b, Bits), "FixedInteger difference wraps");
+      check((Integer) (x * y) == wrap_to_signed(a * b, Bits), "FixedInteger product wraps");
+      if (signum(b) != 0) {
+        check((Integer) (x / y) == wrap_to_signed(a / b, Bits), "FixedInteger quotient truncates");
+        check((Integer) (x % y) == wrap_to_signed(a % b, Bits), "FixedInteger remainder has the sign of the dividend");
+      }
+      check((Integer) (x & y) == (a & b) && (Integer) (x | y) == (a | b) && (Integer) (x ^ y) == (a ^ b) &&
+            (Integer) ~x == ~a, "FixedInteger bitwise operations match Integer");
+      check((Integer) (x << shift) == wrap_to_signed(a << shift, Bits), "FixedInteger left shift discards high bits");
+      check((Integer) (x >> shift) == floor_shift(a, shift), "FixedInteger right shift fills with the sign");
+      check((x < y) == (a < b) && (x == y) == (a == b), "FixedInteger compares like Integer");
+      
+      UnsignedFixed const u(a);
+      UnsignedFixed const v(b);
+      check((Integer) u == wrap_to_bits(a, Bits), "FixedInteger unsigned wraps negatives");
+      check((Integer) (u * v) == wrap_to_bits(a * b, Bits), "FixedInteger unsigned product wraps");
+      check((u < v) == (wrap_to_bits(a, Bits) < wrap_to_bits(b, Bits)), "FixedInteger unsigned compares");
+      check((Integer) (u >> shift) == (wrap_to_bits(a, Bits) >> shift), "FixedInteger unsigned right shift fills with zeros");
+      check((Integer) Fixed(u) == a, "FixedInteger converts between signedness");
+    }
+  }
+  
+  void check_fixed_integer() {
+    std::srand(13);
+    check_fixed_integer_width<8>();
+    check_fixed_integer_width<64>();
+    check_fixed_integer_width<100>();
+    check_fixed_integer_width<256>();
+    
+    // The arithmetic can be done at compile time.
+    constexpr FixedInteger<128> big = FixedInteger<128>(1) << 100;
+    static_assert((big >> 99) == FixedInteger<128>(2), "FixedInteger shifts at compile time");
+    static_assert(big / FixedInteger<128>(1ULL << 50) == FixedInteger<128>(1ULL << 50),
+                  "FixedInteger divides at compile time");
+    static_assert(FixedInteger<8>(127) + FixedInteger<8>(1) == FixedInteger<8>(-128), "FixedInteger wraps at compile time");
+    check((Integer) big == Integer(1) << 100, "FixedInteger constant converts to Integer");
+  }
+  
+  // Runs a list of operations on the same random Integers with each of the
+  // kernels that the processor supports, and checks that they all agree.
+  void check_kernels_agree(std::vector<Integer> (*operations)(), char const* description) {
+    std::string const initial = activeKernels();
+    std::vector<std::string> const names = supportedKernels();
+    std::vector<Integer> expected;
+    for (std::size_t i = 0; i < names.size(); ++i) {
+      check(useKernels(names[i]) && activeKernels() == names[i], "useKernels switches kernels");
+      std::vector<Integer> const results = operations();
+      if (i == 0) {
+        expected = results;
+      }
+      else {
+        check(results == expected, description);
+      }
+    }
+    useKernels(initial);
+  }
+  
+  std::vector<Integer> bitwise_operations() {
+    // The lengths go past a few vector widths, so that both the vector loops
+    // and the scalar tails are used.
+    std::srand(17);
+    std::vector<Integer> results;
+    for (int i = 0; i < 100; ++i) {
+      Integer const a = random_integer(std::rand() % 1500, false);
+      Integer const b = random_integer(std::rand() % 1500, false);
+      unsigned long long const shift = std::rand() % 70;
+      results.push_back(a & b);
+      results.push_back(a | b);
+      results.push_back(a ^ b);
+      results.push_back(~a);
+      results.push_back(a << shift);
+      results.push_back(a >> shift);
+    }
+    return results;
+  }
+  
+  void check_bitwise_kernels() {
+    check_kernels_agree(bitwise_operations, "bitwise kernels agree with each other");
+    
+    // Identities that hold whichever kernels are in use. The lengths go past a
+    // few vector widths, so that both the vector loops and the scalar tails are used.
+    std::srand(13);
+    for (int i = 0; i < 100; ++i) {
+      Integer const a = random_integer(std::rand() % 1500, false);
+      Integer const b = random_integer(std::rand() % 1500, false);
+      Integer exclusive(a);
+      exclusive ^= b;
+      check((a & b) + (a | b) == a + b && exclusive == (a | b) - (a & b) && (a & a) == a && (a | a) == a,
+            "bitwise identities hold");
+      check((a < a + Integer(1)) && !(a + Integer(1) < a) && (a + b) - b == a, "magnitudes add and compare");
+    }
+    
+    // Shifts by a few bits match multiplying and dividing by a power of two.
+    std::srand(19);
+    for (int i = 0; i < 100; ++i) {
+      Integer const a = random_integer(std::rand() % 1500, false);
+      unsigned long long const shift = std::rand() % 20;
+      check((a << shift) == a * pow(Integer(2), shift), "left shift multiplies by a power of two");
+      check((a >> shift) == a / pow(Integer(2), shift), "right shift divides by a power of two");
+    }
+  }
+  
+  std::vector<Integer> arithmetic_operations() {
+    std::srand(23);
+    std::vector<Integer> results;
+    for (int i = 0; i < 60; ++i) {
+      Integer const a = random_integer(std::rand() % 5000);
+      Integer b = random_integer(std::rand() % 3000);
+      if (signum(b) == 0) {
+        b = Integer(3);
+      }
+      Integer const product = a * b;
+      div_result const quotient = div(a, b);
+      results.push_back(a + b);
+      results.push_back(a - b);
+      results.push_back(product);
+      results.push_back(quotient.quot);
+      results.push_back(quotient.rem);
+      results.push_back(Integer(a < b ? -1 : (a == b ? 0 : 1)));
+      check(product / b == a && quotient.quot * b + quotient.rem == a && (a + b) - b == a,
+            "Integer arithmetic is consistent under every kernel");
+    }
+    return results;
+  }
+  
+  void check_cpu_dispatch() {
+    std::vector<std::string> const names = supportedKernels();
+    check(!names.empty() && names.back() == "generic", "the generic kernels are always supported");
+    check(activeKernels() == names.front(), "the best kernels are used by default");
+    check(!useKernels("no such kernels") && activeKernels() == names.front(), "useKernels rejects unknown names");
+    check_kernels_agree(arithmetic_operations, "arithmetic kernels agree with each other");
+  }
+  
+  void check_twos_complement() {
+    // Small values match the built in types.
+    std::srand(29);
+    for (int i = 0; i < 500; ++i) {
+      long long const a = (long long) std::rand() * (std::rand() % 2 == 0 ? -37 : 41);
+      long long const b = (long long) std::rand() * (std::rand() % 2 == 0 ? -43 : 47);
+      check((Integer(a) & Integer(b)) == Integer(a & b) && (Integer(a) | Integer(b)) == Integer(a | b) &&
+            (Integer(a) ^ Integer(b)) == Integer(a ^ b) && ~Integer(a) == Integer(~a),
+            "Integer bitwise operations match long long");
+      unsigned long long const index = std::rand() % 64;
+      check(testBit(Integer(a), index) == (((a >> index) & 1) != 0), "testBit matches long long");
+    }
+    
+    // Large values satisfy the identities of two's complement.
+    for (int i = 0; i < 200; ++i) {
+      Integer const a = random_integer(std::rand() % 600);
+      Integer const b = random_integer(std::rand() % 600);
+      check(~a == -a - Integer(1) && ~~a == a, "Integer not is -x - 1");
+      check((a & b) + (a | b) == a + b && (a ^ b) == (a | b) - (a & b), "Integer bitwise identities");
+      check(~(a & b) == (~a | ~b) && ((a ^ b) ^ b) == a, "Integer De Morgan and xor identities");
+      
+      unsigned long long const low = std::rand() % 700;
+      unsigned long long const high = low + std::rand() % 100;
+      check(testBit(a, low) == !even(floor_shift(a, low)), "testBit matches shifting");
+      check(extractBits(a, low, high) == wrap_to_bits(floor_shift(a, low), high - low), "extractBits matches shifting");
+      Integer with_bit(a);
+      setBit(with_bit, low);
+      Integer without_bit(a);
+      setBit(without_bit, low, false);
+      check(testBit(with_bit, low) && !testBit(without_bit, low) &&
+            with_bit - without_bit == Integer(1) << low, "setBit changes a single bit");
+      
+      Integer const magnitude = abs(a);
+      unsigned long long count = 0;
+      for (unsigned long long j = 0; j < bitLength(a); ++j) {
+        count += testBit(magnitude, j) ? 1 : 0;
+      }
+      check(popcount(a) == count, "popcount counts the bits of the magnitude");
+      if (signum(a) != 0) {
+        unsigned long long const zeros = countTrailingZeros(a);
+        check(!even(magnitude >> zeros) && (magnitude >> zeros) << zeros == magnitude, "countTrailingZeros finds the lowest bit");
+        check(Integer(1) << (bitLength(a) - 1) <= magnitude && magnitude < Integer(1) << bitLength(a),
+              "bitLength bounds the magnitude");
+      }
+    }
+    check(bitLength(Integer()) == 0 && popcount(Integer()) == 0 && countTrailingZeros(Integer()) == 0,
+          "bit queries of zero");
+    check(testBit(Integer(-1), 100000) && extractBits(Integer(-1), 10, 20) == Integer(1023),
+          "negative Integers have infinitely many sign bits");
+  }
+  
+  void check_threads() {
+    // The thresholds are lowered so that moderately sized operands are split
+    // between threads, and the results are compared to the serial ones.
+    Thresholds const previous = thresholds();
+    Thresholds lowered = previous;
+    lowered.parallel = 2;
+    lowered.recursiveDivision = 4;
+    std::srand(31);
+    for (int i = 0; i < 20; ++i) {
+      Integer const a = random_integer(2000 + std::rand() % 30000);
+      Integer b = random_integer(1000 + std::rand() % 15000);
+      if (signum(b) == 0) {
+        b = Integer(7);
+      }
+      setThresholds(previous);
+      Integer const product = a * b;
+      div_result const quotient = div(a, b);
+      setThresholds(lowered);
+      check(mul(a, b, 4) == product, "threaded multiplication matches serial multiplication");
+      div_result const threaded = div(a, b, 4);
+      check(threaded.quot == quotient.quot && threaded.rem == quotient.rem, "threaded division matches serial division");
+      ThreadLimitScope const scope(3);
+      check(threadLimit() == 3 && a * b == product && a / b == quotient.quot, "operators use the thread limit");
+    }
+    setThresholds(previous);
+    check(threadLimit() == 1, "the thread limit is restored at the end of a scope");
+    
+    // Tasks on the pool can wait for tasks of their own.
+    ThreadPool& pool = threadPool();
+    std::future<int> outer = pool.submit([&pool]() {
+      std::future<int> inner = pool.submit([]() { return 20; });
+      return pool.wait(inner) + 1;
+    });
+    check(pool.wait(outer) == 21, "ThreadPool runs nested tasks");
+    
+    // runTasks runs every task, and only passes on an exception once all of
+    // them have finished, since they may use memory owned by the caller.
+    std::atomic<int> num_run(0);
+    std::vector<std::function<void()>> tasks;
+    for (int i = 0; i < 8; ++i) {
+      tasks.push_back([&num_run, i]() {
+        ++num_run;
+        if (i % 3 == 1) {
+          throw std::runtime_error("task failed");
+        }
+      });
+    }
+    bool has_thrown = false;
+    try {
+      runTasks(tasks);
+    }
+    catch (std::runtime_error const&) {
+      has_thrown = true;
+    }
+    check(has_thrown && num_run == 8, "runTasks waits for every task before passing on an exception");
+    
+    // The tasks on the pool check the token of the calling thread.
+    CancellationToken cancelled;
+    cancelled.cancel();
+    std::atomic<int> num_cancelled(0);
+    std::vector<std::function<void()>> const checked(4, [&num_cancelled]() {
+      try {
+        checkCancelled();
+      }
+      catch (OperationCancelled const&) {
+        ++num_cancelled;
+      }
+    });
+    {
+      CancellationScope const scope(cancelled);
+      runTasks(checked);
+    }
+    check(num_cancelled == 4, "runTasks passes on the token of the calling thread");
+  }
+  
+  // Checks whether getting the result of a future throws OperationCancelled.
+  template <typename T>
+  bool is_cancelled(std::future<T>& future) {
+    try {
+      future.get();
+    }
+    catch (OperationCancelled const&) {
+      return true;
+    }
+    return false;
+  }
+  
+  void check_async() {
+    // The futures give the same results as the direct operations.
+    std::srand(37);
+    Integer const a = random_integer(20000);
+    Integer const b = random_integer(9000) + (Integer(1) << 9000);
+    std::future<Integer> product = asyncMul(a, b);
+    std::future<div_result> quotient = asyncDiv(a, b, CancellationToken(), 2);
+    std::future<Integer> power = asyncPow(Integer(3), 1000);
+    std::future<Integer> factorial_future = asyncFactorial(500);
+    std::future<std::string> text = asyncToString(a, 16);
+    check(product.get() == a * b, "asyncMul matches multiplication");
+    div_result const result = quotient.get();
+    check(result.quot == a / b && result.rem == a % b, "asyncDiv matches division");
+    check(power.get() == pow(Integer(3), 1000), "asyncPow matches pow");
+    check(factorial_future.get() == factorial(500), "asyncFactorial matches factorial");
+    check(text.get() == toString(a, 16), "asyncToString matches toString");
+    
+    // A token cancelled beforehand stops the operation before it starts, and
+    // operations with other tokens are unaffected.
+    CancellationToken cancelled;
+    cancelled.cancel();
+    check(cancelled.isCancelled() && !CancellationToken().isCancelled(), "CancellationToken records cancellation");
+    std::future<Integer> stopped = asyncFactorial(200000, cancelled);
+    check(is_cancelled(stopped), "a cancelled operation throws OperationCancelled");
+    std::future<Integer> unaffected = asyncMul(a, b);
+    check(unaffected.get() == a * b, "other operations are not cancelled");
+    
+    // Cancelling while an operation runs stops it at its next check.
+    CancellationToken token;
+    std::future<Integer> running = asyncFactorial(2000000, token);
+    token.cancel();
+    check(is_cancelled(running), "a running operation is cancelled");
+    
+    bool has_thrown = false;
+    {
+      CancellationScope const scope(cancelled);
+      check(currentCancellationToken().isCancelled(), "currentCancellationToken gives the scope's token");
+      try {
+        checkCancelled();
+      }
+      catch (OperationCancelled const&) {
+        has_thrown = true;
+      }
+    }
+    check(has_thrown, "checkCancelled throws in a cancelled scope");
+    checkCancelled();
+    check(!currentCancellationToken().isCancelled(), "the token is restored at the end of a scope");
+  }
+  
+  void check_serialization() {
+    std::srand(41);
+    std::vector<Integer> values = { Integer(), Integer(1), Integer(-1), Integer(1) << 64, -(Integer(1) << 127) };
+    for (int i = 0; i < 100; ++i) {
+      values.push_back(random_integer(std::rand() % 2000));
+    }
+    
+    // Many values written one after another are read back in order, both as
+    // Integers and as views into the buffer.
+    std::vector<std::uint8_t> buffer;
+    std::ostringstream output;
+    for (Integer const& value : values) {
+      std::size_t const previous_size = buffer.size();
+      serialize(value, buffer);
+      check(buffer.size() - previous_size == serializedSize(value), "serializedSize matches serialize");
+      writeBinary(output, value);
+    }
+    std::string const written = output.str();
+    check(written == std::string(buffer.begin(), buffer.end()),
+          "writeBinary writes the same bytes as serialize");
+    std::size_t position = 0;
+    std::istringstream input(written);
+    for (Integer const& value : values) {
+      Integer read;
+      IntegerView view;
+      std::size_t read_size = 0;
+      std::size_t view_size = 0;
+      check(deserialize(buffer.data() + position, buffer.size() - position, read, read_size) && read == value,
+            "deserialize round trips");
+      check(deserialize(buffer.data() + position, buffer.size() - position, view, view_size) &&
+            view_size == read_size && view.toInteger() == value && view == IntegerView(value),
+            "deserialize views the value in place");
+      position += read_size;
+      Integer streamed;
+      check(readBinary(input, streamed) && streamed == value, "readBinary round trips");
+    }
+    check(position == buffer.size(), "deserialize reads every byte");
+    
+    // Truncated and non-canonical encodings are rejected.
+    Integer unused;
+    std::size_t unused_size = 0;
+    std::vector<std::uint8_t> single;
+    serialize(Integer(1) << 100, single);
+    check(!deserialize(single.data(), single.size() - 1, unused, unused_size), "deserialize rejects truncated data");
+    std::uint8_t const leading_zero[] = { 2, 0, 0, 0, 0, 0, 0, 0, 0 };
+    std::uint8_t const negative_zero[] = { 1 };
+    check(!deserialize(leading_zero, sizeof(leading_zero), unused, unused_size) &&
+          !deserialize(negative_zero, sizeof(negative_zero), unused, unused_size),
+          "deserialize rejects non-canonical encodings");
+    
+    // Exported bytes match the bits of the magnitude, in either order.
+    for (Integer const& value : values) {
+      Integer const magnitude = abs(value);
+      std::vector<std::uint8_t> const little = exportBytes(value);
+      std::vector<std::uint8_t> const big = exportBytes(value, ByteOrder::BigEndian);
+      bool is_match = little.size() == byteLength(value) && little.size() == (bitLength(value) + 7) / 8 &&
+                      std::equal(little.begin(), little.end(), big.rbegin());
+      for (std::size_t j = 0; j < little.size() && is_match; ++j) {
+        is_match = Integer((unsigned long long) little[j]) == extractBits(magnitude, 8 * j, 8 * j + 8);
+      }
+      check(is_match, "exportBytes writes the magnitude");
+      check(importBytes(big.data(), big.size(), ByteOrder::BigEndian, signum(value) < 0) == value,
+            "importBytes round trips");
+      std::vector<std::uint8_t> padded(little.size() + 5, 0xff);
+      check(exportBytes(value, padded.data(), padded.size()) && padded.back() == 0 &&
+            importBytes(padded.data(), padded.size()) == magnitude, "exportBytes pads with zeros");
+      check(little.empty() || !exportBytes(value, padded.data(), little.size() - 1), "exportBytes needs enough room");
+    }
+    
+    // Views over foreign limbs do arithmetic without copying into an Integer first.
+    for (int i = 0; i < 50; ++i) {
+      Integer const a = random_integer(std::rand() % 1000);
+      Integer const b = random_integer(std::rand() % 1000);
+      std::vector<IntegerView::Limb> limbs((byteLength(a) + 7) / 8 + 2, 0);
+      exportBytes(a, limbs.data(), limbs.size() * sizeof(IntegerView::Limb));
+      IntegerView const x(limbs.data(), limbs.size(), signum(a) < 0);
+      IntegerView const y(b);
+      check(x.toInteger() == a && x.limbCount() == (byteLength(a) + 7) / 8, "IntegerView ignores leading zero limbs");
+      check(x + y == a + b && x - y == a - b && x * y == a * b, "IntegerView arithmetic matches Integer");
+      check((compare(x, y) < 0) == (a < b) && (x == y) == (a == b), "IntegerView compares like Integer");
+    }
+  }
+  
+  void check_storage() {
+    check(!setMappedStorage("no such directory/really not"), "setMappedStorage needs a writable directory");
+    
+    // The same arithmetic gives the same results with its blocks on the heap
+    // and in mapped files.
+    unsigned long long const bits = 8 * (MIN_MAPPED_BYTES + 1000);
+    std::srand(43);
+    Integer const small_factor = random_integer(200, false) + Integer(1);
+    Integer const heap_value = ((Integer(1) << bits) - Integer(1)) * small_factor;
+    div_result const heap_quotient = div(heap_value, small_factor + Integer(2));
+    if (!setMappedStorage(".")) {
+      std::cout << "mapped storage is not available, skipping its checks\n";
+      return;
+    }
+    {
+      Integer const all_ones = (Integer(1) << bits) - Integer(1);
+      check(mappedBytes() >= MIN_MAPPED_BYTES, "large Integers are put in mapped storage");
+      Integer const mapped_value = all_ones * small_factor;
+      div_result const mapped_quotient = div(mapped_value, small_factor + Integer(2));
+      check(mapped_value == heap_value && mapped_quotient.quot == heap_quotient.quot &&
+            mapped_quotient.rem == heap_quotient.rem, "mapped Integers give the same results");
+      check(all_ones + Integer(1) == Integer(1) << bits && popcount(all_ones) == bits, "mapped Integers keep their bits");
+      std::vector<std::uint8_t> buffer;
+      serialize(mapped_value, buffer);
+      Integer read;
+      std::size_t read_size = 0;
+      check(deserialize(buffer.data(), buffer.size(), read, read_size) && read == heap_value,
+            "mapped Integers serialize");
+    }
+    disableMappedStorage();
+    check(mappedBytes() == 0, "mapped storage is released with its Integers");
+    Integer const after = (Integer(1) << bits) * Integer(3);
+    check(mappedBytes() == 0 && after / Integer(3) == Integer(1) << bits, "disableMappedStorage goes back to the heap");
+  }
+  
+  void check_hash() {
+    // Equal values hash equally however they were made, and the containers
+    // find every value that was put in them.
+    std::srand(47);
+    std::unordered_set<Integer> integers;
+    std::unordered_set<Rational> rationals;
+    std::unordered_set<Hashed<Integer>> hashed;
+    std::vector<Integer> values;
+    for (int i = 0; i < 300; ++i) {
+      Integer const value = random_integer(std::rand() % 700);
+      values.push_back(value);
+      integers.insert(value);
+      rationals.insert(Rational(value));
+      hashed.insert(Hashed<Integer>(value));
+      
+      Integer rebuilt;
+      check(fromString(toString(value, 16), 16, rebuilt) &&
+            std::hash<Integer>()(rebuilt) == std::hash<Integer>()(value), "equal Integers hash equally");
+      check(hashValue(IntegerView(value)) == std::hash<Integer>()(value) && IntegerHash()(value) == hashValue(value) &&
+            IntegerHash()(Hashed<Integer>(value)) == hashValue(value), "views and Hashed values hash like Integers");
+      Rational const converted((double) (i - 150) / 8);
+      Rational const widened((long double) (i - 150) / 8);
+      check(std::hash<Rational>()(converted) == std::hash<Rational>()(widened), "equal Rationals hash equally");
+    }
+    for (Integer const& value : values) {
+      check(integers.count(value) == 1 && hashed.count(Hashed<Integer>(value)) == 1 &&
+            rationals.count(Rational(value)) == 1, "hash containers find their values");
+    }
+    check(integers.size() == hashed.size() && integers.size() == rationals.size(), "hash containers agree on size");
+    check(integers.count(Integer(1) << 800) == 0, "hash containers don't find missing values");
+    check(std::hash<Integer>()(Integer(5)) != std::hash<Integer>()(Integer(-5)), "the sign is hashed");
+    check(IntegerEqual()(Hashed<Integer>(Integer(9)), IntegerView(Integer(9))) &&
+          !IntegerEqual()(IntegerView(Integer(9)), Hashed<Integer>(Integer(-9))), "IntegerEqual compares across types");
+  }
+  
+  template <typename URBG>
+  void check_random_generator() {
+    URBG generator(53);
+    URBG same_seed(53);
+    int top_bits_set = 0;
+    for (int i = 0; i < 200; ++i) {
+      unsigned long long const bits = 1 + i * 7;
+      Integer const value = randomBits(bits, generator);
+      check(signum(value) >= 0 && bitLength(value) <= bits, "randomBits stays below 2^bits");
+      check(randomBits(bits, same_seed) == value, "randomBits is determined by the generator");
+      top_bits_set += bitLength(value) == bits ? 1 : 0;
+      
+      Integer const bound = random_integer(1 + std::rand() % 300, false) + Integer(1);
+      Integer const below = randomBelow(bound, generator);
+      check(signum(below) >= 0 && below < bound, "randomBelow stays in range");
+      check(randomBelow(bound, same_seed) == below, "randomBelow is determined by the generator");
+    }
+    check(top_bits_set > 60 && top_bits_set < 140, "randomBits sets the top bit about half of the time");
+    
+    // Every value below a small bound turns up, about equally often.
+    int counts[5] = {};
+    for (int i = 0; i < 1000; ++i) {
+      ++counts[(unsigned long long) randomBelow(Integer(5), generator)];
+    }
+    for (int count : counts) {
+      check(count > 130 && count < 270, "randomBelow is uniform");
+    }
+    check(signum(randomBelow(Integer(), generator)) == 0 && signum(randomBelow(Integer(-7), generator)) == 0 &&
+          signum(randomBits(0, generator)) == 0, "random Integers of empty ranges are zero");
+  }
+  
+  void check_random() {
+    std::srand(59);
+    check_random_generator<std::mt19937_64>();
+    check_random_generator<std::mt19937>();
+    check_random_generator<std::minstd_rand>();
+  }
+  
+  Rational random_rational(unsigned long long bits) {
+    Integer denominator = random_integer(bits);
+    if (signum(denominator) == 0) {
+      denominator = Integer(1);
+    }
+    return Rational(random_integer(bits)) / Rational(denominator);
+  }
+  
+  // Checks that a Rational equals num / den, by cross multiplying.
+  bool equals_fraction(Rational const& val, Integer const& num, Integer const& den) {
+    return val.numerator() * den == num * val.denominator();
+  }
+  
+  void check_rational() {
+    std::srand(61);
+    for (int i = 0; i < 300; ++i) {
+      Rational const a = random_rational(1 + std::rand() % 300);
+      Rational const b = random_rational(1 + std::rand() % 300);
+      Integer const& an = a.numerator();
+      Integer const& ad = a.denominator();
+      Integer const& bn = b.numerator();
+      Integer const& bd = b.denominator();
+      check(signum(ad) > 0 && gcd(an, ad) == Integer(1), "Rational is kept in lowest terms");
+      
+      Rational const sum = a + b;
+      Rational const difference = a - b;
+      Rational const product = a * b;
+      check(signum(sum.denominator()) > 0 && gcd(sum.numerator(), sum.denominator()) == Integer(1),
+            "Rational sum is in lowest terms");
+      check(equals_fraction(sum, an * bd + bn * ad, ad * bd), "Rational sum matches cross multiplication");
+      check(equals_fraction(difference, an * bd - bn * ad, ad * bd), "Rational difference matches cross multiplication");
+      check(equals_fraction(product, an * bn, ad * bd), "Rational product matches cross multiplication");
+      if (signum(bn) != 0) {
+        Rational const quotient = a / b;
+        check(equals_fraction(quotient, an * bd, ad * bn) && signum(quotient.denominator()) > 0,
+              "Rational quotient matches cross multiplication");
+        Rational const remainder = a % b;
+        Integer const truncated = (an * bd) / (ad * bn);
+        check(remainder == a - Rational(truncated) * b, "Rational remainder truncates the quotient");
+      }
+      check((a < b) == (an * bd < bn * ad) && (a == b) == (an == bn && ad == bd), "Rational compares by value");
+      check((Integer) a == an / ad, "Rational converts to Integer by truncating");
+      Rational incremented(a);
+      ++incremented;
+      check(incremented - a == Rational(Integer(1)) && --incremented == a, "Rational increments by one");
+      
+      std::stringstream stream;
+      stream << a;
+      Rational read;
+      check(stream >> read && read == a, "Rational stream round trip");
+    }
+    
+    check(signum((Rational(Integer(3)) / Rational()).numerator()) == 0, "Rational division by zero gives zero");
+    check(Rational(0.375) == Rational(Integer(3)) / Rational(Integer(8)) && Rational(-2.5) == Rational(Integer(-5)) / Rational(Integer(2)),
+          "Rational converts doubles exactly");
+    check((double) (Rational(Integer(1)) / Rational(Integer(3))) == 1.0 / 3.0, "Rational converts to the nearest double");
+  }
+  
+  bool same_thresholds(Thresholds const& lhs, Thresholds const& rhs) {
+    return lhs.karatsuba == rhs.karatsuba && lhs.parallel == rhs.parallel &&
+           lhs.recursiveDivision == rhs.recursiveDivision && lhs.radixConversion == rhs.radixConversion;
+  }
+  
+  void check_thresholds() {
+    Thresholds const previous = thresholds();
+    
+    // Thresholds are written and read back, and a partial file only changes
+    // the thresholds it mentions.
+    Thresholds const custom = { 17, 300, 41, 9 };
+    std::stringstream stream;
+    writeThresholds(stream, custom);
+    Thresholds read = defaultThresholds();
+    check(readThresholds(stream, read) && same_thresholds(read, custom), "thresholds round trip through a stream");
+    std::istringstream partial("# tuned by hand\nkaratsuba = 23\n\n  radixConversion=5  \n");
+    check(readThresholds(partial, read) && read.karatsuba == 23 && read.radixConversion == 5 &&
+          read.parallel == custom.parallel && read.recursiveDivision == custom.recursiveDivision,
+          "readThresholds keeps the thresholds that aren't mentioned");
+    Thresholds const before_bad = read;
+    std::istringstream bad("karatsuba = 12\nno such threshold = 3\n");
+    check(!readThresholds(bad, read) && same_thresholds(read, before_bad), "readThresholds rejects unknown lines");
+    check(!loadThresholds("no such directory/thresholds.txt") && same_thresholds(thresholds(), previous),
+          "loadThresholds fails on a missing file");
+    
+    Thresholds const zeros = { 0, 0, 0, 0 };
+    setThresholds(zeros);
+    Thresholds const clamped = thresholds();
+    check(clamped.karatsuba == 2 && clamped.parallel == 1 && clamped.recursiveDivision == 2 &&
+          clamped.radixConversion == 1, "setThresholds raises thresholds that are too small");
+    
+    // Every algorithm on either side of the crossovers gives the same results.
+    std::srand(67);
+    Thresholds const largest = { 1000000, 1000000, 1000000, 1000000 };
+    for (int i = 0; i < 10; ++i) {
+      Integer const a = random_integer(std::rand() % 20000);
+      Integer b = random_integer(std::rand() % 10000);
+      if (signum(b) == 0) {
+        b = Integer(11);
+      }
+      setThresholds(largest);
+      Integer const product = a * b;
+      div_result const quotient = div(a, b);
+      std::string const text = toString(a);
+      setThresholds(zeros);
+      check(a * b == product, "multiplication agrees across thresholds");
+      div_result const recursive = div(a, b);
+      check(recursive.quot == quotient.quot && recursive.rem == quotient.rem, "division agrees across thresholds");
+      Integer reread;
+      check(toString(a) == text && fromString(text, 10, reread) && reread == a, "radix conversion agrees across thresholds");
+    }
+    setThresholds(previous);
+  }
+  
+  OperationStats find_operation(Stats const& all, std::string const& name) {
+    for (OperationStats const& operation : all.operations) {
+      if (operation.name == name) {
+        return operation;
+      }
+    }
+    return OperationStats();
+  }
+  
+  // Counts the non-overlapping occurrences of a string in another one.
+  std::size_t count_occurrences(std::string const& text, std::string const& pattern) {
+    std::size_t count = 0;
+    for (std::size_t position = text.find(pattern); position != std::string::npos;
+         position = text.find(pattern, position + pattern.size())) {
+      ++count;
+    }
+    return count;
+  }
+  
+  void check_stats() {
+    std::ostringstream empty_trace;
+    if (!stats().isEnabled) {
+      // Without statistics, nothing is recorded, and the trace is empty but valid.
+      check(stats().operations.empty() && !startTrace(), "statistics are off unless built with APRN_STATS");
+      check(writeTrace(empty_trace) && count_occurrences(empty_trace.str(), "\"ph\"") == 0 &&
+            empty_trace.str().find("{\"traceEvents\":[") == 0, "writeTrace writes an empty trace");
+      return;
+    }
+    
+    // Each gcd is counted once, in the bucket of its size.
+    resetStats();
+    std::srand(71);
+    for (int i = 0; i < 10; ++i) {
+      gcd(random_integer(1000), random_integer(1000));
+    }
+    Stats const counted = stats();
+    OperationStats const gcd_stats = find_operation(counted, "gcd");
+    unsigned long long histogram_total = 0;
+    for (unsigned long long bucket : gcd_stats.sizeHistogram) {
+      histogram_total += bucket;
+    }
+    check(gcd_stats.calls == 10 && histogram_total == 10, "statistics count every call");
+    check(find_operation(counted, "multiply").name == "multiply" && counted.allocations > 0,
+          "statistics list every operation and allocation");
+    resetStats();
+    check(find_operation(stats(), "gcd").calls == 0, "resetStats clears the counts");
+    
+    // The trace holds one complete event per operation, up to the limit.
+    check(startTrace(4), "startTrace starts a trace");
+    for (int i = 0; i < 10; ++i) {
+      gcd(random_integer(1000), random_integer(1000));
+    }
+    stopTrace();
+    gcd(Integer(12), Integer(18));
+    std::ostringstream trace;
+    check(writeTrace(trace), "writeTrace writes the trace");
+    std::string const json = trace.str();
+    check(count_occurrences(json, "\"ph\":\"X\"") == 4 && count_occurrences(json, "{") == count_occurrences(json, "}") &&
+          count_occurrences(json, "[") == count_occurrences(json, "]"), "writeTrace writes the recorded events as JSON");
+  }
+  
+  Polynomial<Integer> random_polynomial(std::size_t terms, unsigned long long bits) {
+    std::vector<Integer> coefficients;
+    for (std::size_t i = 0; i < terms; ++i) {
+      coefficients.push_back(random_integer(std::rand() % (bits + 1)));
+    }
+    return Polynomial<Integer>(coefficients);
+  }
+  
+  void check_polynomial() {
+    std::srand(73);
+    // Kronecker substitution gives the same products as the schoolbook method.
+    for (int i = 0; i < 60; ++i) {
+      std::vector<Integer> const lhs = random_polynomial(std::rand() % 80, std::rand() % 300).coefficients();
+      std::vector<Integer> const rhs = random_polynomial(std::rand() % 80, std::rand() % 300).coefficients();
+      check(multiplyCoefficients(lhs, rhs) == multiplyCoefficients<Integer>(lhs, rhs),
+            "Kronecker multiplication matches schoolbook multiplication");
+    }
+    
+    for (int i = 0; i < 30; ++i) {
+      Polynomial<Integer> const p = random_polynomial(1 + std::rand() % 40, 100);
+      Polynomial<Integer> const q = random_polynomial(1 + std::rand() % 40, 100);
+      Integer const x = random_integer(50);
+      check((p * q)(x) == p(x) * q(x) && (p + q)(x) == p(x) + q(x) && (p - q)(x) == p(x) - q(x) && (-p)(x) == -p(x),
+            "Polynomial arithmetic matches evaluation");
+      check((p - p).isZero() && (p - p).degree() == -1 && p + Polynomial<Integer>() == p, "Polynomial zero");
+      
+      // Division by a monic polynomial undoes multiplication, whether the
+      // quotient is short or long enough for Newton's method.
+      std::vector<Integer> divisor_coefficients = random_polynomial(1 + std::rand() % 10, 20).coefficients();
+      divisor_coefficients.push_back(Integer(1));
+      Polynomial<Integer> const divisor(divisor_coefficients);
+      Polynomial<Integer> const quotient = random_polynomial(1 + std::rand() % 80, 20);
+      Polynomial<Integer> const remainder = random_polynomial((std::size_t) divisor.degree(), 20);
+      Polynomial<Integer> found_quotient;
+      Polynomial<Integer> found_remainder;
+      check(Polynomial<Integer>::divide(quotient * divisor + remainder, divisor, found_quotient, found_remainder) &&
+            found_quotient == quotient && found_remainder == remainder, "Polynomial division undoes multiplication");
+    }
+    
+    // Over the Integers, a leading coefficient that doesn't divide evenly makes
+    // the division fail, while over the Rationals it always succeeds.
+    Polynomial<Integer> const x_squared_plus_one(std::vector<Integer>{ Integer(1), Integer(0), Integer(1) });
+    Polynomial<Integer> const three_x(std::vector<Integer>{ Integer(0), Integer(3) });
+    Polynomial<Integer> unchanged_quotient(Integer(5));
+    Polynomial<Integer> unchanged_remainder(Integer(6));
+    check(!Polynomial<Integer>::divide(x_squared_plus_one, three_x, unchanged_quotient, unchanged_remainder) &&
+          unchanged_quotient == Polynomial<Integer>(Integer(5)) && unchanged_remainder == Polynomial<Integer>(Integer(6)),
+          "Polynomial division fails when the coefficients don't divide");
+    check(!Polynomial<Integer>::divide(x_squared_plus_one, Polynomial<Integer>(), unchanged_quotient, unchanged_remainder),
+          "Polynomial division by zero fails");
+    Polynomial<Rational> const rational_dividend(std::vector<Rational>{ Rational(Integer(1)), Rational(), Rational(Integer(1)) });
+    Polynomial<Rational> const rational_divisor(std::vector<Rational>{ Rational(), Rational(Integer(3)) });
+    Polynomial<Rational> rational_quotient;
+    Polynomial<Rational> rational_remainder;
+    check(Polynomial<Rational>::divide(rational_dividend, rational_divisor, rational_quotient, rational_remainder) &&
+          rational_quotient * rational_divisor + rational_remainder == rational_dividend &&
+          rational_remainder == Polynomial<Rational>(Rational(Integer(1))), "Polynomial division over the Rationals");
+    
+    // Evaluating at many points at once matches Horner's method at each one.
+    Polynomial<Integer> const p = random_polynomial(60, 80);
+    std::vector<Integer> points;
+    for (int i = 0; i < 70; ++i) {
+      points.push_back(random_integer(20));
+    }
+    std::vector<Integer> const values = p.evaluate(points);
+    bool is_match = values.size() == points.size();
+    for (std::size_t i = 0; i < points.size() && is_match; ++i) {
+      is_match = values[i] == p(points[i]);
+    }
+    check(is_match, "Polynomial evaluate matches Horner's method");
+    check(Polynomial<Integer>::monomial(3)(Integer(5)) == Integer(125) && Polynomial<Integer>::monomial(3).degree() == 3,
+          "Polynomial monomial");
+  }
+  
+  Matrix<Integer> random_matrix(std::size_t rows, std::size_t cols, unsigned long long bits) {
+    Matrix<Integer> result(rows, cols);
+    for (std::size_t i = 0; i < rows; ++i) {
+      for (std::size_t j = 0; j < cols; ++j) {
+        result(i, j) = random_integer(std::rand() % (bits + 1));
+      }
+    }
+    return result;
+  }
+  
+  Matrix<Rational> to_rational_matrix(Matrix<Integer> const& val) {
+    Matrix<Rational> result(val.rows(), val.cols());
+    for (std::size_t i = 0; i < val.rows(); ++i) {
+      for (std::size_t j = 0; j < val.cols(); ++j) {
+        result(i, j) = Rational(val(i, j)) / Rational(Integer((long long) ((i + 1) * (j + 1))));
+      }
+    }
+    return result;
+  }
+  
+  // Finds a determinant from its definition, as a sum over permutations.
+  Integer leibniz_determinant(Matrix<Integer> const& val) {
+    std::vector<std::size_t> permutation(val.rows());
+    for (std::size_t i = 0; i < permutation.size(); ++i) {
+      permutation[i] = i;
+    }
+    Integer result;
+    do {
+      Integer term(1);
+      int sign = 1;
+      for (std::size_t i = 0; i < permutation.size(); ++i) {
+        term *= val(i, permutation[i]);
+        for (std::size_t j = i + 1; j < permutation.size(); ++j) {
+          sign = permutation[j] < permutation[i] ? -sign : sign;
+        }
+      }
+      result += sign > 0 ? term : -term;
+    } while (std::next_permutation(permutation.begin(), permutation.end()));
+    return result;
+  }
+  
+  void check_matrix() {
+    std::srand(79);
+    for (int i = 0; i < 40; ++i) {
+      std::size_t const size = 1 + std::rand() % 6;
+      Matrix<Integer> const a = random_matrix(size, size, 1 + std::rand() % 100);
+      Matrix<Integer> const b = random_matrix(size, size, 1 + std::rand() % 100);
+      Integer bareiss;
+      Integer modular;
+      Integer other;
+      check(determinant(a, bareiss) && bareiss == leibniz_determinant(a), "Bareiss determinant matches the definition");
+      check(determinantMultiModular(a, modular) && modular == bareiss, "multimodular determinant matches Bareiss");
+      check(determinant(b, other) && determinant(a * b, modular) && modular == bareiss * other,
+            "the determinant of a product is the product of the determinants");
+      
+      // Dividing row i by i + 1 and column j by j + 1 divides the determinant
+      // by the square of size!.
+      Rational rational_result;
+      Integer const size_factorial = factorial(size);
+      check(determinant(to_rational_matrix(a), rational_result) &&
+            rational_result * Rational(size_factorial * size_factorial) == Rational(bareiss),
+            "Rational determinant matches the Integer one");
+    }
+    
+    // Larger matrices, where the multimodular method uses many primes.
+    Matrix<Integer> const large = random_matrix(24, 24, 200);
+    Integer bareiss;
+    Integer modular;
+    check(determinant(large, bareiss) && determinantMultiModular(large, modular) && bareiss == modular,
+          "multimodular determinant matches Bareiss for large entries");
+    
+    // Solutions satisfy lhs * x = denominator * rhs, and over the Rationals lhs * x = rhs.
+    for (int i = 0; i < 20; ++i) {
+      std::size_t const size = 1 + std::rand() % 8;
+      Matrix<Integer> const lhs = random_matrix(size, size, 60);
+      Matrix<Integer> const rhs = random_matrix(size, 1 + std::rand() % 3, 60);
+      Integer det;
+      determinant(lhs, det);
+      Matrix<Integer> numerators;
+      Integer denominator;
+      if (signum(det) == 0) {
+        check(!solve(lhs, rhs, numerators, denominator), "solve rejects singular matrices");
+        continue;
+      }
+      check(solve(lhs, rhs, numerators, denominator) && abs(denominator) == abs(det), "solve finds the determinant");
+      Matrix<Integer> scaled_rhs(rhs.rows(), rhs.cols());
+      for (std::size_t row = 0; row < rhs.rows(); ++row) {
+        for (std::size_t col = 0; col < rhs.cols(); ++col) {
+          scaled_rhs(row, col) = rhs(row, col) * denominator;
+        }
+      }
+      check(lhs * numerators == scaled_rhs, "solve finds the numerators");
+      Matrix<Rational> const rational_lhs = to_rational_matrix(lhs);
+      Matrix<Rational> const rational_rhs = to_rational_matrix(rhs);
+      Matrix<Rational> solution;
+      check(solve(rational_lhs, rational_rhs, solution) && rational_lhs * solution == rational_rhs,
+            "Rational solve satisfies the system");
+    }
+    
+    // A product through a narrow matrix has at most the narrow rank.
+    Matrix<Integer> const tall = random_matrix(7, 3, 30);
+    Matrix<Integer> const wide = random_matrix(3, 9, 30);
+    check(rank(tall * wide) == rank(tall) && rank(tall) <= 3 && rank(Matrix<Integer>(4, 5)) == 0,
+          "rank of a product through a narrow matrix");
+    check(rank(to_rational_matrix(tall * wide)) == rank(tall * wide), "Rational rank matches Integer rank");
+    Matrix<Integer> unchanged = Matrix<Integer>::identity(2);
+    check(!multiply(tall, tall, unchanged) && unchanged == Matrix<Integer>::identity(2),
+          "multiply rejects mismatched sizes");
+    Integer unused;
+    check(!determinant(tall, unused) && determinant(Matrix<Integer>(), unused) && unused == Integer(1),
+          "determinant needs a square matrix");
+  }
+  
+  // Checks that the convergents of a continued fraction end at a value, with
+  // the same recurrences that bestApproximation uses.
+  bool is_continued_fraction_of(std::vector<Integer> const& terms, Rational const& val) {
+    Integer previous_p(0);
+    Integer previous_q(1);
+    Integer p(1);
+    Integer q(0);
+    for (Integer const& term : terms) {
+      Integer const next_p = term * p + previous_p;
+      Integer const next_q = term * q + previous_q;
+      previous_p = p;
+      previous_q = q;
+      p = next_p;
+      q = next_q;
+    }
+    return p == val.numerator() && q == val.denominator();
+  }
+  
+  void check_continued_fraction() {
+    std::vector<Integer> const pi_terms = continuedFraction(Rational(Integer(355)) / Rational(Integer(113)));
+    check(pi_terms == std::vector<Integer>{ Integer(3), Integer(7), Integer(16) }, "continued fraction of 355/113");
+    check(continuedFraction(Rational(Integer(-7)) / Rational(Integer(2))) == std::vector<Integer>{ Integer(-4), Integer(2) },
+          "continued fraction of a negative value starts with its floor");
+    
+    // Expansions of values small and large give the value back, and are in
+    // their unique form.
+    std::srand(83);
+    for (int i = 0; i < 100; ++i) {
+      Rational const value = random_rational(1 + std::rand() % 3000);
+      std::vector<Integer> const terms = continuedFraction(value);
+      bool is_canonical = !terms.empty() && (terms.size() == 1 || terms.back() != Integer(1));
+      for (std::size_t j = 1; j < terms.size() && is_canonical; ++j) {
+        is_canonical = signum(terms[j]) > 0;
+      }
+      check(is_canonical, "continued fraction terms are positive and unique");
+      check(is_continued_fraction_of(terms, value), "continued fraction gives the value back");
+    }
+    
+    // The best approximations of pi are its well known convergents.
+    Rational approximation;
+    Rational const pi(3.141592653589793);
+    check(bestApproximation(pi, Integer(10), approximation) && approximation == Rational(Integer(22)) / Rational(Integer(7)),
+          "best approximation of pi with a denominator up to 10");
+    check(bestApproximation(pi, Integer(16000), approximation) &&
+          approximation == Rational(Integer(355)) / Rational(Integer(113)), "best approximation of pi with a denominator up to 16000");
+    check(bestApproximation(pi, Integer(20000), approximation) &&
+          approximation == Rational(Integer(62813)) / Rational(Integer(19994)), "best approximation of pi can be a semiconvergent");
+    check(!bestApproximation(pi, Integer(), approximation), "best approximation needs a positive limit");
+    
+    // Every approximation matches a search through every denominator.
+    for (int i = 0; i < 200; ++i) {
+      Rational const value = Rational(random_integer(30)) / Rational(random_integer(20, false) + Integer(1));
+      unsigned long long const limit = 1 + std::rand() % 60;
+      Rational best;
+      Rational best_distance;
+      bool is_tied = false;
+      for (unsigned long long denominator = 1; denominator <= limit; ++denominator) {
+        Rational const scaled = value * Rational(Integer(denominator));
+        Integer floor = scaled.numerator() / scaled.denominator();
+        if (signum(scaled.numerator()) < 0 && floor * scaled.denominator() != scaled.numerator()) {
+          --floor;
+        }
+        for (Integer const& numerator : { floor, floor + Integer(1) }) {
+          Rational const candidate = Rational(numerator) / Rational(Integer(denominator));
+          Rational const distance = candidate < value ? value - candidate : candidate - value;
+          if (denominator == 1 && numerator == floor) {
+            best = candidate;
+            best_distance = distance;
+          }
+          else if (distance < best_distance) {
+            best = candidate;
+            best_distance = distance;
+            is_tied = false;
+          }
+          else if (distance == best_distance && candidate != best && candidate.denominator() == best.denominator()) {
+            is_tied = true;
+          }
+        }
+      }
+      check(bestApproximation(value, Integer(limit), approximation) && (is_tied || approximation == best),
+            "best approximation matches a brute force search");
+    }
+  }
+  
+  void check_decimal() {
+    Decimal parsed;
+    check(fromString("-12.340", parsed) && toString(parsed) == "-12.340" && parsed.scale() == 3,
+          "Decimal keeps its scale through text");
+    check(fromString("1.5e-3", parsed) && toString(parsed) == "0.0015", "Decimal reads negative exponents");
+    check(fromString("1.5e3", parsed) && toString(parsed) == "1500", "Decimal reads positive exponents");
+    check(!fromString("1e", parsed) && !fromString(".", parsed) && !fromString("1.2.3", parsed),
+          "Decimal rejects malformed strings");
+    
+    // The same RoundingMode is shared with Real, so both headers can be used together.
+    RoundingMode const modes[] = {
+      RoundingMode::Down, RoundingMode::Up, RoundingMode::TowardZero, RoundingMode::AwayFromZero,
+      RoundingMode::Nearest, RoundingMode::NearestAwayFromZero, RoundingMode::NearestTowardZero
+    };
+    char const* const positive[] = { "1.0", "1.1", "1.0", "1.1", "1.0", "1.1", "1.0" };
+    char const* const negative[] = { "-1.1", "-1.0", "-1.0", "-1.1", "-1.0", "-1.1", "-1.0" };
+    for (int i = 0; i < 7; ++i) {
+      check(toString(rescale(Decimal(Integer(105), 2), 1, modes[i])) == positive[i], "Decimal rounds 1.05");
+      check(toString(rescale(Decimal(Integer(-105), 2), 1, modes[i])) == negative[i], "Decimal rounds -1.05");
+      Real real(Integer(21), -1);
+      real.round(4, modes[i]);
+      Decimal decimal = rescale(Decimal(Integer(105), 1), 0, modes[i]);
+      check(real == Real(Integer(decimal.coefficient())), "Real and Decimal round 10.5 the same way");
+    }
+    check(toString(rescale(Decimal(Integer(115), 2), 1)) == "1.2", "Decimal rounds ties to even");
+    
+    check(Decimal(Integer(150), 2) == Decimal(Integer(15), 1), "Decimal compares by value");
+    check(Decimal(Integer(-1)) < Decimal(Integer(5), 3), "Decimal orders by value");
+    check(toString(Decimal(Integer(3), 1) + Decimal(Integer(7), 3)) == "0.307", "Decimal adds exactly");
+    check(toString(Decimal(Integer(3), 1) * Decimal(Integer(-7), 3)) == "-0.0021", "Decimal multiplies exactly");
+    Decimal quotient;
+    check(divide(Decimal(Integer(2)), Decimal(Integer(-3)), 2, RoundingMode::NearestAwayFromZero, quotient) &&
+          toString(quotient) == "-0.67", "Decimal divides to a scale");
+    check(!divide(Decimal(Integer(1)), Decimal(), 2, RoundingMode::Nearest, quotient),
+          "Decimal division by zero fails");
+    check(toString(toDecimal(Rational(2.675), 2)) == "2.67", "Decimal rounds the exact value of a double");
+    
+    std::istringstream input("  -3.14e1 7 x");
+    Decimal first;
+    Decimal second;
+    Decimal third;
+    input >> first >> second;
+    check(input && toString(first) == "-31.4" && toString(second) == "7", "Decimal reads from streams");
+    input >> third;
+    check(!input, "Decimal stream input fails on a bad character");
+    
+    // Exponents too large to expand are rejected instead of exhausting memory.
+    Decimal unchanged(Integer(7));
+    check(!fromString("1e10000000", unchanged) && !fromString("1e999999999999999999", unchanged) &&
+          !fromString("1e-100001", unchanged) && unchanged == Decimal(Integer(7)),
+          "Decimal rejects huge exponents");
+    Decimal largest;
+    check(fromString("1e100000", largest) && largest == Decimal(pow(Integer(10), 100000)),
+          "Decimal accepts the largest exponent");
+    std::istringstream huge("5e99999999999");
+    Decimal streamed;
+    huge >> streamed;
+    check(!huge, "Decimal stream input fails on a huge exponent");
+    
+    // Rescaling round trips through Rational for many values and scales.
+    std::srand(3);
+    for (int i = 0; i < 500; ++i) {
+      Decimal value(Integer((long long) (std::rand() % 2000001) - 1000000), std::rand() % 8);
+      unsigned long long scale = std::rand() % 8;
+      RoundingMode mode = modes[std::rand() % 7];
+      Decimal rounded = rescale(value, scale, mode);
+      check(toDecimal((Rational) value, scale, mode) == rounded, "Decimal rescale matches Rational rounding");
+      Decimal reread;
+      check(fromString(toString(value), reread) && reread == value && reread.scale() == value.scale(),
+            "Decimal text round trip");
+    }
+  }
+  
+  void check_literals() {
+    using namespace aprn::literals;
+    // The type is the smallest whole number of limbs with room for a sign bit.
+    static_assert(std::is_same<decltype(0_Z), FixedInteger<32>>::value, "the literal 0 takes one limb");
+    static_assert(std::is_same<decltype(2147483647_Z), FixedInteger<32>>::value, "2^31 - 1 takes one limb");
+    static_assert(std::is_same<decltype(2147483648_Z), FixedInteger<64>>::value, "2^31 needs a second limb for the sign");
+    static_assert(std::is_same<decltype(0xffffffffffffffffffffffffffffffff_Z), FixedInteger<160>>::value,
+                  "a 128 bit literal takes five limbs");
+    static_assert(0x7b_Z == FixedInteger<32>(123) && 0173_Z == FixedInteger<32>(123) &&
+                  0b111'1011_Z == FixedInteger<32>(123) && 1'2'3_Z == FixedInteger<32>(123),
+                  "literals in every base");
+    static_assert(-(18446744073709551616_Z) + 18446744073709551616_Z == FixedInteger<96>(0), "negated literals fit");
+    
+    // Literals convert to the same Integers as parsing the digits at run time.
+    Integer expected;
+    fromString("123456789012345678901234567890123456789012345678901234567890", 10, expected);
+    check((Integer) 123456789012345678901234567890123456789012345678901234567890_Z == expected,
+          "decimal literals convert to Integers");
+    fromString("fedcba9876543210fedcba9876543210fedcba98", 16, expected);
+    check((Integer) 0xfedcba98'76543210'fedcba98'76543210'fedcba98_Z == expected, "hexadecimal literals convert to Integers");
+    check((Integer) -(0x8000000000000000_Z) == -(Integer(1) << 63), "negated literals convert to Integers");
+    static constexpr FixedInteger<64> product = 4294967296_Z * FixedInteger<64>(3_Z);
+    check((Integer) product == Integer(3) << 32, "literals can be combined at compile time");
+  }
+  
+}
+
 int main(int argc, char** argv) {
   
   int num_wrong = 0;
@@ -38,13 +1525,40 @@ int main(int argc, char** argv) {
     }
     else {
       std::cout << "Should be " << integer_result << ": ";
-      //std::cout << integer_a << " + " << integer_b << " = " << integer_predicted_result << '\n';
+      //std::cout << integer_a << " / " << integer_b << " = " << integer_predicted_result << '\n';
       ++num_wrong;
     }
-    std::cout << integer_a << " + " << integer_b << " = " << integer_predicted_result << '\n';
+    std::cout << integer_a << " / " << integer_b << " = " << integer_predicted_result << '\n';
   }
   std::cout << std::setbase(10);
-  std::cout << "number of incorrect sums: " <<  num_wrong << '\n';
+  std::cout << "number of incorrect quotients: " <<  num_wrong << '\n';
   std::cout << std::setbase(16);
-  return 0;
+  
+  check_binary_splitting();
+  check_real();
+  check_real_interval();
+  check_factorials();
+  check_product_tree();
+  check_integer_array();
+  check_fixed_integer();
+  check_bitwise_kernels();
+  check_cpu_dispatch();
+  check_twos_complement();
+  check_threads();
+  check_async();
+  check_serialization();
+  check_storage();
+  check_hash();
+  check_random();
+  check_rational();
+  check_thresholds();
+  check_stats();
+  check_polynomial();
+  check_matrix();
+  check_continued_fraction();
+  check_decimal();
+  check_literals();
+  std::cout << std::setbase(10);
+  std::cout << "number of failed checks: " << num_failed_checks << '\n';
+  return num_wrong == 0 && num_failed_checks == 0 ? 0 : 1;
 }
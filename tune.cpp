@@ -0,0 +1,242 @@
+#include "include/integer.h"
+#include "include/math_integer.h"
+#include "include/random.h"
+#include "include/thread_pool.h"
+#include "include/thresholds.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Finds the best thresholds between the Integer algorithms on this machine. For
+// each threshold, an operation on operands of n limbs is timed twice: once with
+// the threshold at n, so that the faster algorithm is used at the top level, and
+// once with it just above n, so that the simpler one is. The threshold is the
+// first size from which the faster algorithm keeps winning.
+//
+// The results can be loaded at startup by pointing the APRN_THRESHOLDS
+// environment variable at the config file, or built in by saving the header as
+// src/tuned_thresholds.h and rebuilding the library.
+//
+// Options:
+//   --min-time=SECS  Repeat each timing for at least this long (default 0.05)
+//   --threads=N      The number of threads to tune the parallel threshold for
+//                    (default: the number of hardware threads)
+//   --config=FILE    Write the thresholds as a config file
+//   --header=FILE    Write the thresholds as a header of #defines
+// With neither --config nor --header, the config file is written to standard output.
+
+using namespace aprn;
+
+namespace {
+
+  struct Options {
+    double minTime = 0.05;
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    std::string config;
+    std::string header;
+  };
+
+  // The operand sizes that are tried, in limbs (or half limbs for division).
+  std::size_t const CANDIDATES[] = {
+    2, 3, 4, 6, 8, 12, 16, 24, 32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024, 1536, 2048, 3072, 4096
+  };
+  // How many sizes in a row the faster algorithm has to win for, so that one
+  // noisy timing doesn't decide the threshold.
+  std::size_t const WINS_NEEDED = 2;
+  unsigned const LIMB_BITS = 64;
+
+  volatile int sink = 0;
+
+  // Returns the shortest time per call out of a few runs, in seconds. Each run
+  // repeats the operation until it has taken at least the minimum time.
+  double measure(std::function<int()> const& operation, double minTime) {
+    double best = 0.0;
+    for (int run = 0; run < 3; ++run) {
+      unsigned long long iterations = 0;
+      auto start = std::chrono::steady_clock::now();
+      double elapsed = 0.0;
+      do {
+        sink = sink + operation();
+        ++iterations;
+        elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      } while (elapsed < minTime);
+      double perCall = elapsed / iterations;
+      if (run == 0 || perCall < best) {
+        best = perCall;
+      }
+    }
+    return best;
+  }
+
+  // Finds a threshold by comparing the operation with the threshold at n (the
+  // faster algorithm) and at n + 1 (the simpler algorithm), for each candidate
+  // size n. The operation is given the size to use. Returns the current value
+  // if the faster algorithm never keeps winning.
+  std::size_t tune(std::string const& name, std::size_t Thresholds::* field, std::size_t maxSize,
+                   std::function<std::function<int()>(std::size_t)> const& makeOperation,
+                   double minTime) {
+    Thresholds const original = thresholds();
+    std::size_t result = original.*field;
+    std::size_t firstWin = 0;
+    std::size_t wins = 0;
+    for (std::size_t size : CANDIDATES) {
+      if (size > maxSize) {
+        break;
+      }
+      std::function<int()> operation = makeOperation(size);
+      Thresholds values = original;
+      values.*field = size;
+      setThresholds(values);
+      double fast = measure(operation, minTime);
+      values.*field = size + 1;
+      setThresholds(values);
+      double slow = measure(operation, minTime);
+      std::cerr << name << " " << size << ": " << 1e6 * fast << " us against " << 1e6 * slow << " us\n";
+      if (fast < slow) {
+        if (wins == 0) {
+          firstWin = size;
+        }
+        if (++wins == WINS_NEEDED) {
+          result = firstWin;
+          break;
+        }
+      }
+      else {
+        wins = 0;
+      }
+    }
+    setThresholds(original);
+    return result;
+  }
+
+  bool parseOption(std::string const& arg, std::string const& name, std::string& value_out) {
+    std::string prefix = "--" + name + "=";
+    if (arg.compare(0, prefix.size(), prefix) != 0) {
+      return false;
+    }
+    value_out = arg.substr(prefix.size());
+    return true;
+  }
+
+  std::string makeHeader(Thresholds const& values) {
+    std::ostringstream header;
+    header << "// Generated by the tune program. Save as src/tuned_thresholds.h to build these in.\n";
+    header << "#ifndef __APRN_TUNED_THRESHOLDS_H_\n";
+    header << "#define __APRN_TUNED_THRESHOLDS_H_\n\n";
+    header << "#define APRN_KARATSUBA_THRESHOLD " << values.karatsuba << '\n';
+    header << "#define APRN_PARALLEL_THRESHOLD " << values.parallel << '\n';
+    header << "#define APRN_RECURSIVE_DIVISION_THRESHOLD " << values.recursiveDivision << '\n';
+    header << "#define APRN_RADIX_CONVERSION_THRESHOLD " << values.radixConversion << '\n';
+    header << "\n#endif\n";
+    return header.str();
+  }
+
+  bool writeFile(std::string const& path, std::string const& contents) {
+    std::ofstream file(path);
+    file << contents;
+    if (!file) {
+      std::cerr << "could not write to " << path << '\n';
+      return false;
+    }
+    return true;
+  }
+
+}
+
+int main(int argc, char** argv) {
+  Options options;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    std::string value;
+    if (parseOption(arg, "min-time", value)) {
+      options.minTime = std::atof(value.c_str());
+    }
+    else if (parseOption(arg, "threads", value)) {
+      options.threads = (unsigned) std::max(1, std::atoi(value.c_str()));
+    }
+    else if (parseOption(arg, "config", value)) {
+      options.config = value;
+    }
+    else if (parseOption(arg, "header", value)) {
+      options.header = value;
+    }
+    else {
+      std::cerr << "unknown option: " << arg << '\n';
+      return 1;
+    }
+  }
+
+  std::mt19937_64 engine(12345);
+  // Operands with their top bits set, so that they have exactly the given size.
+  auto makeOperand = [&](unsigned long long bits) {
+    return randomBits(bits - 1, engine) | (Integer(1) << (bits - 1));
+  };
+  // Each threshold is tuned with the ones before it already in place.
+  Thresholds result = thresholds();
+
+  result.karatsuba = tune("karatsuba", &Thresholds::karatsuba, 512, [&](std::size_t size) {
+    Integer a = makeOperand(size * LIMB_BITS);
+    Integer b = makeOperand(size * LIMB_BITS);
+    return [a, b]() { return signum(a * b); };
+  }, options.minTime);
+  setThresholds(result);
+
+  // Division is measured in half limbs, with a quotient as long as the divisor.
+  result.recursiveDivision = tune("recursiveDivision", &Thresholds::recursiveDivision, 4096,
+                                  [&](std::size_t size) {
+    Integer a = makeOperand(size * LIMB_BITS);
+    Integer b = makeOperand(size * LIMB_BITS / 2);
+    return [a, b]() { return signum(div(a, b).quot); };
+  }, options.minTime);
+  setThresholds(result);
+
+  result.radixConversion = tune("radixConversion", &Thresholds::radixConversion, 1024,
+                                [&](std::size_t size) {
+    Integer a = makeOperand(size * LIMB_BITS);
+    return [a]() { return (int) toString(a).size(); };
+  }, options.minTime);
+  setThresholds(result);
+
+  // The parallel threshold can only be measured with more than one thread.
+  if (options.threads > 1) {
+    setThreadLimit(options.threads);
+    result.parallel = tune("parallel", &Thresholds::parallel, 4096, [&](std::size_t size) {
+      Integer a = makeOperand(size * LIMB_BITS);
+      Integer b = makeOperand(size * LIMB_BITS);
+      return [a, b]() { return signum(a * b); };
+    }, options.minTime);
+    setThreadLimit(1);
+    setThresholds(result);
+  }
+  else {
+    std::cerr << "parallel: skipped, since only one thread is available\n";
+  }
+
+  if (!options.config.empty()) {
+    std::ostringstream config;
+    config << "# Generated by the tune program. Load with APRN_THRESHOLDS=" << options.config << '\n';
+    writeThresholds(config, result);
+    if (!writeFile(options.config, config.str())) {
+      return 1;
+    }
+  }
+  if (!options.header.empty()) {
+    if (!writeFile(options.header, makeHeader(result))) {
+      return 1;
+    }
+  }
+  if (options.config.empty() && options.header.empty()) {
+    writeThresholds(std::cout, result);
+  }
+  return 0;
+}